@@ -1,91 +1,115 @@
 #include "ATGM336H_app.h"
 #include "uart_app.h"
+#include "snapshot.h"
+#include "geofence.h"
+#include "gps_kalman.h"
+#include "gps_track.h"
+#include "gps_time.h"
 #include <string.h>
-//RT_NAME_MAX
-uint16_t point1 = 0; // 用于记录接收到的数据长度
-float longitude;     // 用于存储经度
-float latitude;      // 用于存储纬度
-
-// 定义保存GPS数据的全局结构体实例
-_SaveData Save_Data;
-// 定义存储经纬度数据的全局结构体实例
-LatitudeAndLongitude_s g_LatAndLongData =
-{
-    .E_W = 0,
-    .N_S = 0,
-    .latitude = 0.0,
-    .longitude = 0.0
-};
-
-// 用于接收缓冲区及逐字节接收
-char USART_RX_BUF[USART_REC_LEN];
-uint8_t uart_A_RX_Buff;
+#include <stdlib.h>
+
+// NMEA解析器：字段在字符到达时就地解码，不再缓存和拷贝整条语句
+static nmea_parser_t gps_parser;
+
+// 定位周期合并：RMC/GGA带UTC时间，GSA/GSV/VTG并入当前周期
+static gps_fix_t gps_epoch;                             // 正在合并的周期
+static rt_bool_t gps_epoch_open = RT_FALSE;             // 当前周期是否已开始
+static rt_uint16_t gps_epoch_snr_sum = 0;               // 当前周期载噪比之和
+static rt_uint8_t gps_epoch_mask = GPS_SENTENCE_ALL;    // 周期完成所需的语句
+static rt_uint64_t gps_epoch_rx_cycles = 0;             // 周期第一条语句到达时刻，授时用
+
+// 最近发布的完整定位记录：双缓冲序列锁，GPS线程整条发布，读者无锁复制
+static snapshot_t gps_fix_snap;
+static gps_fix_t gps_fix_slots[2];
+static rt_uint32_t gps_fix_count = 0;       // 已发布的定位记录数
+static rt_uint32_t gps_fix_partial = 0;     // 缺少语句、因下一周期开始而发布的记录数
+static rt_uint32_t gps_epoch_dropped = 0;   // 丢弃的不完整周期数
+static rt_bool_t gps_fix_updated = RT_FALSE;// 有新定位记录，等待打印
 
 // RT-Thread串口设备句柄
 static rt_device_t gps_serial = RT_NULL;   // uart2 用于GPS模块
 static rt_device_t debug_serial = RT_NULL; // uart0 用于调试打印
+static rt_uint32_t gps_uart_baud = GPS_DEFAULT_BAUD;    // uart2 当前波特率
+
+// 串口接收环形缓冲区大小（DMA接收时由串口框架按此大小分配）
+#define GPS_RX_BUFSZ        512
+// 解析线程单次从串口取出的字节数
+#define GPS_RX_CHUNK        64
+
+// 接收通知邮箱：回调只投递本次新到的字节数，由解析线程批量读取
+static struct rt_mailbox gps_rx_mb;
+static rt_ubase_t gps_rx_mb_pool[8];
+// 非接收通知的唤醒消息：有待处理的模式切换请求
+#define GPS_RX_MB_WAKE      ((rt_ubase_t)-1)
+static volatile rt_int8_t gps_mode_pending = -1;        // 待切换的工作模式，-1 表示无
+
+// 接收统计（调试用）
+static rt_uint32_t gps_rx_bytes = 0;    // 累计接收字节数
+static rt_uint32_t gps_rx_events = 0;   // 累计接收通知次数
 
 /**
- * @brief   串口接收完成回调函数（RT-Thread版本）
+ * @brief   串口接收通知回调（RT-Thread版本）
+ * @note    DMA模式下在DMA半满/满或空闲线中断时调用，size为本次新到的字节数；
+ *          中断模式下为当前缓冲区内的字节数。这里只投递通知，不做任何解析
  */
-// 用于统计接收字节数（调试用）
-//static rt_uint32_t rx_byte_count = 0;
-
 static rt_err_t uart_rx_callback(rt_device_t dev, rt_size_t size)
 {
-    // 判断是否为GPS串口（uart2）
-    if (dev == gps_serial)
+    if (dev == gps_serial && size > 0)
     {
-        // 从串口读取一个字节
-        if (rt_device_read(dev, -1, &uart_A_RX_Buff, 1) == 1)
-        {
-//            rx_byte_count++;  // 统计接收字节数
-            // 判断是否收到帧头标志字符'$'
-            if (uart_A_RX_Buff == '$')
-            {
-                point1 = 0; // 清空数据长度计数器
-            }
-            USART_RX_BUF[point1++] = uart_A_RX_Buff; // 存储接收到的数据
-
-            // 检查是否收到的是GPRMC/GNRMC帧数据
-            if (USART_RX_BUF[0] == '$' && USART_RX_BUF[4] == 'M' && USART_RX_BUF[5] == 'C')
-            {
-                // 如果收到换行符，表示一帧数据接收完成
-                if (uart_A_RX_Buff == '\n')
-                {
-                    // 将GPS数据拷贝到结构体中并标记已接收到数据
-                    memset(Save_Data.GPS_Buffer, 0, GPS_Buffer_Length);
-                    memcpy(Save_Data.GPS_Buffer, USART_RX_BUF, point1);
-                    Save_Data.isGetData = true; // 标记已经获取到GPS数据
-
-                    // 清空缓冲区，准备接收下一帧数据
-                    point1 = 0;
-                    memset(USART_RX_BUF, 0, USART_REC_LEN);
-                }
-            }
-            // 防止缓冲区溢出
-            if (point1 >= USART_REC_LEN)
-            {
-                point1 = USART_REC_LEN;
-            }
-        }
+        // 邮箱满说明解析线程还没来得及处理，它会一次读完缓冲区内全部数据
+        rt_mb_send(&gps_rx_mb, size);
     }
 
     return RT_EOK;
 }
 
 /**
- * @brief   GPS线程入口函数
+ * @brief   一次取空串口接收缓冲区并解析，合并积压的多次通知
+ */
+static void gps_rx_drain(void)
+{
+    uint8_t chunk[GPS_RX_CHUNK];
+    rt_ssize_t len;
+
+    while ((len = rt_device_read(gps_serial, 0, chunk, sizeof(chunk))) > 0)
+    {
+        gps_rx_bytes += len;
+        parseGpsBuffer(chunk, len); // 解析GPS数据
+    }
+}
+
+/**
+ * @brief   GPS线程入口函数：等待接收通知，批量取出数据并解析
  * @param   未使用线程参数
  */
 static void atgm336h_entry(void *parameter)
 {
+    rt_ubase_t size;
+    rt_int8_t mode;
+
+    // 先把模块配置到工作波特率、更新率，只输出解析器使用的语句
+    gps_config_apply(GPS_MODE_DEFAULT);
 
     while(1)
     {
-        parseGpsBuffer(); // 解析GPS数据
-        printGpsBuffer(); // 打印GPS数据
-        rt_thread_mdelay(100);
+        if (rt_mb_recv(&gps_rx_mb, &size, RT_WAITING_FOREVER) != RT_EOK)
+        {
+            continue;
+        }
+
+        if (size != GPS_RX_MB_WAKE)
+        {
+            gps_rx_events++;
+            gps_rx_drain();
+            printGpsBuffer(); // 打印GPS数据
+        }
+
+        mode = gps_mode_pending;
+        if (mode >= 0)
+        {
+            gps_mode_pending = -1;
+            gps_config_apply((gps_mode_t)mode);
+        }
     }
 }
 
@@ -95,9 +119,10 @@ static void atgm336h_entry(void *parameter)
  */
 int atgm336h_app_init(void)
 {
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
     rt_thread_t thread;
 
-    clrStruct(); // 清空结构体数据
+    nmea_parser_init(&gps_parser); // 复位NMEA解析器
 
     // 查找并打开GPS串口设备（uart2）
     gps_serial = rt_device_find("uart2");
@@ -107,15 +132,30 @@ int atgm336h_app_init(void)
         return -1;
     }
 
-    // 以中断接收模式打开串口
-    if (rt_device_open(gps_serial, RT_DEVICE_FLAG_INT_RX) != RT_EOK)
+    // 先按ATGM336H出厂波特率打开，由配置层切换到工作波特率；打开前设置接收缓冲区大小
+    config.baud_rate = gps_uart_baud;
+    config.bufsz = GPS_RX_BUFSZ;
+    rt_device_control(gps_serial, RT_DEVICE_CTRL_CONFIG, &config);
+
+    rt_mb_init(&gps_rx_mb, "gps_rx", gps_rx_mb_pool,
+               sizeof(gps_rx_mb_pool) / sizeof(gps_rx_mb_pool[0]), RT_IPC_FLAG_FIFO);
+
+    // 优先以DMA接收模式打开：数据由DMA搬入环形缓冲区，空闲线中断分帧，
+    // 不再每个字节进一次中断；驱动不支持DMA时退回中断接收模式
+    if (rt_device_open(gps_serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_RX) == RT_EOK)
+    {
+        rt_kprintf("[ATGM336H] uart2 opened in DMA RX mode\n");
+    }
+    else if (rt_device_open(gps_serial, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_INT_RX) == RT_EOK)
+    {
+        rt_kprintf("[ATGM336H] uart2 DMA RX unavailable, using INT RX\n");
+    }
+    else
     {
         rt_kprintf("[ATGM336H] uart2 open failed!\n");
         return -1;
     }
 
-    // 配置串口2波特率为9600（ATGM336H默认波特率）
-
     // 设置接收回调函数，准备接收数据
     rt_device_set_rx_indicate(gps_serial, uart_rx_callback);
 
@@ -134,7 +174,7 @@ int atgm336h_app_init(void)
     thread = rt_thread_create("atgm336h",
                               atgm336h_entry,
                               RT_NULL,
-                              1024,
+                              2048,
                               25,
                               10);
     if(thread != RT_NULL)
@@ -152,245 +192,522 @@ int atgm336h_app_init(void)
 }
 
 /**
- * @brief   清空结构体数据函数
+ * @brief   发布当前周期的定位记录
  */
-void clrStruct(void)
+static void gps_epoch_publish(void)
 {
-    Save_Data.isGetData = false; // 标记未获取到GPS数据
-    Save_Data.isParseData = false; // 标记数据未解析
-    Save_Data.isUsefull = false;   // 标记定位信息无效
-    // 清空各个缓冲区
-    memset(Save_Data.GPS_Buffer, 0, GPS_Buffer_Length);
-    memset(Save_Data.UTCTime, 0, UTCTime_Length);
-    memset(Save_Data.latitude, 0, latitude_Length);
-    memset(Save_Data.N_S, 0, N_S_Length);
-    memset(Save_Data.longitude, 0, longitude_Length);
-    memset(Save_Data.E_W, 0, E_W_Length);
+    gps_epoch_open = RT_FALSE;
+
+    // 没有RMC的周期缺少定位状态和日期，直接丢弃
+    if (!(gps_epoch.sentences & GPS_SENTENCE_RMC))
+    {
+        gps_epoch_dropped++;
+        return;
+    }
+    if ((gps_epoch.sentences & gps_epoch_mask) != gps_epoch_mask)
+    {
+        gps_fix_partial++;
+    }
+
+    if (gps_epoch.satellites_tracked > 0)
+    {
+        gps_epoch.snr_avg = gps_epoch_snr_sum / gps_epoch.satellites_tracked;
+    }
+
+    // 整条记录一次性发布，读者不会看到合并到一半的数据，也不会被GPS线程阻塞
+    gps_epoch.seq = gps_fix_snap.seq + 1;
+    snapshot_publish(&gps_fix_snap, gps_fix_slots, &gps_epoch, sizeof(gps_epoch));
+    gps_fix_count++;
+    gps_fix_updated = RT_TRUE;
+
+    // RMC 的 UTC 与 PPS 边沿配对，驯服系统时间
+    gps_time_update(&gps_epoch, gps_epoch_rx_cycles);
+
+    // 每次有效定位都在本地检查电子围栏，进出事件立即交给上行
+    if (gps_epoch.valid)
+    {
+        geofence_update(gps_epoch.latitude, gps_epoch.longitude, gps_epoch.time);
+    }
+
+    // 常速度卡尔曼滤波，输出平滑后的位置、速度和不确定半径
+    gps_kalman_update(&gps_epoch);
+
+    // 平滑后的位置送入轨迹压缩，只上传还原轨迹所需的关键点
+    if (gps_epoch.valid)
+    {
+        gps_kf_state_t state;
+
+        if (gps_kf_get(&state) == RT_EOK)
+        {
+            rt_uint32_t day_ms = ((state.time / 10000) * 3600 + (state.time / 100 % 100) * 60 +
+                                  state.time % 100) * 1000 + state.time_ms;
+
+            gps_track_add(state.latitude, state.longitude, day_ms);
+        }
+    }
 }
 
 /**
- * @brief   错误日志函数
+ * @brief   按UTC时间对齐定位周期：时间变化时结束上一个周期并开始新周期
  */
-void errorLog(int num)
+static void gps_epoch_align(rt_uint32_t time, rt_uint16_t time_ms)
 {
-    while (1)
+    if (gps_epoch_open && (gps_epoch.time != time || gps_epoch.time_ms != time_ms))
     {
-        // 打印错误号并进入死循环
-        if (debug_serial != RT_NULL)
-        {
-            uart_printf(debug_serial, "ERROR%d\r\n", num);
-        }
-        else
-        {
-            rt_kprintf("ERROR%d\r\n", num);
-        }
-        rt_thread_mdelay(1000);
+        // 上一个周期没有等到全部语句，新周期已经开始
+        gps_epoch_publish();
+    }
+    if (!gps_epoch_open)
+    {
+        memset(&gps_epoch, 0, sizeof(gps_epoch));
+        gps_epoch.time = time;
+        gps_epoch.time_ms = time_ms;
+        gps_epoch_snr_sum = 0;
+        gps_epoch_rx_cycles = gps_time_mono_cycles();
+        gps_epoch_open = RT_TRUE;
     }
 }
 
 /**
- * @brief   解析GPS数据缓冲区函数
+ * @brief   将一条校验通过的语句合并进当前定位周期
+ * @param   type 语句类型
  */
-void parseGpsBuffer(void)
+static void gps_epoch_merge(nmea_sentence_t type)
 {
-    char *subString;      // 指向当前逗号位置
-    char *subStringNext;  // 指向下个逗号位置
-    char i = 0;           // 循环计数器
+    const nmea_rmc_t *rmc = &gps_parser.rmc;
+    const nmea_gga_t *gga = &gps_parser.gga;
+    const nmea_gsa_t *gsa = &gps_parser.gsa;
+    const nmea_gsv_t *gsv = &gps_parser.gsv;
+    const nmea_vtg_t *vtg = &gps_parser.vtg;
 
-    uint16_t Number = 0, Integer = 0, Decimal = 0; // 用于经纬度数值转换
-
-    if (Save_Data.isGetData) // 如果已经获取到GPS数据
+    switch (type)
     {
-        Save_Data.isGetData = false;
-        // 打印调试信息
-        if (debug_serial != RT_NULL)
+    case NMEA_SENTENCE_RMC:
+        gps_epoch_align(rmc->time, rmc->time_ms);
+        gps_epoch.date = rmc->date;
+        gps_epoch.valid = rmc->valid;
+        gps_epoch.latitude = rmc->latitude;
+        gps_epoch.longitude = rmc->longitude;
+        gps_epoch.ns = rmc->ns;
+        gps_epoch.ew = rmc->ew;
+        gps_epoch.course = rmc->course;
+        if (!(gps_epoch.sentences & GPS_SENTENCE_VTG))
         {
-//            uart_printf(debug_serial, "**************\r\n");
-            uart_printf(debug_serial, "%s\r\n", Save_Data.GPS_Buffer);
+            // 节转换为km/h，VTG到达后以VTG为准
+            gps_epoch.speed_kmh = rmc->speed_knots * 1852 / 1000;
         }
-
-        for (i = 0; i <= 6; i++) // 循环解析各字段
+        gps_epoch.sentences |= GPS_SENTENCE_RMC;
+        break;
+
+    case NMEA_SENTENCE_GGA:
+        gps_epoch_align(gga->time, gga->time_ms);
+        gps_epoch.quality = gga->quality;
+        gps_epoch.satellites_used = gga->satellites;
+        gps_epoch.hdop = gga->hdop;
+        gps_epoch.altitude = gga->altitude;
+        if (!(gps_epoch.sentences & GPS_SENTENCE_RMC))
         {
-            if (i == 0)
+            gps_epoch.latitude = gga->latitude;
+            gps_epoch.longitude = gga->longitude;
+            gps_epoch.ns = gga->ns;
+            gps_epoch.ew = gga->ew;
+        }
+        gps_epoch.sentences |= GPS_SENTENCE_GGA;
+        break;
+
+    case NMEA_SENTENCE_GSA:
+    case NMEA_SENTENCE_GSV:
+    case NMEA_SENTENCE_VTG:
+        // 不带时间的语句只能并入已由RMC/GGA开始的周期
+        if (!gps_epoch_open)
+        {
+            return;
+        }
+        if (type == NMEA_SENTENCE_GSA)
+        {
+            // 多系统时每个系统一条GSA，DOP相同，取最好的定位类型
+            if (gsa->fix_type > gps_epoch.fix_type)
             {
-                // 找到第一个逗号，分隔字段
-                if ((subString = strstr(Save_Data.GPS_Buffer, ",")) == NULL)
-                    errorLog(1); // 如果找不到逗号，记录错误
+                gps_epoch.fix_type = gsa->fix_type;
             }
-            else
+            gps_epoch.pdop = gsa->pdop;
+            gps_epoch.vdop = gsa->vdop;
+            if (gps_epoch.hdop == 0)
             {
-                subString++;
-                // 寻找下一个逗号
-                if ((subStringNext = strstr(subString, ",")) != NULL)
-                {
-                    char usefullBuffer[2]; // 用于存储数据有效性信息
-                    switch (i)
-                    {
-                        case 1: // 解析时间字段
-                            memcpy(Save_Data.UTCTime, subString, subStringNext - subString);
-                            break;
-                        case 2: // 解析数据有效性字段
-                            memcpy(usefullBuffer, subString, subStringNext - subString);
-                            break;
-                        case 3: // 解析纬度字段
-                            memcpy(Save_Data.latitude, subString, subStringNext - subString);
-                            break;
-                        case 4: // 解析纬度方向字段
-                            memcpy(Save_Data.N_S, subString, subStringNext - subString);
-                            break;
-                        case 5: // 解析经度字段
-                            memcpy(Save_Data.longitude, subString, subStringNext - subString);
-                            break;
-                        case 6: // 解析经度方向字段
-                            memcpy(Save_Data.E_W, subString, subStringNext - subString);
-                            break;
-                        default:
-                            break;
-                    }
-                    subString = subStringNext; // 更新当前逗号位置
-                    Save_Data.isParseData = true; // 标记数据已解析
-                    // 判断数据有效性
-                    if (usefullBuffer[0] == 'A')
-                        Save_Data.isUsefull = true; // 数据有效
-                    else if (usefullBuffer[0] == 'V')
-                        Save_Data.isUsefull = false; // 数据无效
-                }
-                else
-                {
-//                    errorLog(2); // 如果找不到逗号，记录错误
-                }
+                gps_epoch.hdop = gsa->hdop;
             }
+            gps_epoch.sentences |= GPS_SENTENCE_GSA;
         }
-
-        if (Save_Data.isParseData) // 如果数据已解析
+        else if (type == NMEA_SENTENCE_GSV)
         {
-            if (Save_Data.isUsefull) // 如果数据有效
+            // 每个系统的第一条带可见卫星总数，载噪比累加后在发布时求平均
+            if (gsv->number == 1)
             {
-                // 获取纬度方向和经度方向
-                g_LatAndLongData.N_S = Save_Data.N_S[0];
-                g_LatAndLongData.E_W = Save_Data.E_W[0];
-
-                // 转换纬度数据
-                for (uint8_t i = 0; i < 9; i++)
-                {
-                    if (i < 2)
-                    {
-                        Number *= 10;
-                        Number += Save_Data.latitude[i] - '0'; // 获取度部分
-                    }
-                    else if (i < 4)
-                    {
-                        Integer *= 10;
-                        Integer += Save_Data.latitude[i] - '0'; // 获取分的整数部分
-                    }
-                    else if (i == 4);
-                    else if (i < 9)
-                    {
-                        Decimal *= 10;
-                        Decimal += Save_Data.latitude[i] - '0'; // 获取分的小数部分
-                    }
-                }
-                // 转换为十进制度数
-                g_LatAndLongData.latitude = 1.0 * Number + (1.0 * Integer + 1.0 * Decimal / 10000) / 60;
-
-                Number = 0;
-                Integer = 0;
-                Decimal = 0;
-
-                // 转换经度数据
-                for (uint8_t i = 0; i < 10; i++)
-                {
-                    if (i < 3)
-                    {
-                        Number *= 10;
-                        Number += Save_Data.longitude[i] - '0'; // 获取度部分
-                    }
-                    else if (i < 5)
-                    {
-                        Integer *= 10;
-                        Integer += Save_Data.longitude[i] - '0'; // 获取分的整数部分
-                    }
-                    else if (i == 5);
-                    else if (i < 10)
-                    {
-                        Decimal *= 10;
-                        Decimal += Save_Data.longitude[i] - '0'; // 获取分的小数部分
-                    }
-                }
-                // 转换为十进制度数
-                g_LatAndLongData.longitude = 1.0 * Number + (1.0 * Integer + 1.0 * Decimal / 10000) / 60;
-
-                // 更新全局经纬度变量
-                longitude = g_LatAndLongData.longitude;
-                latitude = g_LatAndLongData.latitude;
-
-				//根据上报纬度，向纬度添加符号
-				if(g_LatAndLongData.E_W=='W')
-					 latitude = -latitude;
-				if(g_LatAndLongData.N_S=='S')
-					 latitude = -latitude;
+                gps_epoch.satellites_in_view += gsv->in_view;
             }
+            gps_epoch.satellites_tracked += gsv->tracked;
+            gps_epoch_snr_sum += gsv->snr_sum;
+            if (gsv->number == gsv->total)
+            {
+                gps_epoch.sentences |= GPS_SENTENCE_GSV;
+            }
+        }
+        else
+        {
+            gps_epoch.course = vtg->course;
+            gps_epoch.speed_kmh = vtg->speed_kmh;
+            gps_epoch.sentences |= GPS_SENTENCE_VTG;
         }
+        break;
+
+    default:
+        return;
+    }
+
+    // 所需语句全部到齐，立即发布
+    if ((gps_epoch.sentences & gps_epoch_mask) == gps_epoch_mask)
+    {
+        gps_epoch_publish();
     }
 }
 
+/**
+ * @brief   解析GPS数据缓冲区函数
+ * @param   buf 新收到的数据
+ * @param   len 数据长度
+ * @note    数据逐字节送入NMEA状态机，校验通过的语句按UTC时间合并为定位记录；
+ *          格式错误只进入解析器的错误计数，不会阻塞线程
+ */
+void parseGpsBuffer(const uint8_t *buf, rt_size_t len)
+{
+    nmea_sentence_t type;
+
+    for (rt_size_t i = 0; i < len; i++)
+    {
+        type = nmea_parse_byte(&gps_parser, (char)buf[i]);
+        if (type != NMEA_SENTENCE_NONE)
+        {
+            gps_epoch_merge(type);
+        }
+    }
+}
+
+/**
+ * @brief   获取最近一次发布的完整定位记录
+ * @param   fix 输出定位记录
+ * @return  RT_EOK 成功，-RT_EEMPTY 尚未发布过定位记录
+ * @note    不加锁、不关调度，任意线程都可调用；读到的总是同一周期的完整记录
+ */
+rt_err_t gps_get_fix(gps_fix_t *fix)
+{
+    if (snapshot_read(&gps_fix_snap, gps_fix_slots, fix, sizeof(*fix)) == 0)
+    {
+        return -RT_EEMPTY;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * @brief   将1e-7度定点坐标格式化为十进制度字符串，不经过浮点
+ * @param   buf   输出缓冲区，至少 14 字节
+ * @param   size  缓冲区大小
+ * @param   coord 坐标，单位1e-7度
+ * @return  写入的字符数
+ */
+int gps_coord_format(char *buf, rt_size_t size, rt_int32_t coord)
+{
+    rt_uint32_t mag = coord < 0 ? -(rt_uint32_t)coord : (rt_uint32_t)coord;
+
+    return rt_snprintf(buf, size, "%s%u.%07u", coord < 0 ? "-" : "",
+                       mag / NMEA_COORD_SCALE, mag % NMEA_COORD_SCALE);
+}
+
 /**
  * @brief   打印GPS数据函数
  */
 void printGpsBuffer(void)
 {
-    if (Save_Data.isParseData) // 如果数据已解析
+    gps_fix_t fix;
+    char coord[16];
+
+    if (!gps_fix_updated) // 如果没有新的定位记录
+    {
+        return;
+    }
+    gps_fix_updated = RT_FALSE;
+
+    if (debug_serial == RT_NULL)
+    {
+        return;
+    }
+
+    if (gps_get_fix(&fix) == RT_EOK && fix.valid) // 如果数据有效
+    {
+        // 打印UTC时间、经纬度及判断定位可信度所需的质量信息
+        uart_printf(debug_serial, "UTC %06d.%03d\r\n", fix.time, fix.time_ms);
+        gps_coord_format(coord, sizeof(coord), fix.latitude);
+        uart_printf(debug_serial, "latitude: %c,%s\r\n", fix.ns, coord);
+        gps_coord_format(coord, sizeof(coord), fix.longitude);
+        uart_printf(debug_serial, "longitude: %c,%s\r\n", fix.ew, coord);
+        uart_printf(debug_serial, "fix %dD, sats %d/%d, hdop %d.%02d, alt %d.%d m\r\n",
+                    fix.fix_type, fix.satellites_used, fix.satellites_in_view,
+                    fix.hdop / 100, fix.hdop % 100,
+                    fix.altitude / 10, (fix.altitude < 0 ? -fix.altitude : fix.altitude) % 10);
+    }
+    else
+    {
+        // 显示GPS数据无效
+        uart_printf(debug_serial, "GPS DATA is not usefull!\r\n");
+    }
+}
+
+/**
+ * @brief   修改uart2波特率，丢弃切换前后收到的乱码
+ * @param   baud 新波特率
+ * @return  RT_EOK 成功，其他值为串口驱动返回的错误
+ */
+rt_err_t gps_uart_set_baud(rt_uint32_t baud)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    uint8_t chunk[GPS_RX_CHUNK];
+    rt_err_t ret;
+
+    // 串口已打开时接收缓冲区大小不能改变，只改波特率
+    config.baud_rate = baud;
+    config.bufsz = GPS_RX_BUFSZ;
+    ret = rt_device_control(gps_serial, RT_DEVICE_CTRL_CONFIG, &config);
+    if (ret == RT_EOK)
     {
-        Save_Data.isParseData = false;
+        gps_uart_baud = baud;
+    }
+    while (rt_device_read(gps_serial, 0, chunk, sizeof(chunk)) > 0)
+    {
+    }
+
+    return ret;
+}
+
+/**
+ * @brief   uart2当前波特率
+ */
+rt_uint32_t gps_uart_get_baud(void)
+{
+    return gps_uart_baud;
+}
 
-        // 打印UTC时间
-//        if (debug_serial != RT_NULL)
-//        {
-//            uart_printf(debug_serial, "Save_Data.UTCTime = %s\r\n", Save_Data.UTCTime);
-//        }
-//        else
-//        {
-//            rt_kprintf("Save_Data.UTCTime = %s\r\n", Save_Data.UTCTime);
-//        }
+/**
+ * @brief   向GPS模块发送命令
+ * @param   data 命令内容
+ * @param   len  命令长度
+ * @return  RT_EOK 全部写出，-RT_EIO 写入不完整
+ */
+rt_err_t gps_uart_send(const char *data, rt_size_t len)
+{
+    return rt_device_write(gps_serial, 0, data, len) == (rt_ssize_t)len ? RT_EOK : -RT_EIO;
+}
 
-        if (Save_Data.isUsefull) // 如果数据有效
+/**
+ * @brief   在给定时间内持续接收并解析GPS数据
+ * @param   ms 接收时长（毫秒）
+ */
+void gps_uart_pump(rt_int32_t ms)
+{
+    rt_tick_t start = rt_tick_get();
+    rt_tick_t span = rt_tick_from_millisecond(ms);
+    rt_tick_t elapsed;
+    rt_ubase_t size;
+
+    while ((elapsed = rt_tick_get() - start) < span)
+    {
+        if (rt_mb_recv(&gps_rx_mb, &size, span - elapsed) == RT_EOK && size != GPS_RX_MB_WAKE)
         {
-            Save_Data.isUsefull = false;
-            // 打印原始经纬度数据
-            if (debug_serial != RT_NULL)
-            {
-                uart_printf(debug_serial, "Save_Data.latitude = %s\r\n", Save_Data.latitude);
-                uart_printf(debug_serial, "Save_Data.N_S = %s", Save_Data.N_S);
-                uart_printf(debug_serial, "Save_Data.longitude = %s", Save_Data.longitude);
-                uart_printf(debug_serial, "Save_Data.E_W = %s\r\n", Save_Data.E_W);
-
-                // 打印转换后的经纬度数据
-                uart_printf(debug_serial, "latitude: %c,%.4f\r\n", g_LatAndLongData.N_S, g_LatAndLongData.latitude);
-                uart_printf(debug_serial, "longitude: %c,%.4f\r\n", g_LatAndLongData.E_W, g_LatAndLongData.longitude);
-            }
-            else
-            {
-                rt_kprintf("Save_Data.latitude = %s\r\n", Save_Data.latitude);
-                rt_kprintf("Save_Data.N_S = %s", Save_Data.N_S);
-                rt_kprintf("Save_Data.longitude = %s", Save_Data.longitude);
-                rt_kprintf("Save_Data.E_W = %s\r\n", Save_Data.E_W);
-                rt_kprintf("latitude: %c,%.4f\r\n", g_LatAndLongData.N_S, g_LatAndLongData.latitude);
-                rt_kprintf("longitude: %c,%.4f\r\n", g_LatAndLongData.E_W, g_LatAndLongData.longitude);
-            }
+            gps_rx_events++;
         }
-        else
+        gps_rx_drain();
+    }
+}
+
+/**
+ * @brief   读取解析与发布计数
+ * @param   counters 输出计数
+ */
+void gps_get_counters(gps_counters_t *counters)
+{
+    const nmea_stats_t *stats = &gps_parser.stats;
+
+    counters->sentences = stats->sentences;
+    counters->ignored = stats->ignored;
+    counters->errors = stats->checksum_errors + stats->format_errors + stats->overflows;
+    counters->fixes = gps_fix_count;
+}
+
+/**
+ * @brief   设置定位周期完成所需的语句，与模块实际输出的语句保持一致
+ * @param   mask GPS_SENTENCE_xxx 组合，必须包含 RMC
+ */
+void gps_set_epoch_mask(rt_uint8_t mask)
+{
+    gps_epoch_mask = mask | GPS_SENTENCE_RMC;
+}
+
+/**
+ * @brief   请求GPS线程切换工作模式
+ * @param   mode 工作模式
+ * @return  RT_EOK 已提交，-RT_EINVAL 模式非法，-RT_ERROR GPS线程未运行
+ */
+rt_err_t gps_request_mode(gps_mode_t mode)
+{
+    if (mode >= GPS_MODE_MAX)
+    {
+        return -RT_EINVAL;
+    }
+    if (gps_serial == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    gps_mode_pending = (rt_int8_t)mode;
+    // 邮箱满时GPS线程正忙，处理完当前数据后同样会检查请求
+    rt_mb_send(&gps_rx_mb, GPS_RX_MB_WAKE);
+    return RT_EOK;
+}
+
+/**
+ * @brief   打印GPS串口接收统计：平均每次通知搬运的字节数反映DMA分帧效果
+ */
+static int gps_stat(int argc, char *argv[])
+{
+    const nmea_stats_t *stats = &gps_parser.stats;
+
+    rt_kprintf("[ATGM336H] rx bytes: %d, rx events: %d, bytes/event: %d\n",
+               gps_rx_bytes, gps_rx_events,
+               gps_rx_events ? gps_rx_bytes / gps_rx_events : 0);
+    rt_kprintf("[ATGM336H] nmea ok: %d, ignored: %d, checksum err: %d, format err: %d, overflow: %d\n",
+               stats->sentences, stats->ignored, stats->checksum_errors,
+               stats->format_errors, stats->overflows);
+    rt_kprintf("[ATGM336H] fixes: %d, partial: %d, dropped epochs: %d\n",
+               gps_fix_count, gps_fix_partial, gps_epoch_dropped);
+    rt_kprintf("[ATGM336H] uart2 %d baud, mode %d, epoch mask 0x%02x\n",
+               gps_uart_baud, gps_config_mode(), gps_epoch_mask);
+    return 0;
+}
+MSH_CMD_EXPORT(gps_stat, show GPS uart receive and NMEA parser statistics);
+
+#ifdef RT_USING_FINSH
+/*
+ * 定位快照压力测试：写者不停发布每个字都等于发布序号的记录，
+ * 同优先级读者靠时间片在任意位置被写者打断，高优先级读者每个tick
+ * 唤醒一次、在任意位置打断写者；任何一个字与序号不符即为撕裂。
+ */
+#define SNAP_TEST_WORDS     24
+#define SNAP_TEST_PRIO      (RT_THREAD_PRIORITY_MAX - 3)
+
+typedef struct
+{
+    rt_uint32_t word[SNAP_TEST_WORDS];
+} snap_test_rec_t;
+
+static snapshot_t snap_test;
+static snap_test_rec_t snap_test_slots[2];
+static volatile rt_bool_t snap_test_running;
+static struct rt_semaphore snap_test_done;
+static rt_uint32_t snap_test_reads[2];
+static rt_uint32_t snap_test_torn[2];
+
+static void snap_test_check(int id)
+{
+    snap_test_rec_t rec;
+    rt_uint32_t seq = snapshot_read(&snap_test, snap_test_slots, &rec, sizeof(rec));
+
+    snap_test_reads[id]++;
+    for (int i = 0; i < SNAP_TEST_WORDS; i++)
+    {
+        if (rec.word[i] != seq)
         {
-            // 显示GPS数据无效
-            if (debug_serial != RT_NULL)
-            {
-                uart_printf(debug_serial, "GPS DATA is not usefull!\r\n");
-            }
-            else
-            {
-                rt_kprintf("GPS DATA is not usefull!\r\n");
-            }
+            snap_test_torn[id]++;
+            break;
         }
     }
 }
 
+static void snap_test_writer(void *parameter)
+{
+    snap_test_rec_t rec;
+
+    while (snap_test_running)
+    {
+        for (int i = 0; i < SNAP_TEST_WORDS; i++)
+        {
+            rec.word[i] = snap_test.seq + 1;
+        }
+        snapshot_publish(&snap_test, snap_test_slots, &rec, sizeof(rec));
+    }
+    rt_sem_release(&snap_test_done);
+}
+
+static void snap_test_reader(void *parameter)
+{
+    while (snap_test_running)
+    {
+        snap_test_check(0);
+    }
+    rt_sem_release(&snap_test_done);
+}
+
+static void snap_test_preempt_reader(void *parameter)
+{
+    while (snap_test_running)
+    {
+        snap_test_check(1);
+        rt_thread_delay(1);
+    }
+    rt_sem_release(&snap_test_done);
+}
+
+/**
+ * @brief   定位快照无锁读取压力测试：gps_snapshot_test [秒数]
+ */
+static int gps_snapshot_test(int argc, char *argv[])
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : 5;
+    rt_thread_t threads[3];
+    int created = 0;
+
+    rt_memset(&snap_test, 0, sizeof(snap_test));
+    rt_memset(snap_test_slots, 0, sizeof(snap_test_slots));
+    rt_memset(snap_test_reads, 0, sizeof(snap_test_reads));
+    rt_memset(snap_test_torn, 0, sizeof(snap_test_torn));
+    rt_sem_init(&snap_test_done, "snap_t", 0, RT_IPC_FLAG_FIFO);
+    snap_test_running = RT_TRUE;
+
+    threads[0] = rt_thread_create("snap_w", snap_test_writer, RT_NULL, 512, SNAP_TEST_PRIO, 1);
+    threads[1] = rt_thread_create("snap_r", snap_test_reader, RT_NULL, 512, SNAP_TEST_PRIO, 1);
+    threads[2] = rt_thread_create("snap_p", snap_test_preempt_reader, RT_NULL, 512, SNAP_TEST_PRIO - 1, 1);
+    for (int i = 0; i < 3; i++)
+    {
+        if (threads[i] != RT_NULL)
+        {
+            rt_thread_startup(threads[i]);
+            created++;
+        }
+    }
+
+    rt_thread_mdelay(seconds * 1000);
+    snap_test_running = RT_FALSE;
+    for (int i = 0; i < created; i++)
+    {
+        rt_sem_take(&snap_test_done, RT_WAITING_FOREVER);
+    }
+    rt_sem_detach(&snap_test_done);
+
+    rt_kprintf("[ATGM336H] snapshot test %ds: %d publishes, reads %d (sliced) / %d (preempting), torn %d / %d\n",
+               seconds, snap_test.seq, snap_test_reads[0], snap_test_reads[1],
+               snap_test_torn[0], snap_test_torn[1]);
+
+    return (created == 3 && snap_test_torn[0] == 0 && snap_test_torn[1] == 0) ? 0 : -1;
+}
+MSH_CMD_EXPORT(gps_snapshot_test, stress lock-free GPS fix snapshot: gps_snapshot_test [seconds]);
+#endif /* RT_USING_FINSH */
+
 //INIT_APP_EXPORT(atgm336h_app_init);
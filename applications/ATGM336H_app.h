@@ -4,59 +4,78 @@
 #include "mydefine.h"
 #include <rtthread.h>
 #include <rtdevice.h>
+#include "nmea_parser.h"
+#include "gps_config.h"
 
-// 定义串口接收缓冲区最大长度
-#define USART_REC_LEN      200
-// 定义是否使能串口1发送（1：使能，0：禁止）
-#define EN_USART1_RX      1
-
-// 定义GPS数据缓冲区各字段信息长度
-#define GPS_Buffer_Length  80
-#define UTCTime_Length     11
-#define latitude_Length    11
-#define N_S_Length         2
-#define longitude_Length   12
-#define E_W_Length         2
-
-// 定义保存GPS数据的结构体
-typedef struct SaveData
+// 定位记录中各语句对应的掩码位
+#define GPS_SENTENCE_RMC   (1 << 0)
+#define GPS_SENTENCE_GGA   (1 << 1)
+#define GPS_SENTENCE_GSA   (1 << 2)
+#define GPS_SENTENCE_GSV   (1 << 3)
+#define GPS_SENTENCE_VTG   (1 << 4)
+#define GPS_SENTENCE_ALL   (GPS_SENTENCE_RMC | GPS_SENTENCE_GGA | GPS_SENTENCE_GSA | \
+                            GPS_SENTENCE_GSV | GPS_SENTENCE_VTG)
+
+// 一个定位周期（同一UTC时间）内各语句合并后的定位记录
+typedef struct
 {
-    char GPS_Buffer[GPS_Buffer_Length];  // 用于存储接收到的GPS原始数据
-    char isGetData;                      // 标志位，指示是否获取到GPS数据
-    char isParseData;                    // 标志位，指示数据是否已被解析
-    char UTCTime[UTCTime_Length];        // 用于存储UTC时间
-    char latitude[latitude_Length];      // 用于存储纬度数据
-    char N_S[N_S_Length];                // 用于存储纬度方向N/S）
-    char longitude[longitude_Length];    // 用于存储经度数据
-    char E_W[E_W_Length];                // 用于存储经度方向E/W）
-    char isUsefull;                      // 标志位，指示定位信息是否有效
-} _SaveData;
-
-// 定义存储经纬度数据的结构体
-typedef struct _LatitudeAndLongitude_s
+    rt_uint32_t time;               // UTC时间 hhmmss
+    rt_uint16_t time_ms;            // UTC时间毫秒部分
+    rt_uint32_t date;               // UTC日期 ddmmyy
+    rt_bool_t valid;                // RMC定位状态有效
+    rt_uint8_t quality;             // GGA定位质量
+    rt_uint8_t fix_type;            // GSA定位类型：1无 2二维 3三维
+    rt_uint8_t satellites_used;     // 参与定位的卫星数
+    rt_uint8_t satellites_in_view;  // 各系统可见卫星总数
+    rt_uint8_t satellites_tracked;  // 有载噪比的卫星数
+    rt_uint8_t snr_avg;             // 有载噪比卫星的平均载噪比（dB-Hz）
+    rt_uint16_t hdop;               // 水平精度因子，单位0.01
+    rt_uint16_t pdop;               // 位置精度因子，单位0.01
+    rt_uint16_t vdop;               // 垂直精度因子，单位0.01
+    rt_int32_t latitude;            // 纬度，单位1e-7度，南纬为负
+    rt_int32_t longitude;           // 经度，单位1e-7度，西经为负
+    char ns;                        // 纬度方向 N/S
+    char ew;                        // 经度方向 E/W
+    rt_int32_t altitude;            // 海拔高度，单位0.1米
+    rt_uint32_t speed_kmh;          // 对地速度，单位0.01 km/h
+    rt_uint32_t course;             // 对地航向，单位0.01度
+    rt_uint8_t sentences;           // 本周期收到的语句掩码 GPS_SENTENCE_xxx
+    rt_uint32_t seq;                // 发布序号，读者据此判断是否为新记录
+} gps_fix_t;
+
+// 解析与发布计数，供配置层验证设置是否生效
+typedef struct
 {
-    float latitude;  // 纬度
-    float longitude; // 经度
-    char N_S;        // 纬度方向（北/南）
-    char E_W;        // 经度方向（东/西）
-} LatitudeAndLongitude_s;
-
-// 定义串口接收数据缓冲区及相关变量
-extern char rxdatabufer;
-extern uint16_t point1;
-extern _SaveData Save_Data;
-extern LatitudeAndLongitude_s g_LatAndLongData;
+    rt_uint32_t sentences;          // 校验通过的语句数
+    rt_uint32_t ignored;            // 校验通过但未解码的语句数
+    rt_uint32_t errors;             // 校验和、格式、超长错误数
+    rt_uint32_t fixes;              // 已发布的定位记录数
+} gps_counters_t;
 
 // GPS应用层初始化（创建线程）
 int atgm336h_app_init(void);
 
-// 清空结构体数据
-void clrStruct(void);
-
-// 解析GPS数据缓冲区
-void parseGpsBuffer(void);
+// 解析GPS数据缓冲区（逐字节送入NMEA状态机）
+void parseGpsBuffer(const uint8_t *buf, rt_size_t len);
 
 // 打印GPS数据
 void printGpsBuffer(void);
 
+// 将1e-7度定点坐标格式化为十进制度字符串（如 "-121.4693000"），返回写入长度
+int gps_coord_format(char *buf, rt_size_t size, rt_int32_t coord);
+
+// 获取最近一次发布的完整定位记录（无锁，任意线程可调用），从未发布过时返回 -RT_EEMPTY
+rt_err_t gps_get_fix(gps_fix_t *fix);
+
+// 以下接口直接操作GPS串口，只能在GPS线程中调用（配置层使用）
+rt_err_t gps_uart_set_baud(rt_uint32_t baud);
+rt_uint32_t gps_uart_get_baud(void);
+rt_err_t gps_uart_send(const char *data, rt_size_t len);
+void gps_uart_pump(rt_int32_t ms);
+void gps_get_counters(gps_counters_t *counters);
+void gps_set_epoch_mask(rt_uint8_t mask);
+
+// 请求GPS线程切换工作模式，可在任意线程调用
+rt_err_t gps_request_mode(gps_mode_t mode);
+
 #endif
@@ -1,6 +1,7 @@
 #include "mydefine.h"
 #include "drv_mq2.h"
 #include "adc_app.h"
+#include "app_config.h"
 
 //MQ2的DO所接的位置
 #define MQ2_DATA_PIN     ((3*32)+7)			//P3_7
@@ -31,7 +32,7 @@ static void mq2_entry(void *parameter)
 			rt_kprintf("校验和错误\n");
 		}
 
-		rt_thread_mdelay(1000);
+		rt_thread_mdelay(app_cfg_get(APP_CFG_MQ2_PERIOD_MS));
 	}
 
 }
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         运行时配置表（云端下发修改）
+ */
+
+#include "app_config.h"
+#include "telemetry.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* 修改后立即通知子系统，RT_NULL 表示子系统下次使用时自己读取 */
+typedef void (*app_cfg_apply_t)(app_cfg_id_t id, rt_int32_t value);
+
+typedef struct
+{
+    const char *name;
+    rt_int32_t value;
+    rt_int32_t min;
+    rt_int32_t max;
+    app_cfg_apply_t apply;
+} app_cfg_entry_t;
+
+static void app_cfg_apply_telem_interval(app_cfg_id_t id, rt_int32_t value);
+static void app_cfg_apply_telem_batch(app_cfg_id_t id, rt_int32_t value);
+
+/* 配置表：名称，默认值，允许范围 */
+static app_cfg_entry_t app_cfg_table[APP_CFG_COUNT] =
+{
+    [APP_CFG_MQ2_PERIOD_MS]        = { "mq2_period_ms",        1000,  100,  60000 },
+    [APP_CFG_DHT11_PERIOD_MS]      = { "dht11_period_ms",      2000,  2000, 600000 },
+    [APP_CFG_MAX30102_POLL_MS]     = { "max30102_poll_ms",     100,   10,   10000 },
+    [APP_CFG_TELEM_DENSITY_MS]     = { "telem_density_ms",     TELEM_DENSITY_INTERVAL_MS,
+                                       0, 3600000, app_cfg_apply_telem_interval },
+    [APP_CFG_TELEM_HEART_RATE_MS]  = { "telem_heart_rate_ms",  TELEM_HEART_RATE_INTERVAL_MS,
+                                       0, 3600000, app_cfg_apply_telem_interval },
+    [APP_CFG_TELEM_TEMPERATURE_MS] = { "telem_temperature_ms", TELEM_TEMPERATURE_INTERVAL_MS,
+                                       0, 3600000, app_cfg_apply_telem_interval },
+    [APP_CFG_TELEM_HUMIDITY_MS]    = { "telem_humidity_ms",    TELEM_HUMIDITY_INTERVAL_MS,
+                                       0, 3600000, app_cfg_apply_telem_interval },
+    [APP_CFG_DENSITY_ALARM_PPM]    = { "density_alarm_ppm",    (rt_int32_t)TELEM_DENSITY_ALARM_PPM,
+                                       1, 10000 },
+    [APP_CFG_TELEM_BATCH]          = { "telem_batch",          1,     0,    1, app_cfg_apply_telem_batch },
+};
+
+/* 遥测采样周期：重新计时，立即唤醒调度线程 */
+static void app_cfg_apply_telem_interval(app_cfg_id_t id, rt_int32_t value)
+{
+    telemetry_set_interval((telem_field_t)(id - APP_CFG_TELEM_DENSITY_MS), value);
+}
+
+static void app_cfg_apply_telem_batch(app_cfg_id_t id, rt_int32_t value)
+{
+    telemetry_set_batching(value != 0);
+}
+
+/**
+ * @brief   读取配置项当前值
+ */
+rt_int32_t app_cfg_get(app_cfg_id_t id)
+{
+    return id < APP_CFG_COUNT ? app_cfg_table[id].value : 0;
+}
+
+/**
+ * @brief   修改配置项，超出范围时不修改
+ */
+rt_err_t app_cfg_set(app_cfg_id_t id, rt_int32_t value)
+{
+    app_cfg_entry_t *e;
+
+    if (id >= APP_CFG_COUNT)
+    {
+        return -RT_EINVAL;
+    }
+    e = &app_cfg_table[id];
+    if (value < e->min || value > e->max)
+    {
+        return -RT_EINVAL;
+    }
+    if (e->value != value)
+    {
+        e->value = value;
+        if (e->apply != RT_NULL)
+        {
+            e->apply(id, value);
+        }
+        rt_kprintf("[CFG] %s = %d\n", e->name, value);
+    }
+    return RT_EOK;
+}
+
+/**
+ * @brief   按名称查找配置项
+ */
+int app_cfg_find(const char *name)
+{
+    for (int i = 0; i < APP_CFG_COUNT; i++)
+    {
+        if (strcmp(app_cfg_table[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief   配置项名称
+ */
+const char *app_cfg_name(app_cfg_id_t id)
+{
+    return id < APP_CFG_COUNT ? app_cfg_table[id].name : "";
+}
+
+#ifdef RT_USING_FINSH
+/**
+ * @brief   查看或修改配置表：app_cfg [名称 值]
+ */
+static int app_cfg(int argc, char *argv[])
+{
+    if (argc == 3)
+    {
+        int id = app_cfg_find(argv[1]);
+
+        if (id < 0 || app_cfg_set((app_cfg_id_t)id, atoi(argv[2])) != RT_EOK)
+        {
+            rt_kprintf("[CFG] unknown item or value out of range\n");
+        }
+    }
+    for (int i = 0; i < APP_CFG_COUNT; i++)
+    {
+        const app_cfg_entry_t *e = &app_cfg_table[i];
+
+        rt_kprintf("[CFG] %-22s %8d  (%d..%d)\n", e->name, e->value, e->min, e->max);
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(app_cfg, show or set runtime configuration);
+#endif /* RT_USING_FINSH */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         运行时配置表（云端下发修改）
+ */
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include <rtthread.h>
+
+/*
+ * 运行时可调的参数，各子系统每次使用时用 app_cfg_get() 读取，
+ * 修改后下一个周期生效；需要立即生效的由配置表调用对应子系统的接口。
+ * 掉电不保存，复位后回到默认值。
+ */
+typedef enum
+{
+    APP_CFG_MQ2_PERIOD_MS = 0,      /* MQ2 采样周期 */
+    APP_CFG_DHT11_PERIOD_MS,        /* DHT11 读取周期，不小于传感器最小间隔 */
+    APP_CFG_MAX30102_POLL_MS,       /* MAX30102 轮询周期（轮询模式） */
+    APP_CFG_TELEM_DENSITY_MS,       /* 遥测采样周期，0 表示不上报，顺序与 telem_field_t 一致 */
+    APP_CFG_TELEM_HEART_RATE_MS,
+    APP_CFG_TELEM_TEMPERATURE_MS,
+    APP_CFG_TELEM_HUMIDITY_MS,
+    APP_CFG_DENSITY_ALARM_PPM,      /* 甲烷报警阈值（ppm） */
+    APP_CFG_TELEM_BATCH,            /* 批量上报开关，0 关 1 开 */
+    APP_CFG_COUNT,
+} app_cfg_id_t;
+
+/**
+ * @brief   读取配置项当前值
+ */
+rt_int32_t app_cfg_get(app_cfg_id_t id);
+
+/**
+ * @brief   修改配置项，超出范围时不修改
+ * @return  RT_EOK 成功，-RT_EINVAL 配置项不存在或超出范围
+ */
+rt_err_t app_cfg_set(app_cfg_id_t id, rt_int32_t value);
+
+/**
+ * @brief   按名称查找配置项（如 "mq2_period_ms"）
+ * @return  配置项编号，-1 表示不存在
+ */
+int app_cfg_find(const char *name);
+
+/**
+ * @brief   配置项名称
+ */
+const char *app_cfg_name(app_cfg_id_t id);
+
+#endif /* APP_CONFIG_H */
@@ -6,10 +6,16 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-11     User         DHT11 温湿度传感器应用示例
+ * 2026-10-19     User         改为定时器驱动的异步读取，去掉独立线程
+ * 2026-10-19     User         增加位时序自检命令
+ * 2026-10-19     User         增加读取调度、失败退避和读数缓存
  */
 
 #include "mydefine.h"
 #include "drv_dht11.h"
+#include "dht11_app.h"
+#include "app_config.h"
+#include <stdlib.h>
 
 /* DHT11 数据引脚定义（根据实际硬件修改） */
 /* 例如使用 GPIO 10 号引脚，请根据您的板卡原理图修改 */
@@ -22,48 +28,148 @@ dht11_device_t g_dht11_dev;
 rt_uint8_t g_dht11_temperature = 0;
 rt_uint8_t g_dht11_humidity = 0;
 
+/* 读取调度参数 */
+#define DHT11_MIN_INTERVAL_MS   2000    /* 传感器要求的最小读取间隔 */
+#define DHT11_BACKOFF_MAX_MS    30000   /* 失败重试退避上限 */
+#define DHT11_COLLECT_MS        40      /* 启动读取后收取结果的时间（起始20ms + 帧约5ms） */
+
+/* 调度阶段 */
+#define DHT11_PHASE_READ        0       /* 定时到期时启动一次读取 */
+#define DHT11_PHASE_COLLECT     1       /* 定时到期时收取读取结果 */
+
+/* 读取调度定时器（单次触发，每次按下一次延时重新装载） */
+static rt_timer_t dht11_timer = RT_NULL;
+static rt_uint8_t dht11_phase = DHT11_PHASE_READ;
+
+/* 上一次异步读取的结果，由读取完成回调写入 */
+static volatile dht11_result_t dht11_last_result = DHT11_OK;
+static volatile rt_bool_t dht11_result_ready = RT_FALSE;
+
+/* 读数缓存，消费者通过 dht11_get_reading() 获取 */
+static dht11_reading_t dht11_cache;
+
+/* 退避抖动用的随机数种子 */
+static rt_uint32_t dht11_seed = 1;
+
 /**
- * @brief DHT11 读取线程入口函数
- * @param parameter 线程参数（未使用）
+ * @brief DHT11 异步读取完成回调（中断上下文，只记录结果）
+ * @param dev DHT11 设备对象
+ * @param result 读取结果
  */
-static void dht11_thread_entry(void *parameter)
+static void dht11_read_done(dht11_device_t *dev, dht11_result_t result)
 {
-    rt_uint8_t temperature;  /* 存储温度值 */
-    rt_uint8_t humidity;     /* 存储湿度值 */
-    dht11_result_t result;   /* 存储读取结果 */
+    dht11_last_result = result;
+    dht11_result_ready = RT_TRUE;
+}
 
-    /* 打印线程启动信息 */
-    rt_kprintf("DHT11 thread started!\n");
+/**
+ * @brief 计算失败后的重试延时：指数退避 + 随机抖动，且不小于最小间隔
+ * @param failures 连续失败次数（>= 1）
+ * @return 延时（毫秒）
+ */
+static rt_uint32_t dht11_backoff_ms(rt_uint32_t failures)
+{
+    rt_uint32_t delay = DHT11_MIN_INTERVAL_MS;
 
-    /* 线程主循环 */
-    while (1)
+    while (--failures > 0 && delay < DHT11_BACKOFF_MAX_MS)
     {
-        /* 调用驱动读取温湿度数据 */
-        result = dht11_read(&g_dht11_dev, &temperature, &humidity);
+        delay <<= 1;
+    }
+    if (delay > DHT11_BACKOFF_MAX_MS)
+    {
+        delay = DHT11_BACKOFF_MAX_MS;
+    }
 
-        /* 根据读取结果进行处理 */
-        if (result == DHT11_OK)
-        {
-            /* 更新全局变量 */
-            g_dht11_temperature = temperature;
-            g_dht11_humidity = humidity;
-            /* 读取成功，打印温湿度数据 */
-            rt_kprintf("[DHT11] Temperature: %d C, Humidity: %d %%\n",
-                       temperature, humidity);
-        }
-        else if (result == DHT11_ERROR_TIMEOUT)
-        {
-            /* 超时错误 */
-            rt_kprintf("[DHT11] Read timeout error!\n");
-        }
-        else if (result == DHT11_ERROR_CHECKSUM)
+    /* 叠加 0~25% 的抖动，避免与其他周期任务长期同相 */
+    dht11_seed = dht11_seed * 1103515245 + 12345;
+    delay += (dht11_seed >> 16) % (delay / 4 + 1);
+
+    return delay;
+}
+
+/**
+ * @brief 更新读数缓存并打印结果
+ * @param result 本次读取结果
+ * @return 下一次读取前的等待时间（毫秒）
+ */
+static rt_uint32_t dht11_update_cache(dht11_result_t result)
+{
+    rt_uint32_t failures;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (result == DHT11_OK)
+    {
+        dht11_cache.temperature = g_dht11_dev.temperature;
+        dht11_cache.humidity = g_dht11_dev.humidity;
+        dht11_cache.timestamp = rt_tick_get();
+        dht11_cache.valid = RT_TRUE;
+        dht11_cache.error_count = 0;
+    }
+    else
+    {
+        dht11_cache.error_count++;
+        dht11_cache.total_errors++;
+    }
+    failures = dht11_cache.error_count;
+    rt_hw_interrupt_enable(level);
+
+    if (result == DHT11_OK)
+    {
+        /* 更新全局变量 */
+        g_dht11_temperature = dht11_cache.temperature;
+        g_dht11_humidity = dht11_cache.humidity;
+        rt_kprintf("[DHT11] Temperature: %d C, Humidity: %d %%\n",
+                   dht11_cache.temperature, dht11_cache.humidity);
+        return app_cfg_get(APP_CFG_DHT11_PERIOD_MS);
+    }
+
+    rt_kprintf("[DHT11] Read %s error, %d in a row!\n",
+               (result == DHT11_ERROR_CHECKSUM) ? "checksum" : "timeout", failures);
+
+    return dht11_backoff_ms(failures);
+}
+
+/**
+ * @brief 重新装载调度定时器
+ * @param ms 延时（毫秒）
+ */
+static void dht11_schedule(rt_uint32_t ms)
+{
+    rt_tick_t ticks = rt_tick_from_millisecond(ms);
+
+    rt_timer_control(dht11_timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    rt_timer_start(dht11_timer);
+}
+
+/**
+ * @brief DHT11 调度定时器回调：交替启动读取和收取结果
+ * @param parameter 定时器参数（未使用）
+ */
+static void dht11_timer_entry(void *parameter)
+{
+    dht11_result_t result;
+
+    if (dht11_phase == DHT11_PHASE_READ)
+    {
+        /* 启动异步读取，起始信号和数据接收都不占用线程 */
+        dht11_result_ready = RT_FALSE;
+        if (dht11_read_async(&g_dht11_dev, dht11_read_done) != RT_EOK)
         {
-            /* 校验和错误 */
-            rt_kprintf("[DHT11] Checksum error!\n");
+            /* 总线被阻塞读取占用，按最小间隔再试 */
+            dht11_schedule(DHT11_MIN_INTERVAL_MS);
+            return;
         }
+        dht11_phase = DHT11_PHASE_COLLECT;
+        dht11_schedule(DHT11_COLLECT_MS);
+    }
+    else
+    {
+        result = dht11_result_ready ? dht11_last_result : DHT11_ERROR_TIMEOUT;
+        dht11_phase = DHT11_PHASE_READ;
 
-        /* 延时 2 秒后再次读取（DHT11 要求两次读取间隔至少 2 秒） */
-        rt_thread_mdelay(1000);
+        /* 周期从本次读取开始计，保证两次读取间隔不小于最小间隔 */
+        dht11_schedule(dht11_update_cache(result) - DHT11_COLLECT_MS);
     }
 }
 
@@ -73,10 +179,8 @@ static void dht11_thread_entry(void *parameter)
  */
 static int dht11_app_init(void)
 {
-    rt_thread_t thread;  /* 线程句柄 */
     rt_err_t ret;        /* 返回值 */
 
-
     /* 初始化 DHT11 设备 */
     ret = dht11_init(&g_dht11_dev, DHT11_DATA_PIN);
     if (ret != RT_EOK)
@@ -86,32 +190,25 @@ static int dht11_app_init(void)
         return -1;
     }
 
-    /* 等待 1 秒，让 DHT11 传感器进入稳定状态（上电后不稳定期） */
-    rt_kprintf("[DHT11] 等待传感器稳定...\n");
-    rt_thread_mdelay(1000);
-
-    /* 创建 DHT11 读取线程 */
-    thread = rt_thread_create("dht11",              /* 线程名称 */
-                              dht11_thread_entry,   /* 线程入口函数 */
-                              RT_NULL,              /* 线程参数（无） */
-                              1024,                 /* 线程栈大小（1024 字节） */
-                              20,                   /* 线程优先级（20，数值越小优先级越高） */
-                              10);                  /* 线程时间片（10 个系统节拍） */
-
-    /* 检查线程是否创建成功 */
-    if (thread != RT_NULL)
+    /*
+     * 创建读取调度定时器，不再占用独立线程和栈。
+     * 第一次读取在一个最小间隔后进行，正好避开上电后约 1 秒的不稳定期。
+     */
+    dht11_timer = rt_timer_create("dht11",
+                                  dht11_timer_entry,
+                                  RT_NULL,
+                                  rt_tick_from_millisecond(DHT11_MIN_INTERVAL_MS),
+                                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
+    if (dht11_timer == RT_NULL)
     {
-        /* 启动线程 */
-        rt_thread_startup(thread);
-        rt_kprintf("[DHT11] Application initialized successfully!\n\n");
-    }
-    else
-    {
-        /* 线程创建失败 */
-        rt_kprintf("[DHT11] Thread create failed!\n");
+        rt_kprintf("[DHT11] Timer create failed!\n");
         return -1;
     }
 
+    dht11_seed = rt_tick_get() ^ DHT11_DATA_PIN;
+    rt_timer_start(dht11_timer);
+    rt_kprintf("[DHT11] Application initialized successfully!\n\n");
+
     return 0;  /* 返回成功 */
 }
 
@@ -136,3 +233,117 @@ rt_uint8_t dht11_get_humidity(void)
     return g_dht11_humidity;
 }
 
+/**
+ * @brief 获取缓存的读数及其新鲜度
+ * @param reading 输出读数缓存的副本
+ * @return 距最近一次成功读取的毫秒数，从未成功时返回 RT_UINT32_MAX
+ */
+rt_uint32_t dht11_get_reading(dht11_reading_t *reading)
+{
+    rt_base_t level;
+    rt_tick_t ticks;
+
+    level = rt_hw_interrupt_disable();
+    *reading = dht11_cache;
+    rt_hw_interrupt_enable(level);
+
+    if (!reading->valid)
+    {
+        return RT_UINT32_MAX;
+    }
+
+    /* 先按秒再按余数换算，避免节拍数乘 1000 溢出（1kHz 节拍下约 71 分钟） */
+    ticks = rt_tick_get() - reading->timestamp;
+    if (ticks / RT_TICK_PER_SECOND >= (RT_UINT32_MAX - 1) / 1000)
+    {
+        return RT_UINT32_MAX - 1;
+    }
+    return ticks / RT_TICK_PER_SECOND * 1000 + ticks % RT_TICK_PER_SECOND * 1000 / RT_TICK_PER_SECOND;
+}
+
+
+/* 自检直方图：每格 10us，最后一格收集 >= 150us 的脉宽 */
+#define DHT11_HIST_BIN_US      10
+#define DHT11_HIST_BINS        16
+
+/**
+ * @brief DHT11 时序自检：多次读取并按直方图打印数据位高电平宽度
+ *
+ * 正常情况下应只出现两簇：0 在 20~30us 格，1 在 70us 格附近，
+ * 两簇都应远离判定阈值。用法：dht11_selftest [次数]
+ */
+static int dht11_selftest(int argc, char *argv[])
+{
+    rt_uint16_t pulse_us[DHT11_FRAME_BITS];
+    rt_uint32_t hist[DHT11_HIST_BINS] = {0};
+    rt_uint32_t min_us = 0xFFFF, max_us = 0;
+    rt_uint8_t temperature, humidity;
+    int count = 5, ok = 0, retry;
+    dht11_result_t result;
+
+    if (argc > 1)
+    {
+        count = atoi(argv[1]);
+    }
+
+    rt_kprintf("[DHT11] selftest: %d reads, core clock %d Hz\n", count, SystemCoreClock);
+
+    /* 自检期间暂停调度，避免两路读取挤在最小间隔内 */
+    rt_timer_stop(dht11_timer);
+    rt_thread_mdelay(DHT11_MIN_INTERVAL_MS);
+
+    for (int i = 0; i < count; i++)
+    {
+        /* 调度器的最后一次读取可能尚未结束，总线忙时稍后重试 */
+        retry = 0;
+        do
+        {
+            result = dht11_read_pulses(&g_dht11_dev, &temperature, &humidity, pulse_us);
+            if (result == DHT11_ERROR_BUSY)
+            {
+                rt_thread_mdelay(50);
+            }
+        } while (result == DHT11_ERROR_BUSY && ++retry < 40);
+
+        if (result != DHT11_OK)
+        {
+            rt_kprintf("[DHT11] read %d failed: %d\n", i, result);
+        }
+        else
+        {
+            ok++;
+            for (int bit = 0; bit < DHT11_FRAME_BITS; bit++)
+            {
+                rt_uint32_t bin = pulse_us[bit] / DHT11_HIST_BIN_US;
+                hist[(bin < DHT11_HIST_BINS) ? bin : DHT11_HIST_BINS - 1]++;
+                if (pulse_us[bit] < min_us) min_us = pulse_us[bit];
+                if (pulse_us[bit] > max_us) max_us = pulse_us[bit];
+            }
+        }
+
+        /* DHT11 要求两次读取间隔至少 2 秒 */
+        rt_thread_mdelay(DHT11_MIN_INTERVAL_MS);
+    }
+
+    dht11_phase = DHT11_PHASE_READ;
+    dht11_schedule(DHT11_MIN_INTERVAL_MS);
+
+    rt_kprintf("[DHT11] %d/%d frames ok, high pulse min %d us, max %d us\n", ok, count, min_us, max_us);
+    for (int bin = 0; bin < DHT11_HIST_BINS; bin++)
+    {
+        if (hist[bin] == 0)
+        {
+            continue;
+        }
+        rt_kprintf("  %3d-%3d us: %4d ", bin * DHT11_HIST_BIN_US, (bin + 1) * DHT11_HIST_BIN_US - 1, hist[bin]);
+        /* 条形长度按总位数归一化，满格 50 个字符 */
+        for (rt_uint32_t n = 0; n < hist[bin] * 50 / (ok * DHT11_FRAME_BITS); n++)
+        {
+            rt_kprintf("#");
+        }
+        rt_kprintf("\n");
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(dht11_selftest, DHT11 bit timing selftest with pulse width histogram);
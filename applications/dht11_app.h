@@ -4,6 +4,17 @@
 #include "mydefine.h"
 #include "drv_dht11.h"
 
+/* DHT11 读数缓存 */
+typedef struct
+{
+    rt_uint8_t temperature;     /* 最近一次成功读取的温度（摄氏度） */
+    rt_uint8_t humidity;        /* 最近一次成功读取的湿度（百分比） */
+    rt_bool_t valid;            /* 是否至少成功读取过一次 */
+    rt_tick_t timestamp;        /* 最近一次成功读取的系统节拍 */
+    rt_uint32_t error_count;    /* 连续失败次数，成功后清零 */
+    rt_uint32_t total_errors;   /* 累计失败次数 */
+} dht11_reading_t;
+
 /* 暴露DHT11设备对象供外部访问 */
 extern dht11_device_t g_dht11_dev;
 
@@ -17,4 +28,7 @@ rt_uint8_t dht11_get_temperature(void);
 /* 获取当前湿度 */
 rt_uint8_t dht11_get_humidity(void);
 
+/* 获取缓存读数，返回距最近一次成功读取的毫秒数（从未成功时为 RT_UINT32_MAX） */
+rt_uint32_t dht11_get_reading(dht11_reading_t *reading);
+
 #endif
@@ -6,9 +6,12 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-11     User         DHT11 温湿度传感器驱动实现
+ * 2026-10-19     User         增加基于定时器和边沿中断的异步读取
+ * 2026-10-19     User         位解码改用 DWT 周期计数器计时
  */
 
 #include "drv_dht11.h"
+#include "drv_dwt.h"
 #include "drv_pin.h"
 
 /* DHT11 时序常量定义 */
@@ -16,27 +19,28 @@
 #define DHT11_WAIT_RESPONSE     30      /* 等待响应时间：30us */
 #define DHT11_RESPONSE_TIMEOUT  200     /* 响应超时时间：200us */
 #define DHT11_BIT_TIMEOUT       150     /* 位读取超时：150us */
-#define CPU_DELAY_US_FACTOR     50      /* CPU 延时校准系数50 */
-
-/* 微秒级延时函数 */
-//static void dht11_delay_us(rt_uint32_t us)
-//{
-//    volatile rt_uint32_t count = us * CPU_DELAY_US_FACTOR;
-//    while (count--)
-//    {
-//        __asm volatile("NOP");
-//    }
-//}
-
-/* 等待引脚变为指定电平状态（带超时） */
+#define DHT11_BIT1_HIGH_US      48      /* 高电平宽度阈值：0约27us，1约70us */
+
+/* 异步读取时序常量 */
+#define DHT11_FRAME_TIMEOUT_MS  10      /* 释放总线后整帧接收超时：10ms */
+#define DHT11_FRAME_EDGES       42      /* 响应1个 + 起始1个 + 数据40个下降沿 */
+#define DHT11_BIT1_EDGE_US      100     /* 下降沿间隔阈值：0约76us，1约120us */
+
+/* 异步读取状态 */
+#define DHT11_STATE_IDLE        0       /* 空闲 */
+#define DHT11_STATE_START       1       /* 正在输出起始信号 */
+#define DHT11_STATE_FRAME       2       /* 正在接收数据帧 */
+#define DHT11_STATE_DONE        3       /* 正在结束本次读取 */
+
+/* 等待引脚变为指定电平状态（带超时），按 DWT 周期计时，与编译优化和主频无关 */
 static rt_err_t dht11_wait_for_level(rt_base_t pin, rt_uint8_t level, rt_uint32_t timeout_us)
 {
-    rt_uint32_t timeout_count = timeout_us * CPU_DELAY_US_FACTOR / 10;
-    rt_uint32_t count = 0;
+    rt_uint32_t start = dwt_get_cycles();
+    rt_uint32_t timeout_cycles = dwt_us_to_cycles(timeout_us);
 
     while (rt_pin_read(pin) != level)
     {
-        if (++count > timeout_count)
+        if (dwt_get_cycles() - start > timeout_cycles)
         {
             return -RT_ETIMEOUT;
         }
@@ -45,81 +49,215 @@ static rt_err_t dht11_wait_for_level(rt_base_t pin, rt_uint8_t level, rt_uint32_
     return RT_EOK;
 }
 
-/* 读取一个位的数据 */
-static rt_int8_t dht11_read_bit(rt_base_t pin)
+/* 读取一个位的数据，width_us 输出高电平宽度 */
+static rt_int8_t dht11_read_bit(rt_base_t pin, rt_uint32_t *width_us)
 {
-    rt_uint32_t high_time = 0;
-    rt_uint32_t timeout_count = DHT11_BIT_TIMEOUT * CPU_DELAY_US_FACTOR / 10;
+    rt_uint32_t start;
 
     /* 等待低电平结束 */
     if (dht11_wait_for_level(pin, PIN_HIGH, DHT11_BIT_TIMEOUT) != RT_EOK)
     {
         return -1;
     }
-//		rt_hw_us_delay(40);
-		
+
     /* 测量高电平持续时间 */
-    while (rt_pin_read(pin) == PIN_HIGH)
+    start = dwt_get_cycles();
+    if (dht11_wait_for_level(pin, PIN_LOW, DHT11_BIT_TIMEOUT) != RT_EOK)
     {
-        if (++high_time > timeout_count)
-        {
-            return -1;
-        }
+        return -1;
     }
+    *width_us = dwt_cycles_to_us(dwt_get_cycles() - start);
 
-    /* 根据高电平持续时间判断位值（阈值40us） */
-//    rt_uint32_t threshold = 40 * CPU_DELAY_US_FACTOR / 10;
-		 rt_uint32_t threshold = 40;
-//		rt_kprintf("high_time=%d, threshold=%d\n", high_time, threshold);
-		
-    return (high_time > threshold) ? 1 : 0;
-//		if((high_time >= 23) && (high_time <= 27))
-//		{
-//			return 0;
-//		}
-//		else if((high_time >= 68) && (high_time <= 74))
-//		{
-//			return -1;
-//		}
-//		else
-//			return -1;
+    /* 根据高电平持续时间判断位值：0 约 26~28us，1 约 70us */
+    return (*width_us > DHT11_BIT1_HIGH_US) ? 1 : 0;
 }
 
-/* 读取一个字节的数据 */
-static rt_int16_t dht11_read_byte(rt_base_t pin)
+/* 读取一个字节的数据，pulse_us 不为空时记录每一位的高电平宽度 */
+static rt_int16_t dht11_read_byte(rt_base_t pin, rt_uint16_t *pulse_us)
 {
     rt_uint8_t byte = 0;
+    rt_uint32_t width;
     rt_int8_t bit;
 
     for (rt_uint8_t i = 0; i < 8; i++)
     {
         byte <<= 1;
-        bit = dht11_read_bit(pin);
+        bit = dht11_read_bit(pin, &width);
         if (bit < 0)
         {
             return -1;
         }
         byte |= bit;
+
+        if (pulse_us != RT_NULL)
+        {
+            pulse_us[i] = (rt_uint16_t)width;
+        }
     }
 
     return byte;
 }
 
+/* 结束一次异步读取：恢复总线空闲状态并通知调用者 */
+static void dht11_async_finish(dht11_device_t *dev, dht11_result_t result)
+{
+    rt_base_t level;
+
+    /* 中断与定时器可能同时判定结束，只允许一方完成 */
+    level = rt_hw_interrupt_disable();
+    if (dev->state != DHT11_STATE_FRAME)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+    dev->state = DHT11_STATE_DONE;
+    rt_hw_interrupt_enable(level);
+
+    rt_pin_irq_enable(dev->pin, PIN_IRQ_DISABLE);
+    rt_timer_stop(&dev->timer);
+
+    rt_pin_mode(dev->pin, PIN_MODE_OUTPUT);
+    rt_pin_write(dev->pin, PIN_HIGH);
+
+    if (result == DHT11_OK)
+    {
+        if (((dev->data[0] + dev->data[1] + dev->data[2] + dev->data[3]) & 0xFF) != dev->data[4])
+        {
+            result = DHT11_ERROR_CHECKSUM;
+        }
+        else
+        {
+            dev->humidity = dev->data[0];
+            dev->temperature = dev->data[2];
+        }
+    }
+
+    dev->state = DHT11_STATE_IDLE;
+
+    if (dev->callback != RT_NULL)
+    {
+        dev->callback(dev, result);
+    }
+}
+
+/* 数据引脚下降沿中断：用相邻下降沿的间隔（低50us + 高26/70us）解码一位 */
+static void dht11_edge_isr(void *args)
+{
+    dht11_device_t *dev = (dht11_device_t *)args;
+    rt_uint32_t now = dwt_get_cycles();
+    rt_uint32_t elapsed;
+    rt_uint8_t index;
+
+    if (dev->state != DHT11_STATE_FRAME)
+    {
+        return;
+    }
+
+    elapsed = now - dev->last_edge;
+    dev->last_edge = now;
+
+    /* 第0个沿为响应信号开始，第1个沿为第一位开始，之后每个沿结束一位 */
+    if (dev->edge_count >= 2)
+    {
+        index = dev->edge_count - 2;
+        if (elapsed > dev->bit1_thresh)
+        {
+            dev->data[index >> 3] |= 0x80 >> (index & 0x07);
+        }
+    }
+
+    if (++dev->edge_count >= DHT11_FRAME_EDGES)
+    {
+        dht11_async_finish(dev, DHT11_OK);
+    }
+}
+
+/* 软件定时器超时：起始信号结束时释放总线，接收阶段超时则报错 */
+static void dht11_timer_timeout(void *parameter)
+{
+    dht11_device_t *dev = (dht11_device_t *)parameter;
+    rt_tick_t timeout = rt_tick_from_millisecond(DHT11_FRAME_TIMEOUT_MS);
+
+    if (dev->state == DHT11_STATE_START)
+    {
+        dev->state = DHT11_STATE_FRAME;
+        dev->last_edge = dwt_get_cycles();
+
+        /* 释放总线，由上拉拉高，之后的下降沿全部由中断处理 */
+        rt_pin_mode(dev->pin, PIN_MODE_INPUT_PULLUP);
+        rt_pin_irq_enable(dev->pin, PIN_IRQ_ENABLE);
+
+        rt_timer_control(&dev->timer, RT_TIMER_CTRL_SET_TIME, &timeout);
+        rt_timer_start(&dev->timer);
+    }
+    else
+    {
+        dht11_async_finish(dev, DHT11_ERROR_TIMEOUT);
+    }
+}
+
 /* 初始化 DHT11 设备 */
 rt_err_t dht11_init(dht11_device_t *dev, rt_base_t pin)
 {
+    rt_err_t ret;
+
     dev->pin = pin;
     dev->humidity = 0;
     dev->temperature = 0;
+    dev->callback = RT_NULL;
+    dev->state = DHT11_STATE_IDLE;
 
     rt_pin_mode(pin, PIN_MODE_OUTPUT);
     rt_pin_write(pin, PIN_HIGH);
 
+    ret = rt_pin_attach_irq(pin, PIN_IRQ_MODE_FALLING, dht11_edge_isr, dev);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+    rt_pin_irq_enable(pin, PIN_IRQ_DISABLE);
+
+    rt_timer_init(&dev->timer, "dht11",
+                  dht11_timer_timeout, dev,
+                  rt_tick_from_millisecond(DHT11_START_SIGNAL_MS),
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
+
     return RT_EOK;
 }
 
-/* 读取 DHT11 温湿度数据 */
-dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi)
+/* 异步读取 DHT11 温湿度数据 */
+rt_err_t dht11_read_async(dht11_device_t *dev, dht11_callback_t callback)
+{
+    rt_tick_t start = rt_tick_from_millisecond(DHT11_START_SIGNAL_MS);
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (dev->state != DHT11_STATE_IDLE)
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_EBUSY;
+    }
+    dev->state = DHT11_STATE_START;
+    rt_hw_interrupt_enable(level);
+
+    dev->callback = callback;
+    dev->edge_count = 0;
+    rt_memset(dev->data, 0, sizeof(dev->data));
+    dev->bit1_thresh = dwt_us_to_cycles(DHT11_BIT1_EDGE_US);
+
+    /* 拉低总线输出起始信号，由定时器在 20ms 后释放 */
+    rt_pin_mode(dev->pin, PIN_MODE_OUTPUT);
+    rt_pin_write(dev->pin, PIN_LOW);
+
+    rt_timer_control(&dev->timer, RT_TIMER_CTRL_SET_TIME, &start);
+    rt_timer_start(&dev->timer);
+
+    return RT_EOK;
+}
+
+/* 阻塞方式读取一帧数据 */
+static dht11_result_t dht11_read_blocking(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi,
+                                          rt_uint16_t *pulse_us)
 {
     rt_int16_t data[5];
     rt_uint8_t checksum;
@@ -135,8 +273,7 @@ dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *hum
     level = rt_hw_interrupt_disable();
 
     rt_pin_write(pin, PIN_HIGH);
-//    dht11_delay_us(DHT11_WAIT_RESPONSE);
-		rt_hw_us_delay(DHT11_WAIT_RESPONSE);
+    rt_hw_us_delay(DHT11_WAIT_RESPONSE);
     /* 切换为输入模式，等待 DHT11 响应 */
     rt_pin_mode(pin, PIN_MODE_INPUT_PULLUP);
 
@@ -152,7 +289,7 @@ dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *hum
     /* 读取 5 个字节数据 */
     for (rt_uint8_t i = 0; i < 5; i++)
     {
-        data[i] = dht11_read_byte(pin);
+        data[i] = dht11_read_byte(pin, (pulse_us != RT_NULL) ? &pulse_us[i * 8] : RT_NULL);
         if (data[i] < 0)
         {
             rt_hw_interrupt_enable(level);
@@ -179,3 +316,33 @@ dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *hum
 
     return DHT11_OK;
 }
+
+/* 读取 DHT11 温湿度数据并记录每一位的高电平宽度 */
+dht11_result_t dht11_read_pulses(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi,
+                                 rt_uint16_t *pulse_us)
+{
+    dht11_result_t result;
+    rt_base_t level;
+
+    /* 异步读取进行中时不能占用总线 */
+    level = rt_hw_interrupt_disable();
+    if (dev->state != DHT11_STATE_IDLE)
+    {
+        rt_hw_interrupt_enable(level);
+        return DHT11_ERROR_BUSY;
+    }
+    dev->state = DHT11_STATE_START;
+    rt_hw_interrupt_enable(level);
+
+    result = dht11_read_blocking(dev, temp, humi, pulse_us);
+
+    dev->state = DHT11_STATE_IDLE;
+
+    return result;
+}
+
+/* 读取 DHT11 温湿度数据 */
+dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi)
+{
+    return dht11_read_pulses(dev, temp, humi, RT_NULL);
+}
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2025-11-11     User         DHT11 温湿度传感器驱动头文件
+ * 2026-10-19     User         增加异步读取接口
+ * 2026-10-19     User         增加脉宽记录接口，用于时序自检
  */
 
 #ifndef DRV_DHT11_H
@@ -15,22 +17,40 @@
 #include <rtdevice.h>
 #include "drv_pin.h"
 
-/* DHT11 设备结构体 */
-typedef struct
-{
-    rt_base_t pin;          /* DHT11 数据引脚 */
-    rt_uint8_t humidity;    /* 湿度整数部分 */
-    rt_uint8_t temperature; /* 温度整数部分 */
-} dht11_device_t;
-
 /* DHT11 读取结果枚举 */
 typedef enum
 {
     DHT11_OK = 0,           /* 读取成功 */
     DHT11_ERROR_TIMEOUT,    /* 超时错误 */
-    DHT11_ERROR_CHECKSUM    /* 校验和错误 */
+    DHT11_ERROR_CHECKSUM,   /* 校验和错误 */
+    DHT11_ERROR_BUSY        /* 上一次异步读取尚未完成 */
 } dht11_result_t;
 
+typedef struct dht11_device dht11_device_t;
+
+/**
+ * @brief DHT11 异步读取完成回调
+ * @note  在引脚中断或软件定时器上下文中调用，不能阻塞，应尽快返回
+ */
+typedef void (*dht11_callback_t)(dht11_device_t *dev, dht11_result_t result);
+
+/* DHT11 设备结构体 */
+struct dht11_device
+{
+    rt_base_t pin;          /* DHT11 数据引脚 */
+    rt_uint8_t humidity;    /* 湿度整数部分 */
+    rt_uint8_t temperature; /* 温度整数部分 */
+
+    /* 以下为异步读取内部状态，外部不要直接访问 */
+    struct rt_timer timer;          /* 起始信号/帧超时定时器 */
+    dht11_callback_t callback;      /* 读取完成回调 */
+    volatile rt_uint8_t state;      /* 异步读取状态 */
+    rt_uint8_t edge_count;          /* 已捕获的下降沿数量 */
+    rt_uint32_t last_edge;          /* 上一个下降沿的时间戳（DWT 周期） */
+    rt_uint32_t bit1_thresh;        /* 判定为 1 的下降沿间隔阈值（DWT 周期） */
+    rt_uint8_t data[5];             /* 接收数据缓冲 */
+};
+
 /**
  * @brief 初始化 DHT11 设备
  * @param dev DHT11 设备结构体指针
@@ -40,7 +60,7 @@ typedef enum
 rt_err_t dht11_init(dht11_device_t *dev, rt_base_t pin);
 
 /**
- * @brief 读取 DHT11 温湿度数据
+ * @brief 读取 DHT11 温湿度数据（阻塞方式）
  * @param dev DHT11 设备结构体指针
  * @param temp 温度指针（输出参数）
  * @param humi 湿度指针（输出参数）
@@ -48,4 +68,31 @@ rt_err_t dht11_init(dht11_device_t *dev, rt_base_t pin);
  */
 dht11_result_t dht11_read(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi);
 
+/* 一帧数据的位数 */
+#define DHT11_FRAME_BITS        40
+
+/**
+ * @brief 读取 DHT11 温湿度数据，并记录每一位的高电平宽度（阻塞方式）
+ * @param dev DHT11 设备结构体指针
+ * @param temp 温度指针（输出参数）
+ * @param humi 湿度指针（输出参数）
+ * @param pulse_us 输出 DHT11_FRAME_BITS 个高电平宽度（us），可为 RT_NULL
+ * @return dht11_result_t 读取结果
+ */
+dht11_result_t dht11_read_pulses(dht11_device_t *dev, rt_uint8_t *temp, rt_uint8_t *humi,
+                                 rt_uint16_t *pulse_us);
+
+/**
+ * @brief 异步读取 DHT11 温湿度数据
+ *
+ * 起始信号由软件定时器产生，数据位由下降沿中断解码，调用方不会被阻塞。
+ * 读取完成（成功或失败）后调用 callback，结果保存在 dev->temperature
+ * 和 dev->humidity 中。
+ *
+ * @param dev DHT11 设备结构体指针
+ * @param callback 读取完成回调，可为 RT_NULL
+ * @return RT_EOK 已启动，-RT_EBUSY 上一次读取尚未完成
+ */
+rt_err_t dht11_read_async(dht11_device_t *dev, dht11_callback_t callback);
+
 #endif /* DRV_DHT11_H */
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         Cortex-M33 DWT 周期计数器驱动实现
+ */
+
+#include "drv_dwt.h"
+
+/* 使能 DWT 周期计数器 */
+int dwt_init(void)
+{
+    /* 打开 DWT/ITM 跟踪模块电源 */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    /* 部分实现不带周期计数器 */
+    if (DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk)
+    {
+        return -RT_ENOSYS;
+    }
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return RT_EOK;
+}
+
+/* 在板级初始化阶段使能，之后所有驱动都可以直接使用 */
+INIT_BOARD_EXPORT(dwt_init);
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         Cortex-M33 DWT 周期计数器驱动头文件
+ */
+
+#ifndef DRV_DWT_H
+#define DRV_DWT_H
+
+#include <rtthread.h>
+#include <board.h>
+
+/**
+ * @brief 使能 DWT 周期计数器（CYCCNT）
+ * @return RT_EOK 成功，-RT_ENOSYS 内核未实现周期计数器
+ */
+int dwt_init(void);
+
+/**
+ * @brief 读取当前周期计数值，32 位回绕，差值运算天然处理回绕
+ */
+rt_inline rt_uint32_t dwt_get_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief 每微秒的内核时钟周期数，随 SystemCoreClock 变化
+ */
+rt_inline rt_uint32_t dwt_cycles_per_us(void)
+{
+    return SystemCoreClock / 1000000U;
+}
+
+/**
+ * @brief 微秒转换为周期数
+ */
+rt_inline rt_uint32_t dwt_us_to_cycles(rt_uint32_t us)
+{
+    return us * dwt_cycles_per_us();
+}
+
+/**
+ * @brief 周期数转换为微秒
+ */
+rt_inline rt_uint32_t dwt_cycles_to_us(rt_uint32_t cycles)
+{
+    return cycles / dwt_cycles_per_us();
+}
+
+#endif /* DRV_DWT_H */
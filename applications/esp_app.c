@@ -1,72 +1,911 @@
 #include "esp_app.h"
 #include "mydefine.h"
+#include "flash_fifo.h"
+#include "app_config.h"
 #include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
 
-/* 串口设备句柄 */
-static rt_device_t esp_uart = RT_NULL;
+/* 连接状态：由命令结果和模块主动上报共同维护 */
+static volatile esp_link_t esp_link = ESP_LINK_DOWN;
+
+/* 模块已复位并完成基本配置；收到 ready（模块意外复位）或命令超时后清除 */
+static volatile rt_bool_t esp_module_ready = RT_FALSE;
+
+/* 重连失败的退避：从 ESP_RETRY_MIN_MS 起每次加倍，最长 ESP_RETRY_MAX_MS */
+#define ESP_RETRY_MIN_MS        1000
+#define ESP_RETRY_MAX_MS        60000
+/* 同一层连续失败该次数后从下一层重建 */
+#define ESP_ESCALATE_AFTER      3
+/* 在线时查询信号强度的周期 */
+#define ESP_RSSI_POLL_MS        60000
+
+/* 模块复位后协商的 uart1 波特率（从高到低尝试），不超过 esp_baud_max */
+static const rt_uint32_t esp_bauds[] = { BAUD_RATE_921600, BAUD_RATE_460800 };
+static rt_uint32_t esp_baud_max = ESP_BAUD_MAX;
+static rt_uint8_t esp_baud_failed = 0;              // 切换失败过的波特率（esp_bauds 下标位），以后复位不再尝试
+
+static rt_uint8_t esp_failures = 0;
+static rt_uint32_t esp_jitter_seed = 0x2545F491;
+static rt_tick_t esp_rssi_next;
+static esp_health_t esp_health;
+
+/* 发布失败计数（入队失败、模块返回错误或超时） */
+static rt_uint32_t esp_pub_failed = 0;
+
+/* 发布方式计数和切换到 MQTTPUBRAW 的 payload 长度 */
+static rt_uint32_t esp_pub_inline = 0;
+static rt_uint32_t esp_pub_raw = 0;
+static rt_size_t esp_pubraw_threshold = ESP_PUBRAW_THRESHOLD;
+
+/* 属性上报主题，两种发布命令共用 */
+#define ESP_REPORT_TOPIC        "$oc/devices/" HUAWEI_MQTT_USERNAME "/sys/properties/report"
+/* 内联发布时 payload 前后的命令文本（qos 0） */
+#define ESP_PUB_INLINE_HEAD     "AT+MQTTPUB=0,\"" ESP_REPORT_TOPIC "\",\""
+#define ESP_PUB_INLINE_TAIL     "\",0,0"
+/* MQTTPUBRAW 命令头缓冲区大小 */
+#define ESP_PUBRAW_CMD_MAX      128
+/* 异步发布最多拼接的 JSON 片段数 */
+#define ESP_PUB_PARTS_MAX       5
+
+/* 下行主题前缀：平台命令（commands）和属性设置（properties/set），应答发到对应的 response 主题 */
+#define ESP_DOWN_TOPIC          "$oc/devices/" HUAWEI_MQTT_USERNAME "/sys/"
+/* 下行 request_id 和名称的最大长度（含结尾） */
+#define ESP_REQUEST_ID_MAX      48
+#define ESP_DOWN_NAME_MAX       32
+
+typedef enum
+{
+    ESP_DOWN_COMMAND = 0,       /* 平台命令，配置项在 paras 中 */
+    ESP_DOWN_PROPERTY_SET,      /* 属性设置，配置项在各服务的 properties 中 */
+} esp_down_kind_t;
+
+/* 解析后的下行命令，应用后由ESP线程按 request_id 应答 */
+typedef struct
+{
+    rt_uint8_t kind;
+    rt_uint8_t applied;                     /* 已应用的配置项数 */
+    rt_uint8_t rejected;                    /* 名称未知、超出范围或不是整数的配置项数 */
+    rt_uint8_t truncated;                   /* 消息超过一行的长度上限，未应用 */
+    char request_id[ESP_REQUEST_ID_MAX];
+    char name[ESP_DOWN_NAME_MAX];           /* 命令名，属性设置为空 */
+    char bad_key[ESP_DOWN_NAME_MAX];        /* 第一个被拒绝的配置项 */
+} esp_downlink_t;
+
+/* 上行消息队列：GPS线程投递电子围栏事件和轨迹分段，接收线程投递下行命令的应答，ESP线程上报 */
+#define ESP_UPLINK_QUEUE_LEN    8
+
+typedef enum
+{
+    ESP_MSG_GEOFENCE = 0,
+    ESP_MSG_TRACK,
+    ESP_MSG_SERVICES,           /* 仅用于 flash 记录：类型字节后是 services[] 文本 */
+    ESP_MSG_RESPONSE,           /* 下行命令的应答，不存 flash */
+} esp_msg_type_t;
+
+typedef struct
+{
+    rt_uint8_t type;
+    union
+    {
+        geofence_event_t geofence;
+        struct
+        {
+            rt_uint16_t points;
+            rt_uint8_t len;
+            rt_uint8_t data[GPS_TRACK_SEGMENT_MAX];
+        } track;
+        esp_downlink_t response;
+    } body;
+} esp_msg_t;
+
+static rt_mq_t esp_uplink_mq = RT_NULL;
+static rt_uint32_t esp_uplink_dropped = 0;
+
+/*
+ * 断网缓存：链路断开、上行队列满或发布失败的消息存入 flash 队列，
+ * 连上 MQTT 后队列空闲时每隔 esp_drain_interval_ms 补发一条，发布成功才取走。
+ * 记录为消息类型字节加消息内容，取出时不需要额外的 RAM。
+ */
+static rt_uint32_t esp_drain_interval_ms = ESP_DRAIN_INTERVAL_MS;
+static rt_uint8_t esp_store_buf[ESP_STORE_RECORD_MAX + 1];
+static struct rt_semaphore esp_store_sem;
+static rt_err_t esp_store_result;
+static rt_uint32_t esp_store_sent = 0;
+static rt_uint8_t esp_drain_failures = 0;
+
+/* 下行命令计数 */
+static rt_uint32_t esp_down_received = 0;
+static rt_uint32_t esp_down_rejected = 0;
+static rt_uint32_t esp_down_unanswered = 0;
+
+static void esp_publish_done(rt_err_t result, const char *resp, void *arg);
+static void esp_json_emit(const char *data, rt_size_t len, void *ctx);
+
+/* 消息的有效长度，轨迹分段只存实际字节 */
+static rt_size_t esp_msg_size(const esp_msg_t *msg)
+{
+    if (msg->type == ESP_MSG_TRACK) {
+        return offsetof(esp_msg_t, body.track.data) + msg->body.track.len;
+    }
+    return offsetof(esp_msg_t, body) + sizeof(geofence_event_t);
+}
+
+/* 存入 flash，失败时丢弃并计数 */
+static void esp_store(const esp_msg_t *msg)
+{
+    if (flash_fifo_push(msg, esp_msg_size(msg)) != RT_EOK) {
+        esp_uplink_dropped++;
+        rt_kprintf("[ESP] uplink store failed, %d dropped\n", esp_uplink_dropped);
+    }
+}
+
+/* 投递上行消息，未连接或队列满时存入 flash */
+static void esp_post(const esp_msg_t *msg)
+{
+    if (esp_link != ESP_LINK_MQTT || esp_uplink_mq == RT_NULL ||
+        rt_mq_send(esp_uplink_mq, msg, sizeof(*msg)) != RT_EOK) {
+        esp_store(msg);
+    }
+}
+
+/**
+ * @brief 存入一批 services[] 项（遥测批次，断网时在遥测线程中调用）
+ * @param services 逗号分隔的服务项 JSON 文本
+ * @return RT_EOK 成功
+ */
+rt_err_t esp_store_services(const char *services)
+{
+    rt_size_t len = strlen(services);
+    rt_uint8_t *record;
+    rt_err_t result;
+
+    if (len + 1 > ESP_STORE_RECORD_MAX) {
+        return -RT_EINVAL;
+    }
+    record = rt_malloc(len + 1);
+    if (record == RT_NULL) {
+        return -RT_ENOMEM;
+    }
+    record[0] = ESP_MSG_SERVICES;
+    rt_memcpy(&record[1], services, len);
+    result = flash_fifo_push(record, len + 1);
+    rt_free(record);
+    return result;
+}
+
+/**
+ * @brief 投递电子围栏事件（geofence回调，在GPS线程中调用，不阻塞）
+ */
+void esp_post_geofence(const geofence_event_t *event)
+{
+    esp_msg_t msg;
+
+    msg.type = ESP_MSG_GEOFENCE;
+    msg.body.geofence = *event;
+    esp_post(&msg);
+}
+
+/**
+ * @brief 投递轨迹分段（gps_track回调，在GPS线程中调用，不阻塞）
+ */
+void esp_post_track(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points)
+{
+    esp_msg_t msg;
+
+    if (len > sizeof(msg.body.track.data)) {
+        return;
+    }
+    msg.type = ESP_MSG_TRACK;
+    msg.body.track.points = points;
+    msg.body.track.len = len;
+    rt_memcpy(msg.body.track.data, data, len);
+    esp_post(&msg);
+}
 
 /**
  * @brief 发送字符串到ESP模块
  */
 void esp_send(const char *data)
 {
-    if (esp_uart && data) {
-        rt_device_write(esp_uart, 0, data, strlen(data));
+    if (data) {
+        esp_at_write(data, strlen(data));
     }
 }
 
 /**
- * @brief ESP线程入口函数
- * @param parameter 线程参数（未使用）
+ * @brief 获取当前连接状态
  */
-static void esp_thread_entry(void *parameter)
+esp_link_t esp_get_link(void)
 {
-    char cmd[256];
+    return esp_link;
+}
 
-    rt_kprintf("[ESP] Thread started!\n");
+/* 链路状态变化时更新在线时长、断线时刻和重连耗时 */
+static void esp_link_set(esp_link_t link)
+{
+    rt_tick_t now = rt_tick_get();
+
+    if (esp_link == ESP_LINK_MQTT && link != ESP_LINK_MQTT) {
+        esp_health.connected_ms += (now - esp_health.up_since) * 1000 / RT_TICK_PER_SECOND;
+        esp_health.down_since = now;
+    } else if (esp_link != ESP_LINK_MQTT && link == ESP_LINK_MQTT) {
+        esp_health.up_since = now;
+        if (esp_health.connects++ > 0) {
+            rt_uint32_t ms = (now - esp_health.down_since) * 1000 / RT_TICK_PER_SECOND;
+
+            esp_health.reconnects++;
+            esp_health.last_reconnect_ms = ms;
+            esp_health.total_reconnect_ms += ms;
+            if (ms > esp_health.max_reconnect_ms) {
+                esp_health.max_reconnect_ms = ms;
+            }
+        }
+    }
+    esp_link = link;
+}
+
+/* 模块主动上报：Wi-Fi/MQTT 断开或模块意外复位时降到对应的状态，由ESP线程只重建断开的那一层 */
+static void esp_urc_wifi_disconnect(const char *line, rt_size_t len)
+{
+    if (esp_link != ESP_LINK_DOWN) {
+        esp_health.wifi_drops++;
+    }
+    esp_link_set(ESP_LINK_DOWN);
+    rt_kprintf("[ESP] WiFi disconnected\n");
+}
+
+static void esp_urc_wifi_got_ip(const char *line, rt_size_t len)
+{
+    if (esp_link == ESP_LINK_DOWN) {
+        esp_link_set(ESP_LINK_WIFI);
+    }
+}
+
+static void esp_urc_mqtt_connected(const char *line, rt_size_t len)
+{
+    esp_link_set(ESP_LINK_MQTT);
+}
+
+static void esp_urc_mqtt_disconnected(const char *line, rt_size_t len)
+{
+    if (esp_link == ESP_LINK_MQTT) {
+        esp_health.mqtt_drops++;
+        esp_link_set(ESP_LINK_WIFI);
+    }
+    rt_kprintf("[ESP] MQTT disconnected\n");
+}
+
+static void esp_urc_ready(const char *line, rt_size_t len)
+{
+    esp_module_ready = RT_FALSE;
+    esp_link_set(ESP_LINK_DOWN);
+}
+
+/* 复制 [begin, end) 的文本，放不下时截断并返回 RT_FALSE */
+static rt_bool_t esp_copy_span(char *dst, rt_size_t size, const char *begin, const char *end)
+{
+    rt_size_t n = end - begin;
+    rt_bool_t fits = n < size;
+
+    if (!fits) {
+        n = size - 1;
+    }
+    rt_memcpy(dst, begin, n);
+    dst[n] = '\0';
+    return fits;
+}
+
+/* 取字符串成员的值，key 含引号和冒号，如 "\"command_name\":\""；不处理转义，找不到时置空 */
+static void esp_json_get_string(const char *json, const char *key, char *dst, rt_size_t size)
+{
+    const char *p = strstr(json, key);
+    const char *end;
 
-    /* 1. 复位模块 */
-    esp_send("AT+RST\r\n");
-    rt_thread_mdelay(2000);
+    dst[0] = '\0';
+    if (p != RT_NULL) {
+        p += strlen(key);
+        end = strchr(p, '"');
+        if (end != RT_NULL) {
+            esp_copy_span(dst, size, p, end);
+        }
+    }
+}
+
+/* 主题中 request_id= 之前是否为 kind（如 "/sys/commands/"） */
+static rt_bool_t esp_topic_is(const char *topic, const char *rid, const char *kind)
+{
+    rt_size_t n = strlen(kind);
+
+    return (rt_size_t)(rid - topic) >= n && strncmp(rid - n, kind, n) == 0;
+}
+
+/* 拒绝一个配置项，记下第一个被拒绝的名称 */
+static void esp_down_reject(esp_downlink_t *down, const char *key)
+{
+    if (down->rejected++ == 0) {
+        rt_strncpy(down->bad_key, key, sizeof(down->bad_key) - 1);
+    }
+    rt_kprintf("[ESP] downlink: %s rejected\n", key);
+}
+
+/*
+ * 应用一个扁平对象中的配置项：{"名称":整数|true|false,...}，p 指向 '{' 之后
+ * 遇到字符串或嵌套对象的值时拒绝该项并停止解析这个对象
+ */
+static void esp_down_apply_object(const char *p, esp_downlink_t *down)
+{
+    char key[ESP_DOWN_NAME_MAX];
 
-    /* 2. 测试AT */
-    esp_send("AT\r\n");
-    rt_thread_mdelay(500);
+    while (1) {
+        const char *end;
+        char *vend;
+        long value;
+        int id;
 
-    /* 3. 设置STA模式 */
-    esp_send("AT+CWMODE=1\r\n");
-    rt_thread_mdelay(500);
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        if (*p != '"' || (end = strchr(p + 1, '"')) == RT_NULL) {
+            return;
+        }
+        id = esp_copy_span(key, sizeof(key), p + 1, end) ? app_cfg_find(key) : -1;
+        p = end + 1;
+        while (*p == ' ' || *p == ':') {
+            p++;
+        }
 
-    /* 4. 连接WiFi */
-    rt_snprintf(cmd, sizeof(cmd), "AT+CWJAP=\"%s\",\"%s\"\r\n", WIFI_NAME, WIFI_PWD);
-    esp_send(cmd);
-    rt_thread_mdelay(5000);
-    rt_kprintf("[ESP] WiFi connecting...\n");
+        if (strncmp(p, "true", 4) == 0) {
+            value = 1;
+            p += 4;
+        } else if (strncmp(p, "false", 5) == 0) {
+            value = 0;
+            p += 5;
+        } else {
+            value = strtol(p, &vend, 10);
+            if (vend == p) {
+                esp_down_reject(down, key);
+                return;
+            }
+            p = vend;
+            if (*p != ',' && *p != '}' && *p != ' ') {
+                // 小数或指数：整项拒绝
+                esp_down_reject(down, key);
+                p += strcspn(p, ",}");
+                continue;
+            }
+        }
+
+        if (id >= 0 && app_cfg_set((app_cfg_id_t)id, (rt_int32_t)value) == RT_EOK) {
+            down->applied++;
+        } else {
+            esp_down_reject(down, key);
+        }
+    }
+}
+
+/*
+ * 下行消息：+MQTTSUBRECV:<LinkID>,"<topic>",<len>,<data>
+ * 平台命令和属性设置中的配置项写入 app_config 并立即生效，应答交给ESP线程发布
+ * （在接收线程中调用，不能发 AT 命令）
+ */
+static void esp_urc_mqtt_recv(const char *line, rt_size_t len)
+{
+    static esp_msg_t msg;
+    esp_downlink_t *down = &msg.body.response;
+    const char *topic, *topic_end, *rid, *data;
+    rt_size_t data_len;
+
+    esp_down_received++;
+    topic = strchr(line, '"');
+    topic_end = topic ? strchr(topic + 1, '"') : RT_NULL;
+    data = topic_end ? strchr(topic_end + 1, ',') : RT_NULL;
+    rid = topic ? strstr(topic, "request_id=") : RT_NULL;
+    if (data == RT_NULL || rid == RT_NULL || rid > topic_end ||
+        (!esp_topic_is(topic, rid, "/sys/commands/") && !esp_topic_is(topic, rid, "/sys/properties/set/"))) {
+        esp_down_rejected++;
+        rt_kprintf("[ESP] downlink ignored: %.*s\n", (int)(len > 96 ? 96 : len), line);
+        return;
+    }
+    data_len = strtoul(data + 1, (char **)&data, 10);
+    data++;
+
+    rt_memset(&msg, 0, sizeof(msg));
+    msg.type = ESP_MSG_RESPONSE;
+    if (!esp_copy_span(down->request_id, sizeof(down->request_id), rid + 11, topic_end) ||
+        strpbrk(down->request_id, ",\\") != RT_NULL) {
+        // 无法原样带回的 request_id 不能应答，平台侧按超时处理
+        esp_down_rejected++;
+        rt_kprintf("[ESP] downlink request_id unusable\n");
+        return;
+    }
+
+    if (esp_topic_is(topic, rid, "/sys/commands/")) {
+        down->kind = ESP_DOWN_COMMAND;
+        esp_json_get_string(data, "\"command_name\":\"", down->name, sizeof(down->name));
+    } else {
+        down->kind = ESP_DOWN_PROPERTY_SET;
+    }
+
+    if (strlen(data) < data_len) {
+        // 超过 ESP_AT_LINE_MAX 的部分已被丢弃，不应用残缺的消息
+        down->truncated = 1;
+    } else if (down->kind == ESP_DOWN_COMMAND) {
+        const char *paras = strstr(data, "\"paras\":{");
+
+        if (paras != RT_NULL) {
+            esp_down_apply_object(paras + 9, down);
+        }
+    } else {
+        const char *props = data;
+
+        while ((props = strstr(props, "\"properties\":{")) != RT_NULL) {
+            props += 14;
+            esp_down_apply_object(props, down);
+        }
+    }
+    if (down->truncated || down->rejected || down->applied == 0) {
+        esp_down_rejected++;
+    }
+
+    if (esp_uplink_mq == RT_NULL || rt_mq_send(esp_uplink_mq, &msg, sizeof(msg)) != RT_EOK) {
+        esp_down_unanswered++;
+        rt_kprintf("[ESP] downlink %s applied, response dropped\n", down->request_id);
+    }
+}
+
+/* 执行一步连接命令，失败时说明是哪一步；超时说明模块无响应，下次从复位开始 */
+static rt_err_t esp_step(const char *name, const char *cmd, const char *expect, rt_int32_t timeout_ms)
+{
+    rt_err_t ret = esp_at_exec(cmd, expect, RT_NULL, 0, timeout_ms);
+
+    if (ret != RT_EOK) {
+        rt_kprintf("[ESP] %s failed (%s)\n", name, ret == -RT_ETIMEOUT ? "timeout" : "error");
+        if (ret == -RT_ETIMEOUT) {
+            esp_module_ready = RT_FALSE;
+        }
+    }
+    return ret;
+}
+
+/* 用 AT 探测当前波特率下链路是否通 */
+static rt_bool_t esp_baud_probe(void)
+{
+    for (rt_uint8_t i = 0; i < ESP_BAUD_PROBES; i++) {
+        if (esp_at_exec("AT", RT_NULL, RT_NULL, 0, 200) == RT_EOK) {
+            return RT_TRUE;
+        }
+    }
+    return RT_FALSE;
+}
+
+/* 切换的各步之间独占 AT 链路，见 esp_baud_switch() */
+static rt_err_t esp_baud_switch_locked(rt_uint32_t baud)
+{
+    rt_uint32_t old = esp_at_get_baud();
+    char cmd[40];
+
+    if (baud == old) {
+        return RT_EOK;
+    }
+    rt_snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%d,8,1,0,0", baud);
+    if (esp_at_exec(cmd, RT_NULL, RT_NULL, 0, 1000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    // 模块回 OK 后才切换，uart1 等 OK 发完再跟着切
+    if (esp_at_set_baud(baud) == RT_EOK && esp_baud_probe()) {
+        return RT_EOK;
+    }
+
+    rt_kprintf("[ESP] link check at %d baud failed, falling back to %d\n", baud, old);
+    rt_snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%d,8,1,0,0", old);
+    for (rt_uint8_t i = 0; i < ESP_BAUD_PROBES; i++) {
+        if (esp_at_exec(cmd, RT_NULL, RT_NULL, 0, 200) == RT_EOK) {
+            break;
+        }
+    }
+    esp_at_set_baud(old);
+    return esp_baud_probe() ? -RT_ERROR : -RT_ETIMEOUT;
+}
+
+/**
+ * @brief 模块和 uart1 一起切到 baud（AT+UART_CUR，不写入模块 flash），AT 探测确认。
+ *        整个过程独占 AT 链路，其他线程和异步队列的命令不会夹在模块和 uart1 切换之间
+ * @return RT_EOK 成功；-RT_ERROR 模块拒绝或新波特率不通、已退回原波特率；
+ *         -RT_ETIMEOUT 退回后也不通，模块波特率未知
+ */
+static rt_err_t esp_baud_switch(rt_uint32_t baud)
+{
+    rt_err_t ret;
+
+    esp_at_acquire();
+    ret = esp_baud_switch_locked(baud);
+    esp_at_release();
+    return ret;
+}
+
+/* 模块不在 uart1 当前波特率上（切换中途出错）时，逐个波特率探测，找到后退回默认波特率 */
+static rt_err_t esp_baud_autodetect_locked(void)
+{
+    if (esp_at_set_baud(ESP_AT_DEFAULT_BAUD) == RT_EOK && esp_baud_probe()) {
+        return RT_EOK;
+    }
+    for (rt_uint8_t i = 0; i < sizeof(esp_bauds) / sizeof(esp_bauds[0]); i++) {
+        esp_at_set_baud(esp_bauds[i]);
+        if (esp_baud_probe()) {
+            rt_kprintf("[ESP] module found at %d baud\n", esp_bauds[i]);
+            return esp_baud_switch_locked(ESP_AT_DEFAULT_BAUD);
+        }
+    }
+    esp_at_set_baud(ESP_AT_DEFAULT_BAUD);
+    return -RT_ETIMEOUT;
+}
+
+static rt_err_t esp_baud_autodetect(void)
+{
+    rt_err_t ret;
+
+    esp_at_acquire();
+    ret = esp_baud_autodetect_locked();
+    esp_at_release();
+    return ret;
+}
+
+/**
+ * @brief 复位后把链路升到不超过 esp_baud_max 的最高波特率，都不行时留在默认波特率
+ * @return RT_EOK 链路可用，-RT_ETIMEOUT 模块失联
+ */
+static rt_err_t esp_baud_upgrade(void)
+{
+    for (rt_uint8_t i = 0; i < sizeof(esp_bauds) / sizeof(esp_bauds[0]); i++) {
+        rt_err_t ret;
+
+        if (esp_bauds[i] > esp_baud_max || (esp_baud_failed & (1 << i))) {
+            continue;
+        }
+        ret = esp_baud_switch(esp_bauds[i]);
+        if (ret == RT_EOK) {
+            rt_kprintf("[ESP] uart1 switched to %d baud\n", esp_bauds[i]);
+            return RT_EOK;
+        }
+        esp_baud_failed |= 1 << i;
+        if (ret == -RT_ETIMEOUT && esp_baud_autodetect() != RT_EOK) {
+            return -RT_ETIMEOUT;
+        }
+    }
+    return RT_EOK;
+}
+
+/* 模块层：复位，关闭回显，设置STA模式，协商波特率 */
+static rt_err_t esp_module_up(void)
+{
+    esp_link_set(ESP_LINK_DOWN);
+    esp_health.module_resets++;
+
+    // 模块复位后回到默认波特率，先让 uart1 和模块都回到默认波特率再发复位
+    if (esp_at_get_baud() != ESP_AT_DEFAULT_BAUD && esp_baud_switch(ESP_AT_DEFAULT_BAUD) != RT_EOK) {
+        esp_baud_autodetect();
+    }
+
+    if (esp_step("reset", "AT+RST", "ready", 5000) != RT_EOK) {
+        // 模块可能停在上次协商的波特率上，找到它，下次重试时复位能收到
+        esp_baud_autodetect();
+        return -RT_ERROR;
+    }
+    if (esp_step("echo off", "ATE0", RT_NULL, 1000) != RT_EOK ||
+        esp_step("station mode", "AT+CWMODE=1", RT_NULL, 1000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    if (esp_baud_upgrade() != RT_EOK) {
+        rt_kprintf("[ESP] module lost after baud change\n");
+        return -RT_ERROR;
+    }
+    esp_module_ready = RT_TRUE;
+    return RT_EOK;
+}
+
+/* Wi-Fi 层：连接AP，获取到IP后返回OK */
+static rt_err_t esp_wifi_up(void)
+{
+    char cmd[128];
+
+    rt_snprintf(cmd, sizeof(cmd), "AT+CWJAP=\"%s\",\"%s\"", WIFI_NAME, WIFI_PWD);
+    if (esp_step("WiFi join", cmd, RT_NULL, 20000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    esp_link_set(ESP_LINK_WIFI);
+    return RT_EOK;
+}
+
+/* MQTT 层：释放旧连接，配置用户和ClientID，连接服务器（模块不自动重连，由本状态机负责） */
+static rt_err_t esp_mqtt_up(void)
+{
+    char cmd[256];
+
+    esp_at_exec("AT+MQTTCLEAN=0", RT_NULL, RT_NULL, 0, 1000);
 
-    /* 5. 配置MQTT用户 */
     rt_snprintf(cmd, sizeof(cmd),
-        "AT+MQTTUSERCFG=0,1,\"NULL\",\"%s\",\"%s\",0,0,\"\"\r\n",
+        "AT+MQTTUSERCFG=0,1,\"NULL\",\"%s\",\"%s\",0,0,\"\"",
         HUAWEI_MQTT_USERNAME, HUAWEI_MQTT_PWD);
-    esp_send(cmd);
-    rt_thread_mdelay(1000);
+    if (esp_step("MQTT user config", cmd, RT_NULL, 2000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    rt_snprintf(cmd, sizeof(cmd), "AT+MQTTCLIENTID=0,\"%s\"", HUAWEI_MQTT_ClientID);
+    if (esp_step("MQTT client id", cmd, RT_NULL, 2000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    rt_snprintf(cmd, sizeof(cmd), "AT+MQTTCONN=0,\"%s\",%d,0",
+        HUAWEI_MQTT_ADDRESS, HUAWEI_MQTT_PORT);
+    if (esp_step("MQTT connect", cmd, RT_NULL, 10000) != RT_EOK) {
+        return -RT_ERROR;
+    }
+    /* 订阅下行命令，失败不影响上报（只是收不到配置修改） */
+    if (esp_at_cmd("AT+MQTTSUB=0,\"" ESP_DOWN_TOPIC "commands/#\",1", 3000) != RT_EOK ||
+        esp_at_cmd("AT+MQTTSUB=0,\"" ESP_DOWN_TOPIC "properties/set/#\",1", 3000) != RT_EOK) {
+        rt_kprintf("[ESP] downlink subscribe failed\n");
+    }
+    esp_link_set(ESP_LINK_MQTT);
+    return RT_EOK;
+}
 
-    /* 6. 配置MQTT ClientID */
-    rt_snprintf(cmd, sizeof(cmd), "AT+MQTTCLIENTID=0,\"%s\"\r\n", HUAWEI_MQTT_ClientID);
-    esp_send(cmd);
-    rt_thread_mdelay(1000);
+/**
+ * @brief 从当前状态重建断开的各层：模块未就绪时复位，Wi-Fi 断开时重新入网，
+ *        否则只重连 MQTT；同一层连续失败 ESP_ESCALATE_AFTER 次后从下一层重建
+ * @return RT_EOK 成功
+ */
+static rt_err_t esp_connect(void)
+{
+    rt_tick_t start = rt_tick_get();
+    const char *from;
+    rt_err_t ret = RT_EOK;
 
-    /* 7. 连接MQTT服务器 */
-    rt_snprintf(cmd, sizeof(cmd), "AT+MQTTCONN=0,\"%s\",%d,1\r\n",
-        HUAWEI_MQTT_ADDRESS, HUAWEI_MQTT_PORT);
-    esp_send(cmd);
-    rt_thread_mdelay(3000);
+    if (esp_failures > 0 && esp_failures % ESP_ESCALATE_AFTER == 0) {
+        // 多次失败：MQTT 层失败怀疑 Wi-Fi，Wi-Fi 层失败怀疑模块
+        if (esp_link == ESP_LINK_WIFI) {
+            esp_link_set(ESP_LINK_DOWN);
+        } else {
+            esp_module_ready = RT_FALSE;
+        }
+    }
+
+    from = !esp_module_ready ? "module" : esp_link == ESP_LINK_DOWN ? "WiFi" : "MQTT";
+    if (!esp_module_ready) {
+        ret = esp_module_up();
+    }
+    if (ret == RT_EOK && esp_link == ESP_LINK_DOWN) {
+        ret = esp_wifi_up();
+    }
+    if (ret == RT_EOK && esp_link != ESP_LINK_MQTT) {
+        ret = esp_mqtt_up();
+    }
+
+    if (ret != RT_EOK) {
+        if (esp_failures < 255) {
+            esp_failures++;
+        }
+        esp_health.attempts_failed++;
+        return ret;
+    }
+    esp_failures = 0;
+    esp_rssi_next = rt_tick_get();
+    rt_kprintf("[ESP] MQTT connected in %d ms (from %s layer)\n",
+               (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND, from);
+    return RT_EOK;
+}
+
+/* 重试等待：指数退避，在 [d/2, d] 内随机，避免多台设备同时重连 */
+static rt_uint32_t esp_backoff_ms(void)
+{
+    rt_uint32_t delay = ESP_RETRY_MIN_MS;
+    rt_uint8_t i;
+
+    for (i = 1; i < esp_failures && delay < ESP_RETRY_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > ESP_RETRY_MAX_MS) {
+        delay = ESP_RETRY_MAX_MS;
+    }
+
+    // xorshift32，种子混入节拍
+    esp_jitter_seed ^= rt_tick_get();
+    esp_jitter_seed ^= esp_jitter_seed << 13;
+    esp_jitter_seed ^= esp_jitter_seed >> 17;
+    esp_jitter_seed ^= esp_jitter_seed << 5;
+    return delay / 2 + esp_jitter_seed % (delay / 2 + 1);
+}
+
+/* 查询 AP 信号强度：+CWJAP:"<ssid>","<bssid>",<channel>,<rssi>,... */
+static void esp_poll_rssi(void)
+{
+    char resp[128];
+    const char *p;
+
+    esp_rssi_next = rt_tick_get() + rt_tick_from_millisecond(ESP_RSSI_POLL_MS);
+    if (esp_at_exec("AT+CWJAP?", RT_NULL, resp, sizeof(resp), 1000) != RT_EOK ||
+        (p = strstr(resp, "+CWJAP:\"")) == RT_NULL ||
+        (p = strstr(p, "\",\"")) == RT_NULL ||
+        (p = strchr(p + 3, '"')) == RT_NULL ||
+        (p = strchr(p + 2, ',')) == RT_NULL) {
+        return;
+    }
+    esp_health.rssi = (rt_int8_t)atoi(p + 1);
+}
+
+/* 下行应答的内容 */
+typedef struct
+{
+    const esp_downlink_t *down;
+    const char *desc;
+    int result_code;
+} esp_response_t;
+
+/* 空跑写入器，只为得到 payload 长度 */
+static void esp_length_emit(const char *data, rt_size_t len, void *ctx)
+{
+}
 
-    rt_kprintf("[ESP] MQTT connected!\n");
+/* 写应答 payload，命令名和被拒绝的配置项来自平台下发，按 JSON 字符串转义；返回 payload 长度 */
+static rt_size_t esp_response_payload(json_writer_t *w, const esp_response_t *resp)
+{
+    json_object_begin(w, RT_NULL);
+    json_int(w, "result_code", resp->result_code);
+    if (resp->down->kind == ESP_DOWN_COMMAND) {
+        json_string(w, "response_name", resp->down->name);
+        json_object_begin(w, "paras");
+        json_int(w, "applied", resp->down->applied);
+        json_string(w, "result_desc", resp->desc);
+        json_object_end(w);
+    } else {
+        json_string(w, "result_desc", resp->desc);
+    }
+    json_object_end(w);
+    return json_writer_flush(w);
+}
+
+/* MQTTPUBRAW 提示符之后：原样的应答 payload */
+static void esp_response_writer(void *arg)
+{
+    json_writer_t w;
 
-    /* 主循环 - 可以在这里周期性上报数据 */
+    json_writer_init(&w, esp_json_emit, RT_NULL, RT_FALSE);
+    esp_response_payload(&w, arg);
+}
+
+/* 应答下行命令：发到 request_id 对应的 response 主题，失败只计数（平台侧按超时处理） */
+static void esp_respond(const esp_downlink_t *down)
+{
+    char cmd[ESP_PUBRAW_CMD_MAX + ESP_REQUEST_ID_MAX];
+    char desc[48];
+    esp_response_t resp = { down, desc, 1 };
+    json_writer_t w;
+    rt_size_t len;
+
+    if (down->truncated) {
+        rt_strncpy(desc, "message too long", sizeof(desc));
+    } else if (down->rejected) {
+        rt_snprintf(desc, sizeof(desc), "rejected %s", down->bad_key);
+    } else if (down->applied == 0) {
+        rt_strncpy(desc, "no config item", sizeof(desc));
+    } else {
+        rt_strncpy(desc, "success", sizeof(desc));
+        resp.result_code = 0;
+    }
+
+    json_writer_init(&w, esp_length_emit, RT_NULL, RT_FALSE);
+    len = esp_response_payload(&w, &resp);
+    rt_snprintf(cmd, sizeof(cmd), "AT+MQTTPUBRAW=0,\"" ESP_DOWN_TOPIC "%s/response/request_id=%s\",%d,0,0",
+                down->kind == ESP_DOWN_COMMAND ? "commands" : "properties/set", down->request_id, len);
+
+    if (esp_at_exec_raw(cmd, esp_response_writer, &resp, "+MQTTPUB:OK", ESP_PUB_TIMEOUT_MS) != RT_EOK) {
+        esp_down_unanswered++;
+        rt_kprintf("[ESP] downlink %s response failed\n", down->request_id);
+    }
+}
+
+/* 上报一条上行消息，返回 0 成功；应答总是返回 0，不存 flash */
+static int esp_dispatch(const esp_msg_t *msg)
+{
+    if (msg->type == ESP_MSG_GEOFENCE) {
+        return esp_report_geofence(&msg->body.geofence);
+    } else if (msg->type == ESP_MSG_TRACK) {
+        return esp_report_track(msg->body.track.data, msg->body.track.len, msg->body.track.points);
+    } else if (msg->type == ESP_MSG_RESPONSE) {
+        esp_respond(&msg->body.response);
+        return 0;
+    }
+    return -1;
+}
+
+/* 补发的遥测批次发布完成（AT 工作线程中调用） */
+static void esp_store_done(rt_err_t result, const char *resp, void *arg)
+{
+    esp_publish_done(result, resp, arg);
+    esp_store_result = result;
+    rt_sem_release(&esp_store_sem);
+}
+
+/* 补发 flash 中最早的一条记录，成功后取走；同一条连续失败多次且链路仍在时放弃 */
+static void esp_drain_store(void)
+{
+    rt_uint32_t seq;
+    rt_ssize_t len = flash_fifo_peek(esp_store_buf, ESP_STORE_RECORD_MAX, &seq);
+    int result = -1;
+
+    if (len == 0) {
+        return;
+    }
+    if (len < 0 || (esp_store_buf[0] != ESP_MSG_SERVICES && (rt_size_t)len > sizeof(esp_msg_t))) {
+        // 放不下或格式不对的记录无法补发
+        flash_fifo_pop(seq);
+        return;
+    }
+
+    if (esp_store_buf[0] == ESP_MSG_SERVICES) {
+        esp_store_buf[len] = '\0';
+        if (esp_report_services((const char *)&esp_store_buf[1], esp_store_done, (void *)"stored services") == 0) {
+            rt_sem_take(&esp_store_sem, RT_WAITING_FOREVER);
+            result = esp_store_result == RT_EOK ? 0 : -1;
+        }
+    } else {
+        esp_msg_t msg;
+
+        rt_memcpy(&msg, esp_store_buf, len);
+        result = esp_dispatch(&msg);
+    }
+
+    // 发布期间写满换扇区时这条记录已被覆盖（计入丢失），pop 不会取走后面没发的记录
+    if (result == 0) {
+        flash_fifo_pop(seq);
+        esp_store_sent++;
+        esp_drain_failures = 0;
+    } else if (esp_link == ESP_LINK_MQTT && ++esp_drain_failures >= ESP_DRAIN_RETRY) {
+        rt_kprintf("[ESP] stored record rejected %d times, discarded\n", esp_drain_failures);
+        if (flash_fifo_pop(seq) == RT_EOK) {
+            esp_uplink_dropped++;
+        }
+        esp_drain_failures = 0;
+    }
+}
+
+/**
+ * @brief ESP线程入口函数
+ * @param parameter 线程参数（未使用）
+ */
+static void esp_thread_entry(void *parameter)
+{
+    rt_kprintf("[ESP] Thread started!\n");
+
+    /*
+     * 主循环 - 断线时只重建断开的那一层，失败按指数退避重试，电子围栏事件和轨迹分段到达时立即上报，发布失败的存入 flash；
+     * 没有新消息时按间隔补发 flash 中的记录。周期遥测由 telemetry 调度
+     */
     while (1)
     {
-        rt_thread_mdelay(5000);
+        esp_msg_t msg;
+        rt_uint32_t wait_ms;
+
+        if (esp_link != ESP_LINK_MQTT) {
+            if (esp_connect() != RT_EOK) {
+                rt_thread_mdelay(esp_backoff_ms());
+                continue;
+            }
+        }
+        if ((rt_int32_t)(rt_tick_get() - esp_rssi_next) >= 0) {
+            esp_poll_rssi();
+        }
+
+        wait_ms = flash_fifo_pending() > 0 ? esp_drain_interval_ms : 5000;
+        if (rt_mq_recv(esp_uplink_mq, &msg, sizeof(msg),
+                       rt_tick_from_millisecond(wait_ms)) > 0)
+        {
+            if (esp_dispatch(&msg) != 0) {
+                esp_store(&msg);
+            }
+        }
+        else if (flash_fifo_pending() > 0 && esp_link == ESP_LINK_MQTT)
+        {
+            esp_drain_store();
+        }
     }
 }
 
@@ -78,18 +917,31 @@ int esp_app_init(void)
 {
     rt_thread_t thread;
 
-    /* 查找并打开串口 */
-    esp_uart = rt_device_find(ESP_UART_NAME);
-    if (esp_uart == RT_NULL) {
-        rt_kprintf("[ESP] %s not found!\n", ESP_UART_NAME);
+    /* 打开串口，启动AT命令引擎 */
+    if (esp_at_init(ESP_UART_NAME) != RT_EOK) {
         return -1;
     }
-    rt_device_open(esp_uart, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX);
+    esp_at_urc_register("WIFI DISCONNECT", esp_urc_wifi_disconnect);
+    esp_at_urc_register("WIFI GOT IP", esp_urc_wifi_got_ip);
+    esp_at_urc_register("+MQTTCONNECTED", esp_urc_mqtt_connected);
+    esp_at_urc_register("+MQTTDISCONNECTED", esp_urc_mqtt_disconnected);
+    esp_at_urc_register("+MQTTSUBRECV", esp_urc_mqtt_recv);
+    esp_at_urc_register("ready", esp_urc_ready);
     rt_kprintf("[ESP] uart opened\n");
 
-    /* 等待模块稳定 */
-    rt_kprintf("[ESP] 等待模块稳定...\n");
-    rt_thread_mdelay(1000);
+    /* 断网缓存，flash 不可用时上行消息在断网期间丢弃 */
+    flash_fifo_init();
+    rt_sem_init(&esp_store_sem, "esp_st", 0, RT_IPC_FLAG_FIFO);
+
+    /* 电子围栏事件和轨迹分段经队列交给ESP线程上报 */
+    esp_uplink_mq = rt_mq_create("esp_up", sizeof(esp_msg_t),
+                                 ESP_UPLINK_QUEUE_LEN, RT_IPC_FLAG_FIFO);
+    if (esp_uplink_mq == RT_NULL) {
+        rt_kprintf("[ESP] uplink queue create failed!\n");
+        return -1;
+    }
+    geofence_set_handler(esp_post_geofence);
+    gps_track_set_sink(esp_post_track);
 
     /* 创建ESP线程 */
     thread = rt_thread_create("esp",
@@ -113,6 +965,148 @@ int esp_app_init(void)
     return 0;
 }
 
+/* 发布完成回调：只统计和打印失败，结果不影响调用者 */
+static void esp_publish_done(rt_err_t result, const char *resp, void *arg)
+{
+    if (result != RT_EOK) {
+        esp_pub_failed++;
+        rt_kprintf("[ESP] publish %s failed (%s)\n", (const char *)arg,
+                   result == -RT_ETIMEOUT ? "timeout" : "error");
+    }
+}
+
+/* 需要 AT 转义的字节数 */
+static rt_size_t esp_escape_count(const char *text, rt_size_t len)
+{
+    rt_size_t n = 0;
+
+    for (rt_size_t i = 0; i < len; i++) {
+        if (text[i] == '"' || text[i] == ',' || text[i] == '\\') {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* payload 长度决定发布方式：够长或内联命令超出模块限制时用 MQTTPUBRAW */
+static rt_bool_t esp_use_raw(rt_size_t payload_len, rt_size_t escaped_len)
+{
+    return payload_len >= esp_pubraw_threshold ||
+           sizeof(ESP_PUB_INLINE_HEAD ESP_PUB_INLINE_TAIL) + escaped_len > ESP_AT_CMD_MAX;
+}
+
+/* MQTTPUBRAW 命令头，长度和 qos 由调用者给出 */
+static void esp_pubraw_cmd(char *cmd, rt_size_t size, rt_size_t len, rt_uint8_t qos)
+{
+    rt_snprintf(cmd, size, "AT+MQTTPUBRAW=0,\"" ESP_REPORT_TOPIC "\",%d,%d,0", len, qos);
+}
+
+/**
+ * @brief 把若干段 JSON 文本拼成一条属性上报，经异步命令队列发出
+ * @param parts 依次拼接的 JSON 片段，不含 AT 转义
+ * @param count 片段数
+ * @param done 完成回调，RT_NULL 时只统计失败
+ * @param arg 回调参数
+ * @param name 服务名，失败时打印
+ * @return 0 已入队，-1 队列满或内存不足
+ */
+static int esp_publish_parts(const char *const *parts, int count, esp_at_callback_t done, void *arg,
+                             const char *name)
+{
+    rt_size_t lens[ESP_PUB_PARTS_MAX];
+    rt_size_t len = 0, escapes = 0;
+    rt_err_t result;
+    char *buf, *p;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        lens[i] = strlen(parts[i]);
+        len += lens[i];
+        escapes += esp_escape_count(parts[i], lens[i]);
+    }
+    if (done == RT_NULL) {
+        done = esp_publish_done;
+        arg = (void *)name;
+    }
+
+    // 命令和 payload 拼在一块内存上直接交给队列，不再复制
+    if (esp_use_raw(len, len + escapes)) {
+        const char *data;
+
+        buf = rt_malloc(ESP_PUBRAW_CMD_MAX + len);
+        if (buf == RT_NULL) {
+            esp_pub_failed++;
+            return -1;
+        }
+        esp_pubraw_cmd(buf, ESP_PUBRAW_CMD_MAX, len, 0);
+        data = p = buf + strlen(buf) + 1;
+        for (i = 0; i < count; p += lens[i], i++) {
+            rt_memcpy(p, parts[i], lens[i]);
+        }
+        result = esp_at_submit_owned(buf, data, len, "+MQTTPUB:OK", ESP_PUB_TIMEOUT_MS, done, arg);
+        esp_pub_raw++;
+    } else {
+        buf = rt_malloc(sizeof(ESP_PUB_INLINE_HEAD ESP_PUB_INLINE_TAIL) + len + escapes);
+        if (buf == RT_NULL) {
+            esp_pub_failed++;
+            return -1;
+        }
+        p = buf;
+        rt_memcpy(p, ESP_PUB_INLINE_HEAD, sizeof(ESP_PUB_INLINE_HEAD) - 1);
+        p += sizeof(ESP_PUB_INLINE_HEAD) - 1;
+        for (i = 0; i < count; i++) {
+            for (rt_size_t j = 0; j < lens[i]; j++) {
+                char c = parts[i][j];
+
+                if (c == '"' || c == ',' || c == '\\') {
+                    *p++ = '\\';
+                }
+                *p++ = c;
+            }
+        }
+        rt_memcpy(p, ESP_PUB_INLINE_TAIL, sizeof(ESP_PUB_INLINE_TAIL));
+        result = esp_at_submit_owned(buf, RT_NULL, 0, RT_NULL, ESP_PUB_TIMEOUT_MS, done, arg);
+        esp_pub_inline++;
+    }
+
+    if (result != RT_EOK) {
+        esp_pub_failed++;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 上报一组属性，经异步命令队列发出
+ * @param service_id 服务名
+ * @param props 属性成员 JSON 文本，如 "humidity":60，不需要 AT 转义
+ * @param done 完成回调，RT_NULL 时只统计失败
+ * @param arg 回调参数
+ * @return 0 已入队，-1 队列满
+ */
+int esp_report_props(const char *service_id, const char *props, esp_at_callback_t done, void *arg)
+{
+    const char *parts[] = {
+        "{\"services\":[{\"service_id\":\"", service_id, "\",\"properties\":{", props, "}}]}",
+    };
+
+    return esp_publish_parts(parts, 5, done, arg, service_id);
+}
+
+/**
+ * @brief 一次上报多项服务数据（IoTDA services[] 数组），经异步命令队列发出
+ * @param services 逗号分隔的服务项 JSON 文本，不需要 AT 转义
+ * @param done 完成回调
+ * @param arg 回调参数
+ * @return 0 已入队，-1 队列满或内存不足
+ */
+int esp_report_services(const char *services, esp_at_callback_t done, void *arg)
+{
+    const char *parts[] = { "{\"services\":[", services, "]}" };
+
+    return esp_publish_parts(parts, 3, done, arg, "services");
+}
+
 /**
  * @brief 上报基础数据
  */
@@ -132,24 +1126,308 @@ int esp_app_init(void)
 //    return 0;
 //}
 
+/* JSON 写入器的输出直接送串口 */
+static void esp_json_emit(const char *data, rt_size_t len, void *ctx)
+{
+    esp_at_write(data, len);
+}
+
+/* 一条流式属性上报：外层结构统一写，属性成员由 body 写 */
+typedef struct
+{
+    const char *service_id;
+    void (*body)(json_writer_t *w, const void *arg);
+    const void *arg;
+    rt_uint8_t qos;
+} esp_pub_t;
+
+/* 写 payload：属性上报外层结构和属性成员 */
+static void esp_pub_payload(json_writer_t *w, const esp_pub_t *pub)
+{
+    json_object_begin(w, RT_NULL);
+    json_array_begin(w, "services");
+    json_object_begin(w, RT_NULL);
+    json_string(w, "service_id", pub->service_id);
+    json_object_begin(w, "properties");
+    pub->body(w, pub->arg);
+    json_object_end(w);
+    json_object_end(w);
+    json_array_end(w);
+    json_object_end(w);
+    json_writer_flush(w);
+}
+
+/* 统计 payload 长度和需要 AT 转义的字节数，不输出 */
+typedef struct
+{
+    rt_size_t len;
+    rt_size_t escapes;
+} esp_pub_count_t;
+
+static void esp_count_emit(const char *data, rt_size_t len, void *ctx)
+{
+    esp_pub_count_t *count = ctx;
+
+    count->len += len;
+    count->escapes += esp_escape_count(data, len);
+}
+
+/* MQTTPUB：命令头、转义后的 payload、qos 和 retain */
+static void esp_pub_inline_writer(void *arg)
+{
+    const esp_pub_t *pub = arg;
+    json_writer_t w;
+
+    json_writer_init(&w, esp_json_emit, RT_NULL, RT_TRUE);
+    json_raw(&w, ESP_PUB_INLINE_HEAD);
+    esp_pub_payload(&w, pub);
+    json_raw(&w, pub->qos ? "\",1,0" : ESP_PUB_INLINE_TAIL);
+    json_writer_flush(&w);
+}
+
+/* MQTTPUBRAW 提示符之后：原样的 payload */
+static void esp_pub_raw_writer(void *arg)
+{
+    json_writer_t w;
+
+    json_writer_init(&w, esp_json_emit, RT_NULL, RT_FALSE);
+    esp_pub_payload(&w, arg);
+}
+
+/**
+ * @brief 边生成边发送一条属性上报并等待结果
+ *        先空跑一遍得到长度，长报文用 MQTTPUBRAW 原样发送，短报文用 MQTTPUB 内联发送
+ * @return 0 发布成功，-1 失败
+ */
+static int esp_publish_stream(const esp_pub_t *pub)
+{
+    esp_pub_count_t count = { 0, 0 };
+    json_writer_t w;
+    rt_err_t result;
+
+    json_writer_init(&w, esp_count_emit, &count, RT_FALSE);
+    esp_pub_payload(&w, pub);
+
+    if (esp_use_raw(count.len, count.len + count.escapes)) {
+        char cmd[ESP_PUBRAW_CMD_MAX];
+
+        esp_pubraw_cmd(cmd, sizeof(cmd), count.len, pub->qos);
+        result = esp_at_exec_raw(cmd, esp_pub_raw_writer, (void *)pub, "+MQTTPUB:OK", ESP_PUB_TIMEOUT_MS);
+        esp_pub_raw++;
+    } else {
+        result = esp_at_exec_stream(esp_pub_inline_writer, (void *)pub, "AT+MQTTPUB", RT_NULL, RT_NULL, 0,
+                                    ESP_PUB_TIMEOUT_MS);
+        esp_pub_inline++;
+    }
+
+    esp_publish_done(result, RT_NULL, (void *)pub->service_id);
+    return result == RT_EOK ? 0 : -1;
+}
+
+typedef struct
+{
+    float density;
+    int hr;
+    int temp;
+    int humi;
+} esp_env_t;
+
+static void esp_env_body(json_writer_t *w, const void *arg)
+{
+    const esp_env_t *env = arg;
+
+    json_fixed(w, "density", env->density, 2);
+    json_int(w, "heart_rate", env->hr);
+    json_int(w, "temperature", env->temp);
+    json_int(w, "humidity", env->humi);
+}
+
 /**
- * @brief 上报环境数据
+ * @brief 上报环境数据，等待发布结果（最长 ESP_PUB_TIMEOUT_MS）
+ * @return 0 成功，-1 失败
  */
 int esp_report(float density, int hr, int temp, int humi)
 {
-    char cmd[512];
+    esp_env_t env = { density, hr, temp, humi };
+    esp_pub_t pub = { "BasedData", esp_env_body, &env, 0 };
 
-    rt_snprintf(cmd, sizeof(cmd),
-        "AT+MQTTPUB=0,\"$oc/devices/%s/sys/properties/report\","
-        "\"{\\\"services\\\":[{\\\"service_id\\\":\\\"BasedData\\\","
-        "\\\"properties\\\":{\\\"density\\\":%.2f,\\\"heart_rate\\\":%d,"
-        "\\\"temperature\\\":%d,\\\"humidity\\\":%d}}]}\",0,0\r\n",
-        HUAWEI_MQTT_USERNAME, density, hr, temp, humi);
-
-    esp_send(cmd);
-    rt_thread_mdelay(500);
-    return 0;
+    return esp_publish_stream(&pub);
+}
+
+static void esp_geofence_body(json_writer_t *w, const void *arg)
+{
+    const geofence_event_t *event = arg;
+
+    json_int(w, "zone_id", event->zone_id);
+    json_string(w, "zone_kind", event->kind == GEOFENCE_KIND_HAZARD ? "hazard" : "allowed");
+    json_string(w, "event", event->entered ? "enter" : "exit");
+    json_int(w, "latitude_e7", event->latitude);
+    json_int(w, "longitude_e7", event->longitude);
+    json_int(w, "utc", event->time);
+}
+
+/**
+ * @brief 上报电子围栏进出事件，坐标以 1e-7 度整数上报，等待发布结果
+ */
+int esp_report_geofence(const geofence_event_t *event)
+{
+    esp_pub_t pub = { "Geofence", esp_geofence_body, event, 1 };
+
+    return esp_publish_stream(&pub);
+}
+
+typedef struct
+{
+    const rt_uint8_t *data;
+    rt_size_t len;
+    rt_uint16_t points;
+} esp_track_t;
+
+static void esp_track_body(json_writer_t *w, const void *arg)
+{
+    const esp_track_t *track = arg;
+
+    json_int(w, "format", GPS_TRACK_FORMAT_VERSION);
+    json_int(w, "points", track->points);
+    json_base64(w, "segment", track->data, track->len);
+}
+
+/**
+ * @brief 上报一个压缩轨迹分段，二进制分段以 base64 编码放入属性，等待发布结果
+ */
+int esp_report_track(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points)
+{
+    esp_track_t track = { data, len, points };
+    esp_pub_t pub = { "Track", esp_track_body, &track, 0 };
+
+    return esp_publish_stream(&pub);
+}
+
+#ifdef RT_USING_FINSH
+typedef struct
+{
+    const char *note;
+    int seq;
+} esp_probe_t;
+
+static void esp_probe_body(json_writer_t *w, const void *arg)
+{
+    const esp_probe_t *probe = arg;
+
+    json_string(w, "note", probe->note);
+    json_int(w, "seq", probe->seq);
+}
+
+/**
+ * @brief 发布自检（esp_selftest.c）用的属性上报：note 和 seq 两个成员，走同步流式路径，等待发布结果
+ */
+int esp_report_probe(const char *service_id, const char *note, int seq)
+{
+    esp_probe_t probe = { note, seq };
+    esp_pub_t pub = { service_id, esp_probe_body, &probe, 0 };
+
+    return esp_publish_stream(&pub);
 }
+#endif /* RT_USING_FINSH */
 
 /* 使用 INIT_APP_EXPORT 宏，在系统启动时自动初始化 */
 INIT_APP_EXPORT(esp_app_init);
+
+/**
+ * @brief 发布统计，带参数时修改改用 MQTTPUBRAW 的 payload 长度：esp_pub 96
+ */
+static int esp_pub(int argc, char *argv[])
+{
+    if (argc == 2) {
+        esp_pubraw_threshold = atoi(argv[1]);
+    }
+    rt_kprintf("[ESP] publish inline: %d, raw: %d, failed: %d, raw threshold: %d bytes\n",
+               esp_pub_inline, esp_pub_raw, esp_pub_failed, esp_pubraw_threshold);
+    return 0;
+}
+MSH_CMD_EXPORT(esp_pub, show publish statistics or set MQTTPUBRAW threshold);
+
+/**
+ * @brief 断网缓存统计，带参数时修改补发间隔：esp_store 500
+ */
+static int esp_store_cmd(int argc, char *argv[])
+{
+    flash_fifo_stats_t fifo;
+
+    if (argc == 2) {
+        esp_drain_interval_ms = atoi(argv[1]);
+        if (esp_drain_interval_ms < 10) {
+            esp_drain_interval_ms = 10;
+        }
+    }
+    flash_fifo_get_stats(&fifo);
+    rt_kprintf("[ESP] stored pending: %d records / %d bytes, resent: %d, dropped: %d, lost on wrap: %d\n",
+               fifo.pending, fifo.pending_bytes, esp_store_sent, esp_uplink_dropped, fifo.lost);
+    rt_kprintf("[ESP] drain interval: %d ms\n", esp_drain_interval_ms);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(esp_store_cmd, esp_store, show offline store or set drain interval in ms);
+
+/**
+ * @brief 读取链路健康统计
+ */
+void esp_get_health(esp_health_t *health)
+{
+    *health = esp_health;
+}
+
+/**
+ * @brief 链路状态和健康统计
+ */
+static int esp_link_cmd(int argc, char *argv[])
+{
+    static const char *const names[] = { "down", "wifi", "mqtt" };
+    rt_tick_t now = rt_tick_get();
+    rt_uint32_t online_ms = esp_health.connected_ms;
+    rt_uint32_t session_s = 0;
+
+    if (esp_link == ESP_LINK_MQTT) {
+        session_s = (now - esp_health.up_since) / RT_TICK_PER_SECOND;
+        online_ms += session_s * 1000;
+    }
+    rt_kprintf("[ESP] link: %s, module: %s, session: %d s, online: %d s of %d s, rssi: %d dBm\n",
+               names[esp_link], esp_module_ready ? "ready" : "reset pending", session_s,
+               online_ms / 1000, now / RT_TICK_PER_SECOND, esp_health.rssi);
+    rt_kprintf("[ESP] connects: %d, reconnects: %d, failed attempts: %d, module resets: %d\n",
+               esp_health.connects, esp_health.reconnects, esp_health.attempts_failed,
+               esp_health.module_resets);
+    rt_kprintf("[ESP] drops wifi: %d, mqtt: %d, reconnect time last: %d ms, avg: %d ms, max: %d ms\n",
+               esp_health.wifi_drops, esp_health.mqtt_drops, esp_health.last_reconnect_ms,
+               esp_health.reconnects ? esp_health.total_reconnect_ms / esp_health.reconnects : 0,
+               esp_health.max_reconnect_ms);
+    rt_kprintf("[ESP] downlink received: %d, rejected: %d, unanswered: %d\n",
+               esp_down_received, esp_down_rejected, esp_down_unanswered);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(esp_link_cmd, esp_link, show WiFi/MQTT link state and reconnect statistics);
+
+/**
+ * @brief 查看 uart1 波特率，带参数时立即切换并作为以后复位协商的上限：esp_baud 460800
+ */
+static int esp_baud(int argc, char *argv[])
+{
+    if (argc == 2) {
+        rt_uint32_t baud = atoi(argv[1]);
+        rt_err_t ret;
+
+        // 切换和失败后的找回连成一段，ESP 线程和 AT 工作线程的命令在这之后才发出
+        esp_at_acquire();
+        esp_baud_max = baud;
+        esp_baud_failed = 0;
+        ret = esp_baud_switch_locked(baud);
+        if (ret == -RT_ETIMEOUT) {
+            esp_baud_autodetect_locked();
+        }
+        esp_at_release();
+        rt_kprintf("[ESP] switch to %d baud %s\n", baud, ret == RT_EOK ? "ok" : "failed");
+    }
+    rt_kprintf("[ESP] uart1: %d baud, negotiate up to %d baud; per-baud throughput in esp_at_stat\n",
+               esp_at_get_baud(), esp_baud_max);
+    return 0;
+}
+MSH_CMD_EXPORT(esp_baud, show or switch ESP uart baud rate);
@@ -3,6 +3,10 @@
 
 #include <rtthread.h>
 #include <rtdevice.h>
+#include "geofence.h"
+#include "gps_track.h"
+#include "esp_at.h"
+#include "json_writer.h"
 
 /* Wi-Fi 配置 */
 #define WIFI_NAME               "LP11"
@@ -18,10 +22,68 @@
 /* 串口设备名 */
 #define ESP_UART_NAME           "uart1"
 
+/* 模块复位后协商的最高串口波特率（AT+UART_CUR），失败时自动退回 */
+#define ESP_BAUD_MAX            BAUD_RATE_921600
+/* 切换波特率后 AT 探测的次数 */
+#define ESP_BAUD_PROBES         3
+
+/* MQTT 发布等待应答的超时时间（毫秒） */
+#define ESP_PUB_TIMEOUT_MS      3000
+
+/* payload 达到该字节数时改用 AT+MQTTPUBRAW：等提示符后原样发送，不做 AT 转义 */
+#define ESP_PUBRAW_THRESHOLD    96
+/* 模块单条 AT 命令的长度上限，内联发布超出时也改用 AT+MQTTPUBRAW */
+#define ESP_AT_CMD_MAX          256
+
+/* 断网缓存：恢复连接后补发 flash 中记录的间隔（毫秒），可用 esp_store 命令调整 */
+#define ESP_DRAIN_INTERVAL_MS   500
+/* 补发失败（链路仍在）达到该次数时放弃这条记录 */
+#define ESP_DRAIN_RETRY         3
+/* flash 记录最大长度：类型字节加一个遥测批次（TELEM_BATCH_BYTES） */
+#define ESP_STORE_RECORD_MAX    (1 + 1024)
+
+/* 连接状态 */
+typedef enum
+{
+    ESP_LINK_DOWN = 0,      /* 模块未就绪或 Wi-Fi 断开 */
+    ESP_LINK_WIFI,          /* Wi-Fi 已连接，MQTT 未连接 */
+    ESP_LINK_MQTT,          /* MQTT 已连接，可以上报 */
+} esp_link_t;
+
+/* 链路健康统计 */
+typedef struct
+{
+    rt_uint32_t connects;           /* MQTT 连接成功次数 */
+    rt_uint32_t reconnects;         /* 断线后重连成功次数 */
+    rt_uint32_t attempts_failed;    /* 失败的连接尝试次数 */
+    rt_uint32_t module_resets;      /* 模块复位次数 */
+    rt_uint32_t wifi_drops;         /* 在线时 Wi-Fi 断开次数 */
+    rt_uint32_t mqtt_drops;         /* Wi-Fi 仍在时 MQTT 断开次数 */
+    rt_uint32_t last_reconnect_ms;  /* 最近一次从断线到重新连上 MQTT 的时间 */
+    rt_uint32_t max_reconnect_ms;
+    rt_uint32_t total_reconnect_ms;
+    rt_uint32_t connected_ms;       /* 累计在线时间，不含当前这次连接 */
+    rt_tick_t up_since;             /* 当前连接建立的节拍 */
+    rt_tick_t down_since;           /* 最近一次断线的节拍 */
+    rt_int8_t rssi;                 /* AP 信号强度（dBm），0 表示未知 */
+} esp_health_t;
+
 /* API */
 int esp_init(void);
 void esp_send(const char *data);
+esp_link_t esp_get_link(void);
+void esp_get_health(esp_health_t *health);
 int esp_report_basic(int spo2, float density, int hr, int fall, int collision);
 int esp_report(float density, int hr, int temp, int humi);
+int esp_report_services(const char *services, esp_at_callback_t done, void *arg);
+int esp_report_props(const char *service_id, const char *props, esp_at_callback_t done, void *arg);
+int esp_report_geofence(const geofence_event_t *event);
+void esp_post_geofence(const geofence_event_t *event);
+int esp_report_track(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points);
+void esp_post_track(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points);
+rt_err_t esp_store_services(const char *services);
+#ifdef RT_USING_FINSH
+int esp_report_probe(const char *service_id, const char *note, int seq);
+#endif
 
 #endif /* ESP_APP_H */
@@ -0,0 +1,1098 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         ESP01S AT 命令引擎：按行解析响应与主动上报
+ */
+
+#include "esp_at.h"
+#include <string.h>
+
+/*
+ * 接收线程把串口数据逐字节拼成行，每一行依次判断：
+ *   1. 以已注册前缀开头的主动上报，交给对应处理函数；
+ *   2. 有命令在等待时，OK/ERROR/FAIL（或命令指定的前缀）结束该命令，
+ *      其余行作为中间响应交给调用者；
+ *   3. 其余行丢弃。
+ * 调用者在信号量上等待结束或超时，不再按固定时间盲等。
+ *
+ * 异步命令进入消息队列，由链路工作线程逐条调用 esp_at_exec() 执行并回调，
+ * 多个线程的上报、配置和诊断命令共用模块而互不阻塞；同步命令与工作线程
+ * 通过同一把互斥锁串行，串口上任何时刻只有一条命令在等待应答。
+ *
+ * 发送走 DMA 双缓冲：写入的数据拷进当前缓冲区，写满或命令写完时交给 DMA，
+ * 换另一块继续填充；DMA 完成回调用事件位归还缓冲区。流式生成的报文
+ * 边编码边按线速发出，写入线程只在两块都在发送时等待，不再逐字节轮询。
+ * 驱动不支持 DMA 发送时退回原来的直接写。
+ *
+ * 回环自检时，指定线程发出的命令（含它提交的异步命令）交给 sink 而不上串口，
+ * 应答经单独的拼行状态注入，与串口接收互不干扰。
+ */
+
+/* 接收线程单次从串口取出的字节数 */
+#define ESP_AT_RX_CHUNK         64
+
+/* 行拼接状态，串口接收和回环注入各用一份 */
+typedef struct
+{
+    char line[ESP_AT_LINE_MAX];
+    rt_size_t len;
+    rt_bool_t overflow;
+} esp_at_rx_t;
+
+/* 正在等待的命令，由调度器锁保护 */
+typedef struct
+{
+    rt_bool_t active;
+    const esp_at_rx_t *source;  /* 只有从这里拼出的行能结束该命令 */
+    rt_bool_t prompt;           /* 等待数据提示符 '>'，不以 OK 结束 */
+    const char *expect;
+    char *resp;
+    rt_size_t resp_size;
+    rt_size_t resp_len;
+    rt_err_t result;
+} esp_at_pending_t;
+
+/* 异步命令请求，命令字符串和原始数据在同一块堆内存上，执行完释放 */
+typedef struct
+{
+    char *cmd;
+    const char *data;           /* 提示符后发送的原始数据，RT_NULL 表示普通命令 */
+    rt_size_t data_len;
+    const char *expect;
+    rt_int32_t timeout_ms;
+    esp_at_callback_t callback;
+    void *arg;
+    rt_tick_t submitted;
+#ifdef RT_USING_FINSH
+    rt_thread_t issuer;         /* 提交命令的线程 */
+#endif
+} esp_at_req_t;
+
+typedef struct
+{
+    const char *prefix;
+    rt_size_t prefix_len;
+    esp_at_urc_handler_t handler;
+} esp_at_urc_t;
+
+static rt_device_t esp_at_uart = RT_NULL;
+static struct rt_semaphore esp_at_rx_sem;       // 接收通知
+static struct rt_semaphore esp_at_done;         // 命令结束通知
+static struct rt_mutex esp_at_lock;             // 命令串行化
+
+static esp_at_pending_t esp_at_pending;
+static esp_at_urc_t esp_at_urcs[ESP_AT_URC_MAX];
+static rt_uint8_t esp_at_urc_count = 0;
+
+static esp_at_rx_t esp_at_rx;
+
+static esp_at_stats_t esp_at_stats;
+
+/* DMA 发送双缓冲，事件位 i 表示缓冲区 i 空闲 */
+static rt_bool_t esp_at_tx_dma = RT_FALSE;
+static rt_uint8_t esp_at_tx_buf[2][ESP_AT_TX_BUFSZ];
+static rt_uint8_t esp_at_tx_index = 0;          // 正在填充的缓冲区
+static rt_size_t esp_at_tx_len = 0;
+static rt_uint8_t esp_at_tx_hold = 0;           // 命令写出期间不逐次提交，攒满或写完再发
+static struct rt_event esp_at_tx_event;
+static struct rt_mutex esp_at_tx_lock;
+
+/* 当前波特率和各波特率下的吞吐统计；发送忙时间从首块交给 DMA 到最后一块发完 */
+static rt_uint32_t esp_at_baud = ESP_AT_DEFAULT_BAUD;
+static esp_at_baud_stats_t esp_at_bauds[ESP_AT_BAUD_SLOTS];
+static esp_at_baud_stats_t *esp_at_baud_cur = &esp_at_bauds[0];
+static rt_tick_t esp_at_baud_since;
+static rt_uint8_t esp_at_tx_inflight = 0;
+static rt_tick_t esp_at_tx_busy_since;
+
+/* 异步命令队列与工作线程的响应缓冲区 */
+static rt_mq_t esp_at_queue = RT_NULL;
+static rt_thread_t esp_at_worker = RT_NULL;
+static char esp_at_worker_resp[ESP_AT_RESP_MAX];
+
+#ifdef RT_USING_FINSH
+/* 持有命令锁的命令由哪个线程发出（异步命令为提交者），无命令时为 RT_NULL */
+static rt_thread_t esp_at_issuer = RT_NULL;
+static rt_thread_t esp_at_worker_issuer = RT_NULL;  // 工作线程正在执行的命令由谁提交
+
+/* 回环自检：esp_at_loop_owner 发出的命令写给 sink，应答经 esp_at_loop_rx 拼行 */
+static esp_at_sink_t esp_at_loop_sink = RT_NULL;
+static void *esp_at_loop_ctx = RT_NULL;
+static rt_thread_t esp_at_loop_owner = RT_NULL;
+static esp_at_rx_t esp_at_loop_rx;
+#endif /* RT_USING_FINSH */
+
+/* 异步时延直方图，桶上限（毫秒），最后一桶收容更长的时延 */
+static const rt_uint32_t esp_at_hist_bounds[] =
+{
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000,
+};
+#define ESP_AT_HIST_BUCKETS     (sizeof(esp_at_hist_bounds) / sizeof(esp_at_hist_bounds[0]) + 1)
+static rt_uint32_t esp_at_hist[ESP_AT_HIST_BUCKETS];
+static rt_uint32_t esp_at_async_timeouts = 0;
+
+/* 串口接收通知回调：只唤醒接收线程 */
+static rt_err_t esp_at_rx_ind(rt_device_t dev, rt_size_t size)
+{
+    rt_sem_release(&esp_at_rx_sem);
+    return RT_EOK;
+}
+
+/* 结束正在等待的命令，rx 是应答行的来源 */
+static void esp_at_complete(const esp_at_rx_t *rx, rt_err_t result)
+{
+    rt_enter_critical();
+    if (esp_at_pending.active && esp_at_pending.source == rx)
+    {
+        esp_at_pending.active = RT_FALSE;
+        esp_at_pending.result = result;
+        rt_sem_release(&esp_at_done);
+    }
+    rt_exit_critical();
+}
+
+/* 中间响应追加到调用者缓冲区，调用者已超时返回时不再写入 */
+static void esp_at_append(const esp_at_rx_t *rx, const char *line, rt_size_t len)
+{
+    rt_enter_critical();
+    if (esp_at_pending.active && esp_at_pending.source == rx && esp_at_pending.resp != RT_NULL)
+    {
+        esp_at_pending_t *p = &esp_at_pending;
+
+        if (p->resp_len + len + 2 <= p->resp_size)
+        {
+            memcpy(&p->resp[p->resp_len], line, len);
+            p->resp_len += len;
+            p->resp[p->resp_len++] = '\n';
+            p->resp[p->resp_len] = '\0';
+        }
+    }
+    rt_exit_critical();
+}
+
+/* 处理从 rx 拼出的一个完整的行 */
+static void esp_at_handle_line(const esp_at_rx_t *rx, const char *line, rt_size_t len)
+{
+    const char *expect = esp_at_pending.expect;
+    rt_bool_t mine = esp_at_pending.active && esp_at_pending.source == rx;
+
+    esp_at_stats.lines++;
+
+    if (mine && !esp_at_pending.prompt && expect != RT_NULL && strncmp(line, expect, strlen(expect)) == 0)
+    {
+        // 命令等待的行先于同前缀的主动上报匹配（如 AT+RST 等待 ready）
+        esp_at_complete(rx, RT_EOK);
+        return;
+    }
+
+    for (rt_uint8_t i = 0; i < esp_at_urc_count; i++)
+    {
+        if (len >= esp_at_urcs[i].prefix_len &&
+            strncmp(line, esp_at_urcs[i].prefix, esp_at_urcs[i].prefix_len) == 0)
+        {
+#ifdef RT_USING_FINSH
+            if (rx == &esp_at_loop_rx)
+            {
+                // 注入的应答不是模块真的上报，不交给处理函数
+                return;
+            }
+#endif
+            esp_at_stats.urcs++;
+            esp_at_urcs[i].handler(line, len);
+            return;
+        }
+    }
+
+    if (!mine)
+    {
+        return;
+    }
+
+    if (strcmp(line, "ERROR") == 0 || strcmp(line, "FAIL") == 0 ||
+        (len > 5 && strcmp(&line[len - 5], ":FAIL") == 0))
+    {
+        // 含 +MQTTPUB:FAIL 这类带前缀的失败结果
+        esp_at_complete(rx, -RT_ERROR);
+    }
+    else if (esp_at_pending.prompt)
+    {
+        // 等待提示符期间的 OK 不结束命令
+    }
+    else if (expect == RT_NULL && strcmp(line, "OK") == 0)
+    {
+        esp_at_complete(rx, RT_EOK);
+    }
+    else if (strncmp(line, "AT", 2) != 0)
+    {
+        // 回显（ATE0 之前）不算响应
+        esp_at_append(rx, line, len);
+    }
+}
+
+/* 逐字节拼行，\r 忽略，\n 结束一行，空行丢弃 */
+static void esp_at_feed(esp_at_rx_t *rx, const rt_uint8_t *data, rt_size_t len)
+{
+    for (rt_size_t i = 0; i < len; i++)
+    {
+        char c = (char)data[i];
+
+        if (c == '\r')
+        {
+            continue;
+        }
+        if (c == '>' && rx->len == 0 && esp_at_pending.active && esp_at_pending.prompt)
+        {
+            // 数据提示符后没有换行，单独识别
+            esp_at_complete(rx, RT_EOK);
+            continue;
+        }
+        if (c == '\n')
+        {
+            if (rx->len > 0)
+            {
+                rx->line[rx->len] = '\0';
+                if (rx->overflow)
+                {
+                    esp_at_stats.overflows++;
+                }
+                esp_at_handle_line(rx, rx->line, rx->len);
+            }
+            rx->len = 0;
+            rx->overflow = RT_FALSE;
+            continue;
+        }
+        if (rx->len < ESP_AT_LINE_MAX - 1)
+        {
+            rx->line[rx->len++] = c;
+        }
+        else
+        {
+            rx->overflow = RT_TRUE;
+        }
+    }
+}
+
+/* 接收线程：被唤醒后取空串口缓冲区 */
+static void esp_at_rx_entry(void *parameter)
+{
+    rt_uint8_t chunk[ESP_AT_RX_CHUNK];
+    rt_ssize_t len;
+
+    while (1)
+    {
+        rt_sem_take(&esp_at_rx_sem, RT_WAITING_FOREVER);
+        while ((len = rt_device_read(esp_at_uart, 0, chunk, sizeof(chunk))) > 0)
+        {
+            esp_at_stats.rx_bytes += len;
+            esp_at_baud_cur->rx_bytes += len;
+            esp_at_feed(&esp_at_rx, chunk, len);
+        }
+    }
+}
+
+/* DMA 发送完成回调（中断上下文）：归还缓冲区，全部发完时累计发送忙时间 */
+static rt_err_t esp_at_tx_done(rt_device_t dev, void *buffer)
+{
+    if (esp_at_tx_inflight > 0 && --esp_at_tx_inflight == 0)
+    {
+        esp_at_baud_cur->tx_busy_ticks += rt_tick_get() - esp_at_tx_busy_since;
+    }
+    rt_event_send(&esp_at_tx_event, buffer == esp_at_tx_buf[0] ? 0x01 : 0x02);
+    return RT_EOK;
+}
+
+/* 取得缓冲区 index 用于填充，上一次交给 DMA 的数据还没发完时等待 */
+static void esp_at_tx_acquire(rt_uint8_t index)
+{
+    rt_uint32_t set;
+
+    if (rt_event_recv(&esp_at_tx_event, 1 << index, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                      0, &set) != RT_EOK)
+    {
+        esp_at_stats.tx_waits++;
+        if (rt_event_recv(&esp_at_tx_event, 1 << index, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                          rt_tick_from_millisecond(ESP_AT_TX_TIMEOUT_MS), &set) != RT_EOK)
+        {
+            // 完成通知丢失，继续使用该缓冲区
+            esp_at_stats.tx_timeouts++;
+        }
+    }
+    esp_at_tx_index = index;
+    esp_at_tx_len = 0;
+}
+
+/* 当前缓冲区交给 DMA，换另一块继续填充，调用者持有发送锁 */
+static void esp_at_tx_submit(void)
+{
+    rt_base_t level;
+
+    if (esp_at_tx_len == 0)
+    {
+        return;
+    }
+    level = rt_hw_interrupt_disable();
+    if (esp_at_tx_inflight++ == 0)
+    {
+        esp_at_tx_busy_since = rt_tick_get();
+    }
+    rt_hw_interrupt_enable(level);
+
+    rt_device_write(esp_at_uart, 0, esp_at_tx_buf[esp_at_tx_index], esp_at_tx_len);
+    esp_at_stats.tx_bytes += esp_at_tx_len;
+    esp_at_baud_cur->tx_bytes += esp_at_tx_len;
+    esp_at_stats.tx_chunks++;
+    esp_at_tx_acquire(esp_at_tx_index ^ 1);
+}
+
+/* 开始写一条命令，调用者持有命令锁 */
+static void esp_at_tx_begin(void)
+{
+    esp_at_tx_hold++;
+}
+
+/* 命令写完，发出缓冲区中剩余的数据 */
+static void esp_at_tx_end(void)
+{
+    rt_mutex_take(&esp_at_tx_lock, RT_WAITING_FOREVER);
+    esp_at_tx_hold--;
+    if (esp_at_tx_dma)
+    {
+        esp_at_tx_submit();
+    }
+    rt_mutex_release(&esp_at_tx_lock);
+}
+
+/**
+ * @brief   向模块写原始数据，命令之外的写入立即发出
+ */
+void esp_at_write(const void *data, rt_size_t len)
+{
+    const rt_uint8_t *p = data;
+
+    if (esp_at_uart == RT_NULL || data == RT_NULL)
+    {
+        return;
+    }
+#ifdef RT_USING_FINSH
+    if (esp_at_issuer != RT_NULL && esp_at_pending.source == &esp_at_loop_rx &&
+        (rt_thread_self() == esp_at_issuer || rt_thread_self() == esp_at_worker))
+    {
+        // 回环自检的命令不上串口
+        esp_at_loop_sink(data, len, esp_at_loop_ctx);
+        return;
+    }
+#endif
+    if (!esp_at_tx_dma)
+    {
+        // 轮询发送，调用返回时已写完
+        rt_tick_t start = rt_tick_get();
+        rt_size_t n = rt_device_write(esp_at_uart, 0, data, len);
+
+        esp_at_stats.tx_bytes += n;
+        esp_at_baud_cur->tx_bytes += n;
+        esp_at_baud_cur->tx_busy_ticks += rt_tick_get() - start;
+        return;
+    }
+
+    rt_mutex_take(&esp_at_tx_lock, RT_WAITING_FOREVER);
+    while (len > 0)
+    {
+        rt_size_t n = ESP_AT_TX_BUFSZ - esp_at_tx_len;
+
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(&esp_at_tx_buf[esp_at_tx_index][esp_at_tx_len], p, n);
+        esp_at_tx_len += n;
+        p += n;
+        len -= n;
+        if (esp_at_tx_len == ESP_AT_TX_BUFSZ)
+        {
+            esp_at_tx_submit();
+        }
+    }
+    if (esp_at_tx_hold == 0)
+    {
+        esp_at_tx_submit();
+    }
+    rt_mutex_release(&esp_at_tx_lock);
+}
+
+/* 选出 baud 的统计槽，槽用完时与最后一个合并 */
+static void esp_at_baud_select(rt_uint32_t baud)
+{
+    rt_tick_t now = rt_tick_get();
+    rt_uint8_t i;
+
+    esp_at_baud_cur->time_ticks += now - esp_at_baud_since;
+    esp_at_baud_since = now;
+    for (i = 0; i < ESP_AT_BAUD_SLOTS - 1; i++)
+    {
+        if (esp_at_bauds[i].baud == baud || esp_at_bauds[i].baud == 0)
+        {
+            break;
+        }
+    }
+    esp_at_bauds[i].baud = baud;
+    esp_at_baud_cur = &esp_at_bauds[i];
+}
+
+/**
+ * @brief   等已交出的数据发完后修改 uart1 波特率（模块侧由调用者用 AT+UART_CUR 切换）
+ */
+rt_err_t esp_at_set_baud(rt_uint32_t baud)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    rt_uint32_t set;
+    rt_err_t ret;
+
+    if (esp_at_uart == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&esp_at_tx_lock, RT_WAITING_FOREVER);
+    if (esp_at_tx_dma)
+    {
+        // 交出当前缓冲区，再等另一块发完（不清事件位）
+        esp_at_tx_submit();
+        rt_event_recv(&esp_at_tx_event, 1 << (esp_at_tx_index ^ 1), RT_EVENT_FLAG_OR,
+                      rt_tick_from_millisecond(ESP_AT_TX_TIMEOUT_MS), &set);
+    }
+    // 移位寄存器和 FIFO 中最后几个字节
+    rt_thread_mdelay(ESP_AT_BAUD_SETTLE_MS);
+
+    // 串口已打开时接收缓冲区大小不能改变，只改波特率
+    config.baud_rate = baud;
+    config.bufsz = ESP_AT_RX_BUFSZ;
+    ret = rt_device_control(esp_at_uart, RT_DEVICE_CTRL_CONFIG, &config);
+    if (ret == RT_EOK)
+    {
+        esp_at_baud = baud;
+        esp_at_baud_select(baud);
+    }
+    rt_mutex_release(&esp_at_tx_lock);
+
+    return ret;
+}
+
+/**
+ * @brief   uart1 当前波特率
+ */
+rt_uint32_t esp_at_get_baud(void)
+{
+    return esp_at_baud;
+}
+
+/**
+ * @brief   独占 AT 链路，可嵌套
+ */
+void esp_at_acquire(void)
+{
+    rt_mutex_take(&esp_at_lock, RT_WAITING_FOREVER);
+}
+
+/**
+ * @brief   释放 esp_at_acquire() 独占的 AT 链路
+ */
+void esp_at_release(void)
+{
+    rt_mutex_release(&esp_at_lock);
+}
+
+/* 整条命令一次写出 */
+static void esp_at_write_cmd(void *arg)
+{
+    const char *cmd = arg;
+
+    esp_at_write(cmd, strlen(cmd));
+}
+
+/* 命令开始时记下发出者（异步命令为提交者），结束时清除，调用者持有命令锁 */
+static void esp_at_claim(rt_bool_t begin)
+{
+#ifdef RT_USING_FINSH
+    if (!begin)
+    {
+        esp_at_issuer = RT_NULL;
+    }
+    else
+    {
+        esp_at_issuer = rt_thread_self() == esp_at_worker ? esp_at_worker_issuer : rt_thread_self();
+    }
+#endif
+}
+
+/* 登记等待中的命令，调用者持有命令锁 */
+static void esp_at_arm(const char *expect, char *resp, rt_size_t resp_size, rt_bool_t prompt)
+{
+    // 清掉上一条超时命令迟到的结束通知
+    rt_sem_control(&esp_at_done, RT_IPC_CMD_RESET, RT_NULL);
+    if (resp != RT_NULL && resp_size > 0)
+    {
+        resp[0] = '\0';
+    }
+
+    rt_enter_critical();
+#ifdef RT_USING_FINSH
+    // 回环自检的命令只接受注入的应答，模块的输出也不会结束它
+    esp_at_pending.source = esp_at_loop_sink != RT_NULL && esp_at_issuer == esp_at_loop_owner ?
+                            &esp_at_loop_rx : &esp_at_rx;
+#else
+    esp_at_pending.source = &esp_at_rx;
+#endif
+    esp_at_pending.prompt = prompt;
+    esp_at_pending.expect = expect;
+    esp_at_pending.resp = resp;
+    esp_at_pending.resp_size = resp_size;
+    esp_at_pending.resp_len = 0;
+    esp_at_pending.result = -RT_ETIMEOUT;
+    esp_at_pending.active = RT_TRUE;
+    rt_exit_critical();
+}
+
+/* 等待命令结束或超时 */
+static rt_err_t esp_at_wait(rt_int32_t timeout_ms)
+{
+    rt_err_t result;
+
+    rt_sem_take(&esp_at_done, rt_tick_from_millisecond(timeout_ms));
+
+    // 超时与结束可能同时发生，以接收线程是否已经结束该命令为准
+    rt_enter_critical();
+    esp_at_pending.active = RT_FALSE;
+    esp_at_pending.resp = RT_NULL;
+    result = esp_at_pending.result;
+    rt_exit_critical();
+
+    return result;
+}
+
+/* 统计一条命令的结果，调用者持有命令锁 */
+static rt_uint32_t esp_at_account(rt_err_t result, rt_tick_t start)
+{
+    rt_uint32_t elapsed = (rt_tick_get() - start) * 1000 / RT_TICK_PER_SECOND;
+
+    esp_at_baud_cur->cmds++;
+    if (result != RT_EOK)
+    {
+        esp_at_baud_cur->failed++;
+    }
+
+    esp_at_stats.total_latency_ms += elapsed;
+    if (elapsed > esp_at_stats.max_latency_ms)
+    {
+        esp_at_stats.max_latency_ms = elapsed;
+    }
+
+    if (result == -RT_ETIMEOUT)
+    {
+        esp_at_stats.timeouts++;
+    }
+    else if (result != RT_EOK)
+    {
+        esp_at_stats.errors++;
+    }
+    return elapsed;
+}
+
+/* 失败时只打印命令名，参数里可能有密码 */
+static void esp_at_report_failure(const char *name, rt_err_t result, rt_uint32_t elapsed)
+{
+    if (result != RT_EOK)
+    {
+        rt_kprintf("[ESP_AT] %.*s %s after %d ms\n", (int)strcspn(name, "="), name,
+                   result == -RT_ETIMEOUT ? "timeout" : "error", elapsed);
+    }
+}
+
+/**
+ * @brief   由 writer 分块写出命令本体，追加 \r\n 并等待结束
+ */
+rt_err_t esp_at_exec_stream(esp_at_writer_t writer, void *arg, const char *name, const char *expect,
+                            char *resp, rt_size_t resp_size, rt_int32_t timeout_ms)
+{
+    rt_tick_t start;
+    rt_uint32_t elapsed;
+    rt_err_t result;
+
+    if (esp_at_uart == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&esp_at_lock, RT_WAITING_FOREVER);
+
+    esp_at_claim(RT_TRUE);
+    esp_at_arm(expect, resp, resp_size, RT_FALSE);
+    start = rt_tick_get();
+    esp_at_stats.cmds++;
+    esp_at_tx_begin();
+    writer(arg);
+    esp_at_write("\r\n", 2);
+    esp_at_tx_end();
+    result = esp_at_wait(timeout_ms);
+    elapsed = esp_at_account(result, start);
+    esp_at_claim(RT_FALSE);
+
+    rt_mutex_release(&esp_at_lock);
+
+    esp_at_report_failure(name, result, elapsed);
+    return result;
+}
+
+/**
+ * @brief   发送带数据的命令：等到提示符 '>' 后由 writer 写出原始数据，再等待结束
+ */
+rt_err_t esp_at_exec_raw(const char *cmd, esp_at_writer_t writer, void *arg, const char *expect,
+                         rt_int32_t timeout_ms)
+{
+    rt_tick_t start;
+    rt_uint32_t elapsed;
+    rt_err_t result;
+
+    if (esp_at_uart == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&esp_at_lock, RT_WAITING_FOREVER);
+
+    esp_at_claim(RT_TRUE);
+    esp_at_arm(RT_NULL, RT_NULL, 0, RT_TRUE);
+    start = rt_tick_get();
+    esp_at_stats.cmds++;
+    esp_at_tx_begin();
+    esp_at_write(cmd, strlen(cmd));
+    esp_at_write("\r\n", 2);
+    esp_at_tx_end();
+    result = esp_at_wait(timeout_ms);
+
+    if (result == RT_EOK)
+    {
+        // 提示符之后模块按命令中的长度收数据，数据不含行尾
+        esp_at_arm(expect, RT_NULL, 0, RT_FALSE);
+        esp_at_tx_begin();
+        writer(arg);
+        esp_at_tx_end();
+        result = esp_at_wait(timeout_ms);
+    }
+    else if (result == -RT_ETIMEOUT)
+    {
+        esp_at_stats.prompt_timeouts++;
+    }
+    elapsed = esp_at_account(result, start);
+    esp_at_claim(RT_FALSE);
+
+    rt_mutex_release(&esp_at_lock);
+
+    esp_at_report_failure(cmd, result, elapsed);
+    return result;
+}
+
+/**
+ * @brief   发送一条 AT 命令并等待结束
+ */
+rt_err_t esp_at_exec(const char *cmd, const char *expect, char *resp, rt_size_t resp_size,
+                     rt_int32_t timeout_ms)
+{
+    return esp_at_exec_stream(esp_at_write_cmd, (void *)cmd, cmd, expect, resp, resp_size, timeout_ms);
+}
+
+/* 记录一条异步命令的时延 */
+static void esp_at_hist_add(rt_uint32_t ms)
+{
+    rt_uint8_t i = 0;
+
+    while (i < ESP_AT_HIST_BUCKETS - 1 && ms > esp_at_hist_bounds[i])
+    {
+        i++;
+    }
+    esp_at_hist[i]++;
+}
+
+/**
+ * @brief   异步命令时延百分位
+ */
+rt_uint32_t esp_at_latency_percentile(rt_uint8_t percent)
+{
+    rt_uint32_t total = 0, target, sum = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < ESP_AT_HIST_BUCKETS; i++)
+    {
+        total += esp_at_hist[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    target = (total * percent + 99) / 100;
+    for (i = 0; i < ESP_AT_HIST_BUCKETS - 1; i++)
+    {
+        sum += esp_at_hist[i];
+        if (sum >= target)
+        {
+            return esp_at_hist_bounds[i];
+        }
+    }
+    // 落在最后一桶，只能给出下限
+    return esp_at_hist_bounds[ESP_AT_HIST_BUCKETS - 2];
+}
+
+/* 写出异步请求携带的原始数据 */
+static void esp_at_write_data(void *arg)
+{
+    const esp_at_req_t *req = arg;
+
+    esp_at_write(req->data, req->data_len);
+}
+
+/* 链路工作线程：逐条执行异步命令并回调 */
+static void esp_at_worker_entry(void *parameter)
+{
+    esp_at_req_t req;
+    rt_err_t result;
+    rt_uint32_t elapsed;
+
+    while (1)
+    {
+        if (rt_mq_recv(esp_at_queue, &req, sizeof(req), RT_WAITING_FOREVER) <= 0)
+        {
+            continue;
+        }
+
+        rt_enter_critical();
+        esp_at_stats.queue_depth--;
+        rt_exit_critical();
+
+#ifdef RT_USING_FINSH
+        esp_at_worker_issuer = req.issuer;
+#endif
+        if (req.data != RT_NULL)
+        {
+            esp_at_worker_resp[0] = '\0';
+            result = esp_at_exec_raw(req.cmd, esp_at_write_data, &req, req.expect, req.timeout_ms);
+        }
+        else
+        {
+            result = esp_at_exec(req.cmd, req.expect, esp_at_worker_resp, sizeof(esp_at_worker_resp),
+                                 req.timeout_ms);
+        }
+#ifdef RT_USING_FINSH
+        esp_at_worker_issuer = RT_NULL;
+#endif
+
+        elapsed = (rt_tick_get() - req.submitted) * 1000 / RT_TICK_PER_SECOND;
+        esp_at_hist_add(elapsed);
+        if (result == -RT_ETIMEOUT)
+        {
+            esp_at_async_timeouts++;
+        }
+
+        if (req.callback != RT_NULL)
+        {
+            req.callback(result, esp_at_worker_resp, req.arg);
+        }
+        rt_free(req.cmd);
+    }
+}
+
+/* 进入异步队列：cmd 所在的堆内存（data 在同一块上）交给工作线程执行完释放，入队失败时立即释放 */
+static rt_err_t esp_at_enqueue(char *cmd, const char *data, rt_size_t data_len, const char *expect,
+                               rt_int32_t timeout_ms, esp_at_callback_t callback, void *arg)
+{
+    esp_at_req_t req;
+
+    if (esp_at_queue == RT_NULL)
+    {
+        rt_free(cmd);
+        return -RT_ERROR;
+    }
+
+    req.cmd = cmd;
+    req.data = data;
+    req.data_len = data_len;
+    req.expect = expect;
+    req.timeout_ms = timeout_ms;
+    req.callback = callback;
+    req.arg = arg;
+    req.submitted = rt_tick_get();
+#ifdef RT_USING_FINSH
+    req.issuer = rt_thread_self();
+#endif
+
+    // 先计入深度再入队，工作线程取出时不会减成负数
+    rt_enter_critical();
+    esp_at_stats.queue_depth++;
+    if (esp_at_stats.queue_depth > esp_at_stats.queue_max)
+    {
+        esp_at_stats.queue_max = esp_at_stats.queue_depth;
+    }
+    rt_exit_critical();
+
+    if (rt_mq_send(esp_at_queue, &req, sizeof(req)) != RT_EOK)
+    {
+        rt_enter_critical();
+        esp_at_stats.queue_depth--;
+        esp_at_stats.dropped++;
+        rt_exit_critical();
+        rt_free(cmd);
+        return -RT_EFULL;
+    }
+    esp_at_stats.queued++;
+
+    return RT_EOK;
+}
+
+/**
+ * @brief   提交一条异步 AT 命令
+ */
+rt_err_t esp_at_submit(const char *cmd, const char *expect, rt_int32_t timeout_ms,
+                       esp_at_callback_t callback, void *arg)
+{
+    rt_size_t len = strlen(cmd);
+    char *copy;
+
+    if (esp_at_queue == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    copy = rt_malloc(len + 1);
+    if (copy == RT_NULL)
+    {
+        esp_at_stats.dropped++;
+        return -RT_ENOMEM;
+    }
+    memcpy(copy, cmd, len + 1);
+    return esp_at_enqueue(copy, RT_NULL, 0, expect, timeout_ms, callback, arg);
+}
+
+/**
+ * @brief   提交一条异步命令，命令和数据所在的堆内存交给队列
+ */
+rt_err_t esp_at_submit_owned(char *cmd, const char *data, rt_size_t len, const char *expect,
+                             rt_int32_t timeout_ms, esp_at_callback_t callback, void *arg)
+{
+    return esp_at_enqueue(cmd, data, len, expect, timeout_ms, callback, arg);
+}
+
+/**
+ * @brief   注册主动上报处理函数
+ */
+rt_err_t esp_at_urc_register(const char *prefix, esp_at_urc_handler_t handler)
+{
+    rt_err_t ret = -RT_EFULL;
+
+    rt_enter_critical();
+    if (esp_at_urc_count < ESP_AT_URC_MAX)
+    {
+        esp_at_urcs[esp_at_urc_count].prefix = prefix;
+        esp_at_urcs[esp_at_urc_count].prefix_len = strlen(prefix);
+        esp_at_urcs[esp_at_urc_count].handler = handler;
+        esp_at_urc_count++;
+        ret = RT_EOK;
+    }
+    rt_exit_critical();
+
+    return ret;
+}
+
+/**
+ * @brief   读取命令统计
+ */
+void esp_at_get_stats(esp_at_stats_t *stats)
+{
+    *stats = esp_at_stats;
+}
+
+/**
+ * @brief   打开串口并启动接收线程
+ */
+rt_err_t esp_at_init(const char *uart_name)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+    rt_thread_t thread;
+
+    esp_at_uart = rt_device_find(uart_name);
+    if (esp_at_uart == RT_NULL)
+    {
+        rt_kprintf("[ESP_AT] %s not found!\n", uart_name);
+        return -RT_ERROR;
+    }
+
+    // 默认 64 字节的接收缓冲区装不下一条完整响应，打开前加大
+    config.baud_rate = ESP_AT_DEFAULT_BAUD;
+    config.bufsz = ESP_AT_RX_BUFSZ;
+    esp_at_bauds[0].baud = ESP_AT_DEFAULT_BAUD;
+    esp_at_baud_since = rt_tick_get();
+    rt_device_control(esp_at_uart, RT_DEVICE_CTRL_CONFIG, &config);
+
+    rt_sem_init(&esp_at_rx_sem, "esp_rx", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&esp_at_done, "esp_at", 0, RT_IPC_FLAG_FIFO);
+    rt_mutex_init(&esp_at_lock, "esp_at", RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&esp_at_tx_lock, "esp_tx", RT_IPC_FLAG_PRIO);
+    rt_event_init(&esp_at_tx_event, "esp_tx", RT_IPC_FLAG_FIFO);
+
+#ifdef RT_SERIAL_USING_DMA
+    // 优先用 DMA 发送，驱动未注册 DMA 发送时打开失败，退回直接写
+    if (rt_device_open(esp_at_uart, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX |
+                       RT_DEVICE_FLAG_DMA_TX) == RT_EOK)
+    {
+        esp_at_tx_dma = RT_TRUE;
+        rt_device_set_tx_complete(esp_at_uart, esp_at_tx_done);
+        rt_event_send(&esp_at_tx_event, 0x03);
+        esp_at_tx_acquire(0);
+    }
+    else
+#endif
+    if (rt_device_open(esp_at_uart, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX) != RT_EOK)
+    {
+        rt_kprintf("[ESP_AT] %s open failed!\n", uart_name);
+        esp_at_uart = RT_NULL;
+        return -RT_ERROR;
+    }
+    rt_device_set_rx_indicate(esp_at_uart, esp_at_rx_ind);
+    rt_kprintf("[ESP_AT] %s tx: %s\n", uart_name, esp_at_tx_dma ? "DMA double buffer" : "direct");
+
+    // 接收线程优先级高于 ESP 应用线程，命令结束后立即唤醒调用者
+    thread = rt_thread_create("esp_rx", esp_at_rx_entry, RT_NULL, 1024, 18, 10);
+    if (thread == RT_NULL)
+    {
+        rt_kprintf("[ESP_AT] rx thread create failed!\n");
+        return -RT_ERROR;
+    }
+    rt_thread_startup(thread);
+
+    // 异步命令队列与链路工作线程
+    esp_at_queue = rt_mq_create("esp_at", sizeof(esp_at_req_t), ESP_AT_QUEUE_LEN, RT_IPC_FLAG_FIFO);
+    if (esp_at_queue == RT_NULL)
+    {
+        rt_kprintf("[ESP_AT] queue create failed!\n");
+        return -RT_ERROR;
+    }
+    esp_at_worker = rt_thread_create("esp_at", esp_at_worker_entry, RT_NULL, 1024, 19, 10);
+    if (esp_at_worker == RT_NULL)
+    {
+        rt_kprintf("[ESP_AT] worker thread create failed!\n");
+        return -RT_ERROR;
+    }
+    rt_thread_startup(esp_at_worker);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief   打印 AT 命令统计
+ */
+static int esp_at_stat(int argc, char *argv[])
+{
+    rt_kprintf("[ESP_AT] cmds: %d, errors: %d, timeouts: %d, urcs: %d\n",
+               esp_at_stats.cmds, esp_at_stats.errors, esp_at_stats.timeouts, esp_at_stats.urcs);
+    rt_kprintf("[ESP_AT] lines: %d, overflows: %d, rx bytes: %d, tx bytes: %d, prompt timeouts: %d\n",
+               esp_at_stats.lines, esp_at_stats.overflows, esp_at_stats.rx_bytes,
+               esp_at_stats.tx_bytes, esp_at_stats.prompt_timeouts);
+    rt_kprintf("[ESP_AT] tx: %s, chunks: %d, buffer waits: %d, dma timeouts: %d\n",
+               esp_at_tx_dma ? "dma" : "direct", esp_at_stats.tx_chunks, esp_at_stats.tx_waits,
+               esp_at_stats.tx_timeouts);
+    for (rt_uint8_t i = 0; i < ESP_AT_BAUD_SLOTS && esp_at_bauds[i].baud != 0; i++)
+    {
+        const esp_at_baud_stats_t *b = &esp_at_bauds[i];
+        rt_tick_t time = b->time_ticks + (b == esp_at_baud_cur ? rt_tick_get() - esp_at_baud_since : 0);
+        rt_uint32_t busy_ms = b->tx_busy_ticks * 1000 / RT_TICK_PER_SECOND;
+        rt_uint32_t rate = busy_ms ? (rt_uint32_t)((rt_uint64_t)b->tx_bytes * 1000 / busy_ms) : 0;
+
+        // 每字节 10 位（8N1），rate 与线速之比即发送效率
+        rt_kprintf("[ESP_AT] %7d baud%s: %d s, cmds: %d, failed: %d, rx: %d B, tx: %d B in %d ms "
+                   "(%d B/s, %d%% of line rate)\n",
+                   b->baud, b == esp_at_baud_cur ? "*" : " ", time / RT_TICK_PER_SECOND, b->cmds,
+                   b->failed, b->rx_bytes, b->tx_bytes, busy_ms, rate, rate * 10 * 100 / b->baud);
+    }
+    rt_kprintf("[ESP_AT] latency avg: %d ms, max: %d ms\n",
+               esp_at_stats.cmds ? esp_at_stats.total_latency_ms / esp_at_stats.cmds : 0,
+               esp_at_stats.max_latency_ms);
+    rt_kprintf("[ESP_AT] queue depth: %d, max: %d, limit: %d, queued: %d, dropped: %d\n",
+               esp_at_stats.queue_depth, esp_at_stats.queue_max, ESP_AT_QUEUE_LEN,
+               esp_at_stats.queued, esp_at_stats.dropped);
+    rt_kprintf("[ESP_AT] async latency p50: <=%d ms, p90: <=%d ms, p99: <=%d ms, timeouts: %d\n",
+               esp_at_latency_percentile(50), esp_at_latency_percentile(90),
+               esp_at_latency_percentile(99), esp_at_async_timeouts);
+    return 0;
+}
+MSH_CMD_EXPORT(esp_at_stat, show ESP AT command statistics);
+
+#ifdef RT_USING_FINSH
+/* 诊断命令完成后打印应答 */
+static void esp_at_diag_done(rt_err_t result, const char *resp, void *arg)
+{
+    rt_kprintf("[ESP_AT] %s\n%s", result == RT_EOK ? "OK" :
+               (result == -RT_ETIMEOUT ? "timeout" : "ERROR"), resp);
+}
+
+/**
+ * @brief   经异步队列发送一条诊断命令：esp_at AT+CWJAP?
+ */
+static int esp_at(int argc, char *argv[])
+{
+    char cmd[128];
+    rt_size_t len = 0;
+
+    if (argc < 2)
+    {
+        rt_kprintf("Usage: esp_at <AT command>\n");
+        return -1;
+    }
+
+    // 命令行按空格拆开了参数，这里拼回去
+    cmd[0] = '\0';
+    for (int i = 1; i < argc && len < sizeof(cmd) - 1; i++)
+    {
+        len += rt_snprintf(&cmd[len], sizeof(cmd) - len, i > 1 ? " %s" : "%s", argv[i]);
+    }
+
+    if (esp_at_submit(cmd, RT_NULL, 5000, esp_at_diag_done, RT_NULL) != RT_EOK)
+    {
+        rt_kprintf("[ESP_AT] queue full\n");
+        return -1;
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(esp_at, send an AT command to the ESP01S through the async queue);
+
+/**
+ * @brief   开始或结束回环自检
+ */
+rt_err_t esp_at_loopback(esp_at_sink_t sink, void *ctx)
+{
+    if (esp_at_uart == RT_NULL || esp_at_worker == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    // 命令锁下切换，不会截断正在写出的命令
+    rt_mutex_take(&esp_at_lock, RT_WAITING_FOREVER);
+    esp_at_loop_rx.len = 0;
+    esp_at_loop_rx.overflow = RT_FALSE;
+    esp_at_loop_ctx = ctx;
+    esp_at_loop_owner = sink != RT_NULL ? rt_thread_self() : RT_NULL;
+    esp_at_loop_sink = sink;
+    rt_mutex_release(&esp_at_lock);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief   回环自检时注入模块应答
+ */
+void esp_at_loopback_input(const char *data, rt_size_t len)
+{
+    esp_at_feed(&esp_at_loop_rx, (const rt_uint8_t *)data, len);
+}
+#endif /* RT_USING_FINSH */
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         ESP01S AT 命令引擎：按行解析响应与主动上报
+ */
+
+#ifndef ESP_AT_H
+#define ESP_AT_H
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+/* 单行响应最大长度，超长部分丢弃；下行命令（+MQTTSUBRECV）整条在一行内 */
+#define ESP_AT_LINE_MAX         512
+/* 串口接收缓冲区大小 */
+#define ESP_AT_RX_BUFSZ         512
+/* uart1 默认波特率（模块上电和复位后的波特率） */
+#define ESP_AT_DEFAULT_BAUD     BAUD_RATE_115200
+/* 改波特率前等待最后几个字节移出发送器的时间（毫秒） */
+#define ESP_AT_BAUD_SETTLE_MS   2
+/* 分波特率统计的槽数 */
+#define ESP_AT_BAUD_SLOTS       4
+/* DMA 发送缓冲区大小（两块轮流使用），115200 波特率下约 22ms 发完一块 */
+#define ESP_AT_TX_BUFSZ         256
+/* 等待 DMA 归还发送缓冲区的超时（毫秒） */
+#define ESP_AT_TX_TIMEOUT_MS    200
+/* 可注册的主动上报处理函数个数 */
+#define ESP_AT_URC_MAX          8
+/* 异步命令队列长度 */
+#define ESP_AT_QUEUE_LEN        16
+/* 异步命令中间响应缓冲区大小 */
+#define ESP_AT_RESP_MAX         256
+
+/*
+ * 主动上报（URC）处理函数，在接收线程中调用，不能阻塞，也不能再发 AT 命令
+ * line 不含行尾 \r\n，以 '\0' 结尾
+ */
+typedef void (*esp_at_urc_handler_t)(const char *line, rt_size_t len);
+
+/*
+ * 异步命令完成回调，在链路工作线程中调用，应尽快返回
+ * result 同 esp_at_exec() 的返回值，resp 为中间响应行
+ */
+typedef void (*esp_at_callback_t)(rt_err_t result, const char *resp, void *arg);
+
+/*
+ * 流式命令的写出函数，持有命令通道时调用，用 esp_at_write() 分块写出命令本体（不含行尾）
+ */
+typedef void (*esp_at_writer_t)(void *arg);
+
+/* 命令统计 */
+typedef struct
+{
+    rt_uint32_t cmds;           /* 发出的命令数 */
+    rt_uint32_t errors;         /* 以 ERROR/FAIL 结束的命令数 */
+    rt_uint32_t timeouts;       /* 超时的命令数 */
+    rt_uint32_t urcs;           /* 分发的主动上报数 */
+    rt_uint32_t lines;          /* 收到的响应行数 */
+    rt_uint32_t overflows;      /* 超长被截断的行数 */
+    rt_uint32_t rx_bytes;       /* 接收字节数 */
+    rt_uint32_t tx_bytes;       /* 发送字节数 */
+    rt_uint32_t max_latency_ms; /* 命令最长响应时间 */
+    rt_uint32_t total_latency_ms;
+    rt_uint32_t queued;         /* 进入异步队列的命令数 */
+    rt_uint32_t dropped;        /* 队列满或内存不足被拒绝的命令数 */
+    rt_uint32_t queue_depth;    /* 当前排队的命令数 */
+    rt_uint32_t queue_max;      /* 排队数峰值 */
+    rt_uint32_t prompt_timeouts;/* 带数据命令等不到提示符 '>' 的次数 */
+    rt_uint32_t tx_chunks;      /* 交给 DMA 的发送块数 */
+    rt_uint32_t tx_waits;       /* 两块缓冲区都在发送、写入方等待的次数 */
+    rt_uint32_t tx_timeouts;    /* 等不到 DMA 完成通知的次数 */
+} esp_at_stats_t;
+
+/* 某一波特率下的吞吐统计 */
+typedef struct
+{
+    rt_uint32_t baud;
+    rt_uint32_t cmds;           /* 执行的命令数 */
+    rt_uint32_t failed;         /* 出错或超时的命令数 */
+    rt_uint32_t rx_bytes;
+    rt_uint32_t tx_bytes;
+    rt_tick_t tx_busy_ticks;    /* 串口发送忙的时间 */
+    rt_tick_t time_ticks;       /* 在该波特率下的累计时间（不含当前这段） */
+} esp_at_baud_stats_t;
+
+/**
+ * @brief   打开串口并启动接收线程
+ * @param   uart_name 串口设备名
+ * @return  RT_EOK 成功
+ */
+rt_err_t esp_at_init(const char *uart_name);
+
+/**
+ * @brief   发送一条 AT 命令并等待结束（自动追加 \r\n，多线程调用时串行执行）
+ * @param   cmd         命令，不含行尾
+ * @param   expect      以该前缀开头的行表示成功；RT_NULL 表示以 OK 结束
+ * @param   resp        中间响应行（以 '\n' 分隔），可为 RT_NULL
+ * @param   resp_size   resp 缓冲区大小
+ * @param   timeout_ms  超时时间
+ * @return  RT_EOK 成功，-RT_ERROR 模块返回 ERROR/FAIL，-RT_ETIMEOUT 超时
+ */
+rt_err_t esp_at_exec(const char *cmd, const char *expect, char *resp, rt_size_t resp_size,
+                     rt_int32_t timeout_ms);
+
+/**
+ * @brief   同 esp_at_exec()，命令本体由 writer 边生成边写出，不需要完整的命令缓冲区
+ * @param   writer      写出函数
+ * @param   arg         写出函数参数
+ * @param   name        命令名，失败时打印，如 "AT+MQTTPUB"
+ */
+rt_err_t esp_at_exec_stream(esp_at_writer_t writer, void *arg, const char *name, const char *expect,
+                            char *resp, rt_size_t resp_size, rt_int32_t timeout_ms);
+
+/**
+ * @brief   发送带数据的命令（如 AT+MQTTPUBRAW）：先等模块的提示符 '>'，
+ *          再由 writer 写出原始数据（长度须与命令中一致，不转义、不加行尾），最后等待结果
+ * @param   cmd         命令，不含行尾
+ * @param   writer      写出原始数据的函数
+ * @param   arg         写出函数参数
+ * @param   expect      数据发送后表示成功的前缀，如 "+MQTTPUB:OK"
+ * @param   timeout_ms  等提示符和等结果各自的超时
+ * @return  同 esp_at_exec()，以 :FAIL 结尾的结果行返回 -RT_ERROR
+ */
+rt_err_t esp_at_exec_raw(const char *cmd, esp_at_writer_t writer, void *arg, const char *expect,
+                         rt_int32_t timeout_ms);
+
+/**
+ * @brief   发送一条以 OK 结束的 AT 命令
+ */
+rt_inline rt_err_t esp_at_cmd(const char *cmd, rt_int32_t timeout_ms)
+{
+    return esp_at_exec(cmd, RT_NULL, RT_NULL, 0, timeout_ms);
+}
+
+/**
+ * @brief   提交一条异步 AT 命令，立即返回；链路工作线程按提交顺序逐条执行
+ * @param   cmd         命令，不含行尾，内部复制
+ * @param   expect      同 esp_at_exec()，必须是静态字符串
+ * @param   timeout_ms  执行超时，不含排队时间
+ * @param   callback    完成回调，可为 RT_NULL
+ * @param   arg         回调参数
+ * @return  RT_EOK 已入队，-RT_EFULL 队列满，-RT_ENOMEM 内存不足
+ */
+rt_err_t esp_at_submit(const char *cmd, const char *expect, rt_int32_t timeout_ms,
+                       esp_at_callback_t callback, void *arg);
+
+/**
+ * @brief   同 esp_at_submit()，但不复制：cmd 所在的 rt_malloc() 内存直接交给队列，
+ *          执行完或入队失败时由队列释放，调用者之后不能再访问
+ * @param   cmd     命令，以 '\0' 结束
+ * @param   data    RT_NULL 为普通命令；否则指向同一块内存中命令之后的原始数据，
+ *                  命令按 esp_at_exec_raw() 执行，提示符后发送
+ * @param   len     data 的字节数
+ */
+rt_err_t esp_at_submit_owned(char *cmd, const char *data, rt_size_t len, const char *expect,
+                             rt_int32_t timeout_ms, esp_at_callback_t callback, void *arg);
+
+/**
+ * @brief   异步命令从提交到完成的时延百分位（毫秒，按直方图桶上限估计）
+ * @param   percent 百分位，如 50、90、99
+ */
+rt_uint32_t esp_at_latency_percentile(rt_uint8_t percent);
+
+/**
+ * @brief   注册主动上报处理函数，以 prefix 开头的行交给 handler
+ * @return  RT_EOK 成功，-RT_EFULL 表已满
+ */
+rt_err_t esp_at_urc_register(const char *prefix, esp_at_urc_handler_t handler);
+
+/**
+ * @brief   等已交出的数据发完后修改 uart1 波特率，模块侧由调用者先用 AT+UART_CUR 切换
+ * @return  RT_EOK 成功，其他值为串口驱动返回的错误
+ */
+rt_err_t esp_at_set_baud(rt_uint32_t baud);
+
+/**
+ * @brief   uart1 当前波特率
+ */
+rt_uint32_t esp_at_get_baud(void);
+
+/**
+ * @brief   独占 AT 链路：调用线程随后的多条命令之间，其他线程（含异步队列的工作线程）
+ *          的命令都在等待，用于切换波特率这类不能被打断的命令序列。可嵌套，须与
+ *          esp_at_release() 成对调用
+ */
+void esp_at_acquire(void);
+
+/**
+ * @brief   释放 esp_at_acquire() 独占的 AT 链路
+ */
+void esp_at_release(void);
+
+/**
+ * @brief   直接向模块写原始数据，不等待响应
+ */
+void esp_at_write(const void *data, rt_size_t len);
+
+/**
+ * @brief   读取命令统计
+ */
+void esp_at_get_stats(esp_at_stats_t *stats);
+
+#ifdef RT_USING_FINSH
+/*
+ * 回环自检时代替串口接收命令字节的函数，在发出命令的线程（异步命令为链路工作线程）中调用，
+ * 模块应答用 esp_at_loopback_input() 注入
+ */
+typedef void (*esp_at_sink_t)(const char *data, rt_size_t len, void *ctx);
+
+/**
+ * @brief   回环自检：调用线程此后发出的命令（含它提交的异步命令）写给 sink 而不是模块，
+ *          应答只从 esp_at_loopback_input() 接受；其他线程的命令照常经串口收发
+ * @param   sink    接收命令字节的函数，RT_NULL 结束回环
+ * @param   ctx     sink 的参数
+ * @return  RT_EOK 成功，-RT_ERROR 引擎未启动
+ */
+rt_err_t esp_at_loopback(esp_at_sink_t sink, void *ctx);
+
+/**
+ * @brief   回环自检时注入模块应答，按串口接收的数据同样拼行处理（含提示符 '>'）
+ */
+void esp_at_loopback_input(const char *data, rt_size_t len);
+#endif /* RT_USING_FINSH */
+
+#endif /* ESP_AT_H */
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         发布路径自检：ESP-AT 模块替身与 esp_pub_selftest 命令
+ */
+
+#include "esp_app.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef RT_USING_FINSH
+/*
+ * esp_pub_selftest 用 esp_at_loopback() 把本线程发出的命令（含提交到异步队列的）
+ * 交给这里的模块替身，不上串口，其他线程照常与模块收发。替身按 ESP-AT 的应答方式
+ * 处理 AT+RST、AT+MQTTPUB 和 AT+MQTTPUBRAW，记下收到的 payload 与预期逐字节比较。
+ */
+
+/* 自检的服务名和 payload 缓冲区大小 */
+#define ESP_SELFTEST_SERVICE    "SelfTest"
+#define ESP_SELFTEST_PAYLOAD    384
+
+/* 超出内联命令长度的备注，原文和 JSON 转义后各一份 */
+#define ESP_SELFTEST_SPAN(q)    "0123456789 raw, " q "abcdefghij "
+#define ESP_SELFTEST_LONG(q)    ESP_SELFTEST_SPAN(q) ESP_SELFTEST_SPAN(q) ESP_SELFTEST_SPAN(q) \
+                                ESP_SELFTEST_SPAN(q) ESP_SELFTEST_SPAN(q) ESP_SELFTEST_SPAN(q) \
+                                ESP_SELFTEST_SPAN(q) ESP_SELFTEST_SPAN(q)
+
+/* 自检用例：短备注走 MQTTPUB（含需要 AT 转义的字符），长备注走 MQTTPUBRAW */
+static const struct
+{
+    const char *note;
+    const char *json;
+    rt_bool_t raw;
+} esp_selftest_cases[] =
+{
+    { "a\"b,c\\d", "a\\\"b,c\\\\d", RT_FALSE },
+    { ESP_SELFTEST_LONG("\""), ESP_SELFTEST_LONG("\\\""), RT_TRUE },
+};
+
+/* 模块替身的接收状态 */
+typedef struct
+{
+    char line[ESP_AT_CMD_MAX + 1];
+    rt_size_t line_len;
+    rt_bool_t line_overflow;    /* 超出模块的命令长度限制 */
+    rt_size_t raw_left;         /* 提示符之后还要收的原始字节数 */
+    char payload[ESP_SELFTEST_PAYLOAD];
+    rt_size_t payload_len;
+    rt_bool_t raw;              /* 最近一次发布用的 MQTTPUBRAW */
+    rt_uint32_t bytes;          /* 收到的全部字节 */
+} esp_fake_t;
+
+/* 异步发布的完成通知 */
+typedef struct
+{
+    struct rt_semaphore sem;
+    rt_err_t result;
+} esp_selftest_wait_t;
+
+static void esp_fake_reply(const char *text)
+{
+    esp_at_loopback_input(text, strlen(text));
+}
+
+static void esp_fake_payload(esp_fake_t *fake, char c)
+{
+    if (fake->payload_len < sizeof(fake->payload))
+    {
+        fake->payload[fake->payload_len] = c;
+    }
+    fake->payload_len++;
+}
+
+/* AT+MQTTPUB=0,"<topic>","<转义的 payload>",<qos>,<retain>：去掉转义取出 payload，未转义的逗号按参数错误处理 */
+static rt_bool_t esp_fake_inline(esp_fake_t *fake, const char *p)
+{
+    p = strstr(p, "\",\"");
+    if (p == RT_NULL)
+    {
+        return RT_FALSE;
+    }
+    for (p += 3; *p != '"'; p++)
+    {
+        if (*p == ',' || *p == '\0' || (*p == '\\' && *++p == '\0'))
+        {
+            return RT_FALSE;
+        }
+        esp_fake_payload(fake, *p);
+    }
+    return p[1] == ',';
+}
+
+/* 一条完整的命令行 */
+static void esp_fake_line(esp_fake_t *fake)
+{
+    const char *line = fake->line;
+
+    if (fake->line_overflow)
+    {
+        esp_fake_reply("ERROR\r\n");
+    }
+    else if (strcmp(line, "AT+RST") == 0)
+    {
+        esp_fake_reply("OK\r\n");
+        esp_fake_reply("\r\nready\r\n");
+    }
+    else if (strncmp(line, "AT+MQTTPUBRAW=", 14) == 0)
+    {
+        const char *p = strrchr(line, '"');
+        int len = p != RT_NULL ? atoi(p + 2) : 0;
+
+        fake->payload_len = 0;
+        fake->raw = RT_TRUE;
+        if (len > 0)
+        {
+            fake->raw_left = len;
+            esp_fake_reply("OK\r\n\r\n>");
+        }
+        else
+        {
+            esp_fake_reply("ERROR\r\n");
+        }
+    }
+    else if (strncmp(line, "AT+MQTTPUB=", 11) == 0)
+    {
+        fake->payload_len = 0;
+        fake->raw = RT_FALSE;
+        esp_fake_reply(esp_fake_inline(fake, line) ? "OK\r\n" : "ERROR\r\n");
+    }
+    else
+    {
+        esp_fake_reply("ERROR\r\n");
+    }
+}
+
+/* 回环接收：提示符之后按长度收原始数据，其余按 \r\n 分行 */
+static void esp_fake_sink(const char *data, rt_size_t len, void *ctx)
+{
+    esp_fake_t *fake = ctx;
+
+    fake->bytes += len;
+    for (rt_size_t i = 0; i < len; i++)
+    {
+        char c = data[i];
+
+        if (fake->raw_left > 0)
+        {
+            esp_fake_payload(fake, c);
+            if (--fake->raw_left == 0)
+            {
+                esp_fake_reply("\r\n+MQTTPUB:OK\r\n");
+            }
+        }
+        else if (c == '\n')
+        {
+            if (fake->line_len > 0 && fake->line[fake->line_len - 1] == '\r')
+            {
+                fake->line_len--;
+            }
+            fake->line[fake->line_len] = '\0';
+            esp_fake_line(fake);
+            fake->line_len = 0;
+            fake->line_overflow = RT_FALSE;
+        }
+        else if (fake->line_len < sizeof(fake->line) - 1)
+        {
+            fake->line[fake->line_len++] = c;
+        }
+        else
+        {
+            fake->line_overflow = RT_TRUE;
+        }
+    }
+}
+
+static void esp_selftest_done(rt_err_t result, const char *resp, void *arg)
+{
+    esp_selftest_wait_t *wait = arg;
+
+    wait->result = result;
+    rt_sem_release(&wait->sem);
+}
+
+/* 按用例走一种发布路径，检查命令类型和模块收到的 payload */
+static rt_bool_t esp_selftest_publish(esp_fake_t *fake, int index, rt_bool_t stream, esp_selftest_wait_t *wait)
+{
+    static char expect[ESP_SELFTEST_PAYLOAD];
+    static char props[ESP_SELFTEST_PAYLOAD];
+    rt_bool_t raw = esp_selftest_cases[index].raw;
+    int seq = index * 2 + stream + 1;
+    rt_bool_t ok;
+
+    rt_snprintf(props, sizeof(props), "\"note\":\"%s\",\"seq\":%d", esp_selftest_cases[index].json, seq);
+    rt_snprintf(expect, sizeof(expect), "{\"services\":[{\"service_id\":\"" ESP_SELFTEST_SERVICE
+                "\",\"properties\":{%s}}]}", props);
+
+    // 没发出发布命令时路径检查不会碰巧通过
+    fake->raw = !raw;
+    fake->payload_len = 0;
+    fake->bytes = 0;
+    if (stream)
+    {
+        ok = esp_report_probe(ESP_SELFTEST_SERVICE, esp_selftest_cases[index].note, seq) == 0;
+    }
+    else
+    {
+        // 工作线程总会回调（命令自带超时），一直等，回调不会落在已销毁的信号量上
+        ok = esp_report_props(ESP_SELFTEST_SERVICE, props, esp_selftest_done, wait) == 0 &&
+             rt_sem_take(&wait->sem, RT_WAITING_FOREVER) == RT_EOK &&
+             wait->result == RT_EOK;
+    }
+    ok = ok && fake->payload_len == strlen(expect) && memcmp(fake->payload, expect, fake->payload_len) == 0;
+
+    rt_kprintf("[ESP] selftest %s %s: %d bytes on the wire, payload %d bytes -> %s\n",
+               stream ? "stream" : "queued", raw ? "MQTTPUBRAW" : "MQTTPUB",
+               fake->bytes, fake->payload_len, ok && fake->raw == raw ? "PASS" : "FAIL");
+    if (ok && fake->raw != raw)
+    {
+        // 短报文走了 RAW 多半是 esp_pub 改低了门限
+        rt_kprintf("[ESP] selftest: sent with %s instead, check the esp_pub raw threshold\n",
+                   fake->raw ? "MQTTPUBRAW" : "MQTTPUB");
+    }
+    return ok && fake->raw == raw;
+}
+
+/**
+ * @brief 发布路径自检：检查 AT+RST 等到 ready（ready 同时是主动上报），以及同步流式和
+ *        异步队列两条路径的 MQTTPUB / MQTTPUBRAW payload 与预期逐字节一致
+ */
+static int esp_pub_selftest(int argc, char *argv[])
+{
+    static esp_fake_t fake;
+    esp_selftest_wait_t wait;
+    int failures = 0;
+
+    rt_memset(&fake, 0, sizeof(fake));
+    if (esp_at_loopback(esp_fake_sink, &fake) != RT_EOK)
+    {
+        rt_kprintf("[ESP] selftest: AT engine not running\n");
+        return -1;
+    }
+    rt_sem_init(&wait.sem, "esp_sft", 0, RT_IPC_FLAG_FIFO);
+
+    if (esp_at_exec("AT+RST", "ready", RT_NULL, 0, 1000) == RT_EOK)
+    {
+        rt_kprintf("[ESP] selftest AT+RST: ready -> PASS\n");
+    }
+    else
+    {
+        rt_kprintf("[ESP] selftest AT+RST: ready -> FAIL\n");
+        failures++;
+    }
+
+    for (int i = 0; i < (int)(sizeof(esp_selftest_cases) / sizeof(esp_selftest_cases[0])); i++)
+    {
+        failures += !esp_selftest_publish(&fake, i, RT_TRUE, &wait);
+        failures += !esp_selftest_publish(&fake, i, RT_FALSE, &wait);
+    }
+
+    esp_at_loopback(RT_NULL, RT_NULL);
+    rt_sem_detach(&wait.sem);
+
+    rt_kprintf("[ESP] selftest: %d failures -> %s\n", failures, failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : -1;
+}
+MSH_CMD_EXPORT(esp_pub_selftest, check AT+RST and both publish paths against a stand-in module);
+#endif /* RT_USING_FINSH */
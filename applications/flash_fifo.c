@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         片内 flash 持久化先进先出队列（断网缓存）
+ */
+
+#include "flash_fifo.h"
+#ifdef BSP_USING_FLASH
+#include "fsl_romapi.h"
+#endif
+#include <string.h>
+
+/*
+ * 只追加写：每个扇区以扇区头开始（序号递增），之后依次是记录，
+ * 记录由一个记录头 phrase 和按 phrase 对齐的数据组成，CRC 覆盖头和数据。
+ * 先写记录头再写数据，写到一半掉电或编程失败的记录 CRC 不对；记录头完好时
+ * 按其长度跳过这条记录继续读后面的，记录头本身不可用才视为扇区结束。
+ *
+ * flash 不能改写已编程的 phrase，取走记录不改原记录，而是追加一条
+ * 确认记录（含已取走的最大序号）；上电时取所有确认记录的最大值，
+ * 之后的数据记录就是未取走的队列。确认每 FLASH_FIFO_ACK_EVERY 条写一次，
+ * 换扇区时在新扇区开头重写一次，不会随旧扇区被擦掉。
+ *
+ * 内存中只有读写位置和计数，与断网时长和队列长度无关。
+ */
+
+#define FLASH_FIFO_SECTOR_MAGIC 0x31464646      /* "FFF1" */
+#define FLASH_FIFO_DATA_MAGIC   0xA55A
+#define FLASH_FIFO_ACK_MAGIC    0xAC4B
+
+/* 存储区的读地址（片内 flash 直接映射） */
+#ifndef FLASH_FIFO_MAP
+#define FLASH_FIFO_MAP          ((const rt_uint8_t *)FLASH_FIFO_START)
+#endif
+
+#define FLASH_FIFO_ALIGN(n)     (((n) + FLASH_FIFO_PHRASE - 1) & ~(FLASH_FIFO_PHRASE - 1))
+
+/* 扇区头，一个 phrase */
+typedef struct
+{
+    rt_uint32_t magic;
+    rt_uint32_t seq;
+    rt_uint32_t reserved[2];
+} flash_fifo_sector_t;
+
+/* 记录头，一个 phrase */
+typedef struct
+{
+    rt_uint16_t magic;
+    rt_uint16_t len;
+    rt_uint32_t seq;            /* 数据记录的序号，确认记录为已取走的最大序号 */
+    rt_uint32_t crc;
+    rt_uint32_t reserved;
+} flash_fifo_record_t;
+
+/* 队列中的位置 */
+typedef struct
+{
+    rt_uint8_t sector;
+    rt_uint32_t offset;
+} flash_fifo_pos_t;
+
+#ifdef BSP_USING_FLASH
+static flash_config_t flash_fifo_config;
+#endif
+static rt_bool_t flash_fifo_ready = RT_FALSE;
+static struct rt_mutex flash_fifo_lock;
+
+static flash_fifo_pos_t flash_fifo_head;        // 下一条记录的写入位置
+static flash_fifo_pos_t flash_fifo_tail;        // 从这里向后找第一条未取走的记录
+static rt_uint32_t flash_fifo_head_seq;         // 写入扇区的扇区序号
+static rt_uint32_t flash_fifo_next_seq = 1;     // 下一条数据记录的序号
+static rt_uint32_t flash_fifo_acked = 0;        // 已取走的最大序号
+static rt_uint32_t flash_fifo_unacked = 0;      // 取走后尚未写确认的条数
+
+static flash_fifo_stats_t flash_fifo_stats;
+
+/* CRC-32（IEEE 802.3），半字节查表 */
+static rt_uint32_t flash_fifo_crc32(rt_uint32_t crc, const rt_uint8_t *data, rt_size_t len)
+{
+    static const rt_uint32_t table[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc = table[(crc ^ *data) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (*data >> 4)) & 0x0F] ^ (crc >> 4);
+        data++;
+    }
+    return ~crc;
+}
+
+static const rt_uint8_t *flash_fifo_addr(rt_uint8_t sector, rt_uint32_t offset)
+{
+    return FLASH_FIFO_MAP + sector * FLASH_FIFO_SECTOR_SIZE + offset;
+}
+
+static rt_bool_t flash_fifo_erased(const rt_uint8_t *p, rt_size_t len)
+{
+    while (len--)
+    {
+        if (*p++ != 0xFF)
+        {
+            return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+#ifdef BSP_USING_FLASH
+/* 擦除一个扇区 */
+static rt_err_t flash_fifo_erase(rt_uint8_t sector)
+{
+    status_t status = FLASH_EraseSector(&flash_fifo_config,
+                                        FLASH_FIFO_START + sector * FLASH_FIFO_SECTOR_SIZE,
+                                        FLASH_FIFO_SECTOR_SIZE, kFLASH_ApiEraseKey);
+
+    flash_fifo_stats.erases++;
+    if (status != kStatus_Success)
+    {
+        flash_fifo_stats.errors++;
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+/* 按 phrase 编程，末尾不足一个 phrase 的部分补 0xFF */
+static rt_err_t flash_fifo_program(flash_fifo_pos_t pos, const void *data, rt_size_t len)
+{
+    rt_uint32_t phrase[FLASH_FIFO_PHRASE / 4];
+    rt_uint32_t addr = FLASH_FIFO_START + pos.sector * FLASH_FIFO_SECTOR_SIZE + pos.offset;
+    const rt_uint8_t *src = data;
+
+    for (rt_size_t done = 0; done < len; done += FLASH_FIFO_PHRASE)
+    {
+        rt_size_t n = len - done < FLASH_FIFO_PHRASE ? len - done : FLASH_FIFO_PHRASE;
+
+        memset(phrase, 0xFF, sizeof(phrase));
+        memcpy(phrase, &src[done], n);
+        if (FLASH_ProgramPhrase(&flash_fifo_config, addr + done, (uint8_t *)phrase,
+                                FLASH_FIFO_PHRASE) != kStatus_Success)
+        {
+            flash_fifo_stats.errors++;
+            return -RT_ERROR;
+        }
+    }
+    return RT_EOK;
+}
+#else
+/* 未启用片内 flash 驱动（BSP_USING_FLASH）时初始化失败，不会执行到擦写 */
+static rt_err_t flash_fifo_erase(rt_uint8_t sector)
+{
+    return -RT_ERROR;
+}
+
+static rt_err_t flash_fifo_program(flash_fifo_pos_t pos, const void *data, rt_size_t len)
+{
+    return -RT_ERROR;
+}
+#endif /* BSP_USING_FLASH */
+
+/*
+ * 读取并校验 pos 处的记录：RT_EOK 有效；-RT_ERROR 记录头完好但 CRC 不对，
+ * 可按 flash_fifo_span() 跳过；-RT_EEMPTY 空白或记录头不可用，扇区到此结束
+ */
+static rt_err_t flash_fifo_read_record(flash_fifo_pos_t pos, flash_fifo_record_t *rec)
+{
+    const rt_uint8_t *p = flash_fifo_addr(pos.sector, pos.offset);
+    rt_uint32_t crc;
+
+    if (pos.offset + FLASH_FIFO_PHRASE > FLASH_FIFO_SECTOR_SIZE)
+    {
+        return -RT_EEMPTY;
+    }
+    memcpy(rec, p, sizeof(*rec));
+    if ((rec->magic != FLASH_FIFO_DATA_MAGIC && rec->magic != FLASH_FIFO_ACK_MAGIC) ||
+        pos.offset + FLASH_FIFO_PHRASE + FLASH_FIFO_ALIGN(rec->len) > FLASH_FIFO_SECTOR_SIZE)
+    {
+        return -RT_EEMPTY;
+    }
+    crc = flash_fifo_crc32(0, p, 8);
+    crc = flash_fifo_crc32(crc, p + FLASH_FIFO_PHRASE, rec->len);
+    return crc == rec->crc ? RT_EOK : -RT_ERROR;
+}
+
+/* 记录占用的字节数 */
+static rt_uint32_t flash_fifo_span(const flash_fifo_record_t *rec)
+{
+    return FLASH_FIFO_PHRASE + FLASH_FIFO_ALIGN(rec->len);
+}
+
+/* 有效扇区的扇区序号，无效返回 0 */
+static rt_uint32_t flash_fifo_sector_seq(rt_uint8_t sector)
+{
+    flash_fifo_sector_t hdr;
+
+    memcpy(&hdr, flash_fifo_addr(sector, 0), sizeof(hdr));
+    return hdr.magic == FLASH_FIFO_SECTOR_MAGIC ? hdr.seq : 0;
+}
+
+static rt_err_t flash_fifo_append(rt_uint16_t magic, rt_uint32_t seq, const void *data, rt_size_t len);
+
+/* 写入位置换到下一个扇区：被覆盖扇区中未取走的记录计入丢失 */
+static rt_err_t flash_fifo_rotate(void)
+{
+    rt_uint8_t next = (flash_fifo_head.sector + 1) % FLASH_FIFO_SECTORS;
+    flash_fifo_sector_t hdr;
+
+    if (flash_fifo_stats.pending > 0 && flash_fifo_tail.sector == next)
+    {
+        flash_fifo_record_t rec;
+        flash_fifo_pos_t pos = flash_fifo_tail;
+        rt_err_t state;
+
+        while ((state = flash_fifo_read_record(pos, &rec)) != -RT_EEMPTY)
+        {
+            if (state == RT_EOK && rec.magic == FLASH_FIFO_DATA_MAGIC && rec.seq > flash_fifo_acked)
+            {
+                flash_fifo_stats.lost++;
+                flash_fifo_stats.pending--;
+                flash_fifo_stats.pending_bytes -= rec.len;
+                flash_fifo_acked = rec.seq;
+            }
+            pos.offset += flash_fifo_span(&rec);
+        }
+        flash_fifo_tail.sector = (next + 1) % FLASH_FIFO_SECTORS;
+        flash_fifo_tail.offset = FLASH_FIFO_PHRASE;
+    }
+
+    if (flash_fifo_erase(next) != RT_EOK)
+    {
+        return -RT_ERROR;
+    }
+    memset(&hdr, 0xFF, sizeof(hdr));
+    hdr.magic = FLASH_FIFO_SECTOR_MAGIC;
+    hdr.seq = ++flash_fifo_head_seq;
+    flash_fifo_head.sector = next;
+    flash_fifo_head.offset = 0;
+    if (flash_fifo_program(flash_fifo_head, &hdr, sizeof(hdr)) != RT_EOK)
+    {
+        return -RT_ERROR;
+    }
+    flash_fifo_head.offset = FLASH_FIFO_PHRASE;
+
+    // 确认记录随新扇区保存一份，旧扇区擦掉后上电仍能恢复读位置
+    if (flash_fifo_acked != 0)
+    {
+        flash_fifo_unacked = 0;
+        return flash_fifo_append(FLASH_FIFO_ACK_MAGIC, flash_fifo_acked, RT_NULL, 0);
+    }
+    return RT_EOK;
+}
+
+/* 追加一条记录，空间不够时先换扇区 */
+static rt_err_t flash_fifo_append(rt_uint16_t magic, rt_uint32_t seq, const void *data, rt_size_t len)
+{
+    flash_fifo_record_t rec;
+    flash_fifo_pos_t pos;
+    rt_uint32_t crc;
+
+    if (flash_fifo_head.offset + FLASH_FIFO_PHRASE + FLASH_FIFO_ALIGN(len) > FLASH_FIFO_SECTOR_SIZE)
+    {
+        if (flash_fifo_rotate() != RT_EOK)
+        {
+            return -RT_ERROR;
+        }
+    }
+
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.magic = magic;
+    rec.len = len;
+    rec.seq = seq;
+    crc = flash_fifo_crc32(0, (const rt_uint8_t *)&rec, 8);
+    rec.crc = flash_fifo_crc32(crc, data, len);
+
+    pos = flash_fifo_head;
+    // 写到一半出错也跳过这段空间，不在半写的 phrase 上重复编程
+    flash_fifo_head.offset += FLASH_FIFO_PHRASE + FLASH_FIFO_ALIGN(len);
+    if (flash_fifo_program(pos, &rec, sizeof(rec)) != RT_EOK)
+    {
+        return -RT_ERROR;
+    }
+    pos.offset += FLASH_FIFO_PHRASE;
+    if (flash_fifo_program(pos, data, len) != RT_EOK)
+    {
+        // 记录头已写上，读取时按损坏记录跳过
+        flash_fifo_stats.corrupt++;
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+/* 把 tail 移到第一条未取走的数据记录，返回其记录头 */
+static rt_bool_t flash_fifo_find_tail(flash_fifo_record_t *rec)
+{
+    rt_uint8_t sectors = 0;
+
+    while (flash_fifo_stats.pending > 0)
+    {
+        rt_err_t state = flash_fifo_read_record(flash_fifo_tail, rec);
+
+        if (state == -RT_EEMPTY)
+        {
+            // 扇区结束，到下一个扇区继续
+            if (flash_fifo_tail.sector == flash_fifo_head.sector || ++sectors > FLASH_FIFO_SECTORS)
+            {
+                // 计数与 flash 内容不一致，以 flash 为准
+                flash_fifo_stats.pending = 0;
+                flash_fifo_stats.pending_bytes = 0;
+                break;
+            }
+            flash_fifo_tail.sector = (flash_fifo_tail.sector + 1) % FLASH_FIFO_SECTORS;
+            flash_fifo_tail.offset = FLASH_FIFO_PHRASE;
+            continue;
+        }
+        if (state == RT_EOK && rec->magic == FLASH_FIFO_DATA_MAGIC && rec->seq > flash_fifo_acked)
+        {
+            return RT_TRUE;
+        }
+        // 确认记录、已取走的记录和损坏的记录（上电扫描或写入时已计数）都跳过
+        flash_fifo_tail.offset += flash_fifo_span(rec);
+    }
+    return RT_FALSE;
+}
+
+/* 上电扫描：按扇区序号从旧到新遍历，visit 处理每条有效记录，返回跳过的损坏记录数 */
+static rt_uint32_t flash_fifo_scan(rt_uint8_t oldest, rt_uint8_t newest,
+                                   void (*visit)(flash_fifo_pos_t pos, const flash_fifo_record_t *rec))
+{
+    rt_uint32_t prev_seq = 0;
+    rt_uint32_t corrupt = 0;
+
+    for (rt_uint8_t i = 0; i < FLASH_FIFO_SECTORS; i++)
+    {
+        flash_fifo_pos_t pos = { (oldest + i) % FLASH_FIFO_SECTORS, FLASH_FIFO_PHRASE };
+        rt_uint32_t seq = flash_fifo_sector_seq(pos.sector);
+        flash_fifo_record_t rec;
+
+        // 擦除后没写上扇区头的扇区，或不属于这一轮的旧扇区
+        if (seq != 0 && seq > prev_seq)
+        {
+            rt_err_t state;
+
+            prev_seq = seq;
+            while ((state = flash_fifo_read_record(pos, &rec)) != -RT_EEMPTY)
+            {
+                if (state == RT_EOK)
+                {
+                    visit(pos, &rec);
+                }
+                else
+                {
+                    corrupt++;
+                }
+                pos.offset += flash_fifo_span(&rec);
+            }
+        }
+        if (pos.sector == newest)
+        {
+            break;
+        }
+    }
+    return corrupt;
+}
+
+static void flash_fifo_visit_ack(flash_fifo_pos_t pos, const flash_fifo_record_t *rec)
+{
+    if (rec->magic == FLASH_FIFO_ACK_MAGIC && rec->seq > flash_fifo_acked)
+    {
+        flash_fifo_acked = rec->seq;
+    }
+    if (rec->magic == FLASH_FIFO_DATA_MAGIC && rec->seq >= flash_fifo_next_seq)
+    {
+        flash_fifo_next_seq = rec->seq + 1;
+    }
+}
+
+static void flash_fifo_visit_pending(flash_fifo_pos_t pos, const flash_fifo_record_t *rec)
+{
+    if (rec->magic == FLASH_FIFO_DATA_MAGIC && rec->seq > flash_fifo_acked)
+    {
+        if (flash_fifo_stats.pending == 0)
+        {
+            flash_fifo_tail = pos;
+        }
+        flash_fifo_stats.pending++;
+        flash_fifo_stats.pending_bytes += rec->len;
+    }
+}
+
+/* 在最新的扇区中找到写入位置，其后有损坏数据时换扇区 */
+static void flash_fifo_find_head(rt_uint8_t newest)
+{
+    flash_fifo_pos_t pos = { newest, FLASH_FIFO_PHRASE };
+    flash_fifo_record_t rec;
+
+    // 损坏的记录已在扫描时计数，跳过
+    while (flash_fifo_read_record(pos, &rec) != -RT_EEMPTY)
+    {
+        pos.offset += flash_fifo_span(&rec);
+    }
+    if (!flash_fifo_erased(flash_fifo_addr(pos.sector, pos.offset), FLASH_FIFO_SECTOR_SIZE - pos.offset))
+    {
+        flash_fifo_stats.corrupt++;
+        pos.offset = FLASH_FIFO_SECTOR_SIZE;
+    }
+    flash_fifo_head = pos;
+}
+
+/**
+ * @brief   初始化 flash 驱动并扫描存储区
+ */
+rt_err_t flash_fifo_init(void)
+{
+    rt_uint32_t oldest_seq = 0, newest_seq = 0;
+    rt_uint8_t oldest = 0, newest = 0;
+
+    rt_mutex_init(&flash_fifo_lock, "ffifo", RT_IPC_FLAG_PRIO);
+
+#ifndef BSP_USING_FLASH
+    rt_kprintf("[FIFO] on-chip flash driver disabled (BSP_USING_FLASH)\n");
+    return -RT_ERROR;
+#else
+    rt_uint32_t sector_size = 0;
+
+    if (FLASH_Init(&flash_fifo_config) != kStatus_Success ||
+        FLASH_GetProperty(&flash_fifo_config, kFLASH_PropertyPflash0SectorSize, &sector_size) != kStatus_Success ||
+        sector_size != FLASH_FIFO_SECTOR_SIZE)
+    {
+        rt_kprintf("[FIFO] flash init failed (sector size %d)\n", sector_size);
+        return -RT_ERROR;
+    }
+#endif
+
+    for (rt_uint8_t i = 0; i < FLASH_FIFO_SECTORS; i++)
+    {
+        rt_uint32_t seq = flash_fifo_sector_seq(i);
+
+        if (seq == 0)
+        {
+            continue;
+        }
+        if (oldest_seq == 0 || seq < oldest_seq)
+        {
+            oldest_seq = seq;
+            oldest = i;
+        }
+        if (seq > newest_seq)
+        {
+            newest_seq = seq;
+            newest = i;
+        }
+    }
+
+    if (newest_seq == 0)
+    {
+        // 空白存储区：第一次写入时换到扇区 0
+        flash_fifo_head.sector = FLASH_FIFO_SECTORS - 1;
+        flash_fifo_head.offset = FLASH_FIFO_SECTOR_SIZE;
+    }
+    else
+    {
+        flash_fifo_stats.corrupt += flash_fifo_scan(oldest, newest, flash_fifo_visit_ack);
+        flash_fifo_scan(oldest, newest, flash_fifo_visit_pending);
+        flash_fifo_find_head(newest);
+    }
+    flash_fifo_head_seq = newest_seq;
+    if (flash_fifo_stats.pending == 0)
+    {
+        flash_fifo_tail = flash_fifo_head;
+    }
+    if (flash_fifo_next_seq <= flash_fifo_acked)
+    {
+        flash_fifo_next_seq = flash_fifo_acked + 1;
+    }
+
+    flash_fifo_ready = RT_TRUE;
+    rt_kprintf("[FIFO] %d records pending (%d bytes), next seq %d\n",
+               flash_fifo_stats.pending, flash_fifo_stats.pending_bytes, flash_fifo_next_seq);
+    return RT_EOK;
+}
+
+/**
+ * @brief   追加一条记录
+ */
+rt_err_t flash_fifo_push(const void *data, rt_size_t len)
+{
+    rt_err_t result;
+
+    if (len == 0 || len > FLASH_FIFO_RECORD_MAX)
+    {
+        return -RT_EINVAL;
+    }
+    if (!flash_fifo_ready)
+    {
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&flash_fifo_lock, RT_WAITING_FOREVER);
+    result = flash_fifo_append(FLASH_FIFO_DATA_MAGIC, flash_fifo_next_seq, data, len);
+    if (result == RT_EOK)
+    {
+        // 队列原来为空时读位置可能停在已被换掉的扇区，从这条记录开始读
+        if (flash_fifo_stats.pending == 0)
+        {
+            flash_fifo_tail.sector = flash_fifo_head.sector;
+            flash_fifo_tail.offset = flash_fifo_head.offset - FLASH_FIFO_PHRASE - FLASH_FIFO_ALIGN(len);
+        }
+        flash_fifo_next_seq++;
+        flash_fifo_stats.pending++;
+        flash_fifo_stats.pending_bytes += len;
+        flash_fifo_stats.pushed++;
+    }
+    rt_mutex_release(&flash_fifo_lock);
+
+    return result;
+}
+
+/**
+ * @brief   读取最旧的一条记录，不取走
+ */
+rt_ssize_t flash_fifo_peek(void *buf, rt_size_t size, rt_uint32_t *seq)
+{
+    flash_fifo_record_t rec;
+    rt_ssize_t len = 0;
+
+    rt_mutex_take(&flash_fifo_lock, RT_WAITING_FOREVER);
+    if (flash_fifo_find_tail(&rec))
+    {
+        *seq = rec.seq;
+        if (rec.len > size)
+        {
+            len = -RT_ENOSPC;
+        }
+        else
+        {
+            memcpy(buf, flash_fifo_addr(flash_fifo_tail.sector, flash_fifo_tail.offset + FLASH_FIFO_PHRASE),
+                   rec.len);
+            len = rec.len;
+        }
+    }
+    rt_mutex_release(&flash_fifo_lock);
+
+    return len;
+}
+
+/**
+ * @brief   取走最旧的一条记录，它必须仍是 peek 读到的那条
+ */
+rt_err_t flash_fifo_pop(rt_uint32_t seq)
+{
+    flash_fifo_record_t rec;
+    rt_err_t result = -RT_ERROR;
+
+    rt_mutex_take(&flash_fifo_lock, RT_WAITING_FOREVER);
+    // peek 之后换扇区覆盖了那条记录时，现在最旧的是另一条还没发出的记录
+    if (flash_fifo_find_tail(&rec) && rec.seq == seq)
+    {
+        result = RT_EOK;
+        flash_fifo_tail.offset += flash_fifo_span(&rec);
+        flash_fifo_acked = rec.seq;
+        flash_fifo_stats.pending--;
+        flash_fifo_stats.pending_bytes -= rec.len;
+        flash_fifo_stats.popped++;
+
+        if (++flash_fifo_unacked >= FLASH_FIFO_ACK_EVERY || flash_fifo_stats.pending == 0)
+        {
+            flash_fifo_unacked = 0;
+            flash_fifo_append(FLASH_FIFO_ACK_MAGIC, flash_fifo_acked, RT_NULL, 0);
+        }
+    }
+    rt_mutex_release(&flash_fifo_lock);
+
+    return result;
+}
+
+/**
+ * @brief   待取走的记录数
+ */
+rt_uint32_t flash_fifo_pending(void)
+{
+    return flash_fifo_stats.pending;
+}
+
+/**
+ * @brief   读取队列统计
+ */
+void flash_fifo_get_stats(flash_fifo_stats_t *stats)
+{
+    rt_mutex_take(&flash_fifo_lock, RT_WAITING_FOREVER);
+    *stats = flash_fifo_stats;
+    rt_mutex_release(&flash_fifo_lock);
+}
+
+#ifdef RT_USING_FINSH
+/**
+ * @brief   打印队列统计
+ */
+static int flash_fifo_stat(int argc, char *argv[])
+{
+    flash_fifo_stats_t s;
+
+    flash_fifo_get_stats(&s);
+    rt_kprintf("[FIFO] %s, pending: %d records / %d bytes, capacity: %d bytes\n",
+               flash_fifo_ready ? "ready" : "unavailable", s.pending, s.pending_bytes,
+               FLASH_FIFO_SECTORS * FLASH_FIFO_SECTOR_SIZE);
+    rt_kprintf("[FIFO] pushed: %d, popped: %d, lost: %d, corrupt: %d, erases: %d, errors: %d\n",
+               s.pushed, s.popped, s.lost, s.corrupt, s.erases, s.errors);
+    rt_kprintf("[FIFO] head: sector %d +%d, tail: sector %d +%d, acked seq: %d, next seq: %d\n",
+               flash_fifo_head.sector, flash_fifo_head.offset, flash_fifo_tail.sector,
+               flash_fifo_tail.offset, flash_fifo_acked, flash_fifo_next_seq);
+    return 0;
+}
+MSH_CMD_EXPORT(flash_fifo_stat, show flash store-and-forward queue statistics);
+#endif /* RT_USING_FINSH */
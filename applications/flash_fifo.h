@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         片内 flash 持久化先进先出队列（断网缓存）
+ */
+
+#ifndef FLASH_FIFO_H
+#define FLASH_FIFO_H
+
+#include <rtthread.h>
+
+/*
+ * 存储区：片内 flash 最后 64KB（链接脚本中已从代码区扣除），8KB 一个扇区
+ * 轮转使用。写满时擦除最旧的扇区，其中未取走的记录计入丢失。
+ */
+#ifndef FLASH_FIFO_START
+#define FLASH_FIFO_START        0x000F0000
+#endif
+#define FLASH_FIFO_SECTOR_SIZE  8192
+#define FLASH_FIFO_SECTORS      8
+
+/* 编程最小单位（phrase），记录按此对齐，每个 phrase 只能编程一次 */
+#define FLASH_FIFO_PHRASE       16
+
+/* 单条记录最大长度（扇区头和记录头各占一个 phrase） */
+#define FLASH_FIFO_RECORD_MAX   (FLASH_FIFO_SECTOR_SIZE - 2 * FLASH_FIFO_PHRASE)
+
+/* 每取走这么多条记录写一次确认，掉电后最多重发这么多条 */
+#define FLASH_FIFO_ACK_EVERY    8
+
+/* 队列统计 */
+typedef struct
+{
+    rt_uint32_t pending;        /* 待取走的记录数 */
+    rt_uint32_t pending_bytes;  /* 待取走记录的数据字节数 */
+    rt_uint32_t pushed;         /* 本次上电写入的记录数 */
+    rt_uint32_t popped;         /* 本次上电取走的记录数 */
+    rt_uint32_t lost;           /* 扇区被覆盖而丢失的记录数 */
+    rt_uint32_t corrupt;        /* 跳过的损坏记录数（写入中途掉电或编程失败） */
+    rt_uint32_t erases;         /* 扇区擦除次数 */
+    rt_uint32_t errors;         /* flash 操作失败次数 */
+} flash_fifo_stats_t;
+
+/**
+ * @brief   初始化 flash 驱动并扫描存储区，恢复上次掉电前的队列
+ * @return  RT_EOK 成功，-RT_ERROR flash 不可用（之后的写入直接失败）
+ */
+rt_err_t flash_fifo_init(void);
+
+/**
+ * @brief   追加一条记录（会阻塞到编程完成，换扇区时含一次擦除）
+ * @return  RT_EOK 成功，-RT_EINVAL 长度无效，-RT_ERROR flash 错误
+ */
+rt_err_t flash_fifo_push(const void *data, rt_size_t len);
+
+/**
+ * @brief   读取最旧的一条记录，不取走
+ * @param   seq     返回记录的序号，取走时交给 flash_fifo_pop()
+ * @return  记录长度，0 表示队列为空，-RT_ENOSPC 表示 buf 放不下（seq 仍有效）
+ */
+rt_ssize_t flash_fifo_peek(void *buf, rt_size_t size, rt_uint32_t *seq);
+
+/**
+ * @brief   取走最旧的一条记录（处理成功后调用）
+ * @param   seq     flash_fifo_peek() 返回的序号
+ * @return  RT_EOK 成功，-RT_ERROR 这条记录已不在队首（写满换扇区时被覆盖，计入丢失），
+ *          此时什么也不取走
+ */
+rt_err_t flash_fifo_pop(rt_uint32_t seq);
+
+/**
+ * @brief   待取走的记录数
+ */
+rt_uint32_t flash_fifo_pending(void);
+
+/**
+ * @brief   读取队列统计
+ */
+void flash_fifo_get_stats(flash_fifo_stats_t *stats);
+
+#endif /* FLASH_FIFO_H */
@@ -0,0 +1,641 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         电子围栏：二进制区域表、网格索引、进出事件
+ */
+
+#include "geofence.h"
+#include "drv_dwt.h"
+#include <stdlib.h>
+
+/* 纬度 1e-7 度对应的距离：1.11319 厘米 */
+#define GEOFENCE_CM_PER_E7_NUM      111319
+#define GEOFENCE_CM_PER_E7_DEN      100000
+#define GEOFENCE_DEG_E7             10000000
+
+/* 加载后的区域，外接矩形用于网格分桶和快速排除 */
+typedef struct
+{
+    rt_int32_t min_lat;
+    rt_int32_t max_lat;
+    rt_int32_t min_lon;
+    rt_int32_t max_lon;
+    const rt_int32_t *vertices;     /* 多边形顶点（纬度、经度交替），指向区域表 */
+    rt_uint32_t count;              /* 多边形顶点数 */
+    rt_int32_t lat;                 /* 圆心 */
+    rt_int32_t lon;
+    rt_uint32_t radius_cm;          /* 半径（厘米） */
+    rt_uint16_t cos_q15;            /* 圆心纬度的余弦，Q15，经度差换算为距离 */
+    rt_uint16_t id;
+    rt_uint8_t type;
+    rt_uint8_t kind;
+} geofence_zone_t;
+
+/* 网格索引：CSR 形式，cell_start[c] 到 cell_start[c+1] 为格子 c 内的区域下标 */
+typedef struct
+{
+    geofence_zone_t *zones;
+    rt_uint16_t zone_count;
+    rt_int32_t min_lat;             /* 全部区域的外接矩形 */
+    rt_int32_t min_lon;
+    rt_uint32_t span_lat;
+    rt_uint32_t span_lon;
+    rt_uint16_t cell_start[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM + 1];
+    rt_uint16_t *cell_items;
+} geofence_index_t;
+
+/* 统计 */
+typedef struct
+{
+    rt_uint32_t updates;            /* 处理的定位次数 */
+    rt_uint32_t zone_tests;         /* 精确判断的区域次数 */
+    rt_uint32_t events;             /* 产生的进出事件数 */
+    rt_uint32_t overflows;          /* 同时所在区域超过上限的次数 */
+    rt_uint32_t max_cycles;         /* 单次更新最长耗时（CPU周期） */
+} geofence_stats_t;
+
+static geofence_index_t *geofence_index = RT_NULL;
+static struct rt_mutex geofence_lock;
+static rt_bool_t geofence_lock_ready = RT_FALSE;
+static geofence_handler_t geofence_handler = RT_NULL;
+static geofence_stats_t geofence_stats;
+
+/* 当前所在的区域下标 */
+static rt_uint16_t geofence_active[GEOFENCE_MAX_ACTIVE];
+static rt_uint8_t geofence_active_count = 0;
+
+/* 0~90 度余弦，Q15，1 度一格，线性插值 */
+static const rt_uint16_t geofence_cos_table[91] =
+{
+    32767, 32763, 32748, 32723, 32688, 32643, 32588, 32524, 32449, 32365,
+    32270, 32166, 32052, 31928, 31795, 31651, 31499, 31336, 31164, 30983,
+    30792, 30592, 30382, 30163, 29935, 29698, 29452, 29197, 28932, 28660,
+    28378, 28088, 27789, 27482, 27166, 26842, 26510, 26170, 25822, 25466,
+    25102, 24730, 24351, 23965, 23571, 23170, 22763, 22348, 21926, 21498,
+    21063, 20622, 20174, 19720, 19261, 18795, 18324, 17847, 17364, 16877,
+    16384, 15886, 15384, 14876, 14365, 13848, 13328, 12803, 12275, 11743,
+    11207, 10668, 10126,  9580,  9032,  8481,  7927,  7371,  6813,  6252,
+     5690,  5126,  4560,  3993,  3425,  2856,  2286,  1715,  1144,   572,
+        0,
+};
+
+/* 纬度（1e-7 度）的余弦，Q15 */
+static rt_uint16_t geofence_cos_q15(rt_int32_t latitude)
+{
+    rt_uint32_t mag = latitude < 0 ? -(rt_uint32_t)latitude : (rt_uint32_t)latitude;
+    rt_uint32_t deg = mag / GEOFENCE_DEG_E7;
+    rt_uint32_t frac = mag % GEOFENCE_DEG_E7;
+    rt_int32_t a, b;
+
+    if (deg >= 90)
+    {
+        return 0;
+    }
+    a = geofence_cos_table[deg];
+    b = geofence_cos_table[deg + 1];
+    return (rt_uint16_t)(a + (rt_int32_t)((rt_int64_t)(b - a) * frac / GEOFENCE_DEG_E7));
+}
+
+/* 点到圆心的距离是否不超过半径（等距圆柱近似，区域尺度内误差可忽略） */
+static rt_bool_t geofence_in_circle(const geofence_zone_t *zone, rt_int32_t lat, rt_int32_t lon)
+{
+    /* 已通过外接矩形检查，坐标差不超过半径对应的度数 */
+    rt_int64_t dy = (rt_int64_t)(lat - zone->lat) * GEOFENCE_CM_PER_E7_NUM / GEOFENCE_CM_PER_E7_DEN;
+    rt_int64_t dx = (rt_int64_t)(lon - zone->lon) * zone->cos_q15 / 32768
+                    * GEOFENCE_CM_PER_E7_NUM / GEOFENCE_CM_PER_E7_DEN;
+
+    return dx * dx + dy * dy <= (rt_int64_t)zone->radius_cm * zone->radius_cm;
+}
+
+/* 射线法判断点是否在多边形内，交点比较改为交叉相乘，全程整数 */
+static rt_bool_t geofence_in_polygon(const geofence_zone_t *zone, rt_int32_t lat, rt_int32_t lon)
+{
+    const rt_int32_t *v = zone->vertices;
+    rt_uint32_t n = zone->count;
+    rt_bool_t inside = RT_FALSE;
+
+    for (rt_uint32_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        rt_int32_t yi = v[2 * i], xi = v[2 * i + 1];
+        rt_int32_t yj = v[2 * j], xj = v[2 * j + 1];
+
+        if ((yi > lat) != (yj > lat))
+        {
+            /* lon < xi + (lat - yi) * (xj - xi) / (yj - yi)，两边同乘 (yj - yi) */
+            rt_int64_t lhs = (rt_int64_t)(lon - xi) * (yj - yi);
+            rt_int64_t rhs = (rt_int64_t)(lat - yi) * (xj - xi);
+
+            if (yj > yi ? lhs < rhs : lhs > rhs)
+            {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+/* 精确判断，先用外接矩形排除 */
+static rt_bool_t geofence_zone_contains(const geofence_zone_t *zone, rt_int32_t lat, rt_int32_t lon)
+{
+    if (lat < zone->min_lat || lat > zone->max_lat || lon < zone->min_lon || lon > zone->max_lon)
+    {
+        return RT_FALSE;
+    }
+    if (zone->type == GEOFENCE_TYPE_CIRCLE)
+    {
+        return geofence_in_circle(zone, lat, lon);
+    }
+    return geofence_in_polygon(zone, lat, lon);
+}
+
+/* 坐标在网格某一维上的格子序号，调用前已确认在外接矩形内 */
+static rt_uint32_t geofence_cell_axis(rt_int32_t value, rt_int32_t min, rt_uint32_t span)
+{
+    return (rt_uint32_t)(((rt_uint64_t)((rt_int64_t)value - min) * GEOFENCE_GRID_DIM) / ((rt_uint64_t)span + 1));
+}
+
+/* 点所在的格子，不在任何区域的外接矩形范围内时返回 -1 */
+static int geofence_cell_of(const geofence_index_t *index, rt_int32_t lat, rt_int32_t lon)
+{
+    rt_int64_t dlat = (rt_int64_t)lat - index->min_lat;
+    rt_int64_t dlon = (rt_int64_t)lon - index->min_lon;
+
+    if (dlat < 0 || dlon < 0 || dlat > index->span_lat || dlon > index->span_lon)
+    {
+        return -1;
+    }
+    return geofence_cell_axis(lat, index->min_lat, index->span_lat) * GEOFENCE_GRID_DIM
+           + geofence_cell_axis(lon, index->min_lon, index->span_lon);
+}
+
+/* 从区域表解析一个区域并计算外接矩形 */
+static rt_err_t geofence_parse_zone(geofence_zone_t *zone, const rt_uint32_t *rec,
+                                    const rt_int32_t *vertices, rt_uint32_t vertex_count)
+{
+    zone->type = rec[0] >> 24;
+    zone->kind = (rec[0] >> 16) & 0xFF;
+    zone->id = rec[0] & 0xFFFF;
+
+    if (zone->kind != GEOFENCE_KIND_ALLOWED && zone->kind != GEOFENCE_KIND_HAZARD)
+    {
+        return -RT_EINVAL;
+    }
+
+    if (zone->type == GEOFENCE_TYPE_CIRCLE)
+    {
+        rt_uint32_t dlat, dlon;
+
+        zone->lat = (rt_int32_t)rec[1];
+        zone->lon = (rt_int32_t)rec[2];
+        if (rec[3] == 0 || rec[3] > 100000 || zone->lat < -85 * GEOFENCE_DEG_E7 || zone->lat > 85 * GEOFENCE_DEG_E7)
+        {
+            return -RT_EINVAL;
+        }
+        zone->radius_cm = rec[3] * 100;
+        zone->cos_q15 = geofence_cos_q15(zone->lat);
+
+        /* 半径换算为度数，经度方向按余弦放大，各加 1 防止截断 */
+        dlat = (rt_uint32_t)((rt_uint64_t)zone->radius_cm * GEOFENCE_CM_PER_E7_DEN / GEOFENCE_CM_PER_E7_NUM) + 1;
+        dlon = (rt_uint32_t)((rt_uint64_t)dlat * 32768 / zone->cos_q15) + 1;
+        zone->min_lat = zone->lat - dlat;
+        zone->max_lat = zone->lat + dlat;
+        zone->min_lon = zone->lon - dlon;
+        zone->max_lon = zone->lon + dlon;
+    }
+    else if (zone->type == GEOFENCE_TYPE_POLYGON)
+    {
+        rt_uint32_t first = rec[1];
+
+        zone->count = rec[2];
+        if (zone->count < 3 || first > vertex_count || zone->count > vertex_count - first)
+        {
+            return -RT_EINVAL;
+        }
+        zone->vertices = &vertices[2 * first];
+        zone->min_lat = zone->max_lat = zone->vertices[0];
+        zone->min_lon = zone->max_lon = zone->vertices[1];
+        for (rt_uint32_t i = 1; i < zone->count; i++)
+        {
+            rt_int32_t lat = zone->vertices[2 * i], lon = zone->vertices[2 * i + 1];
+
+            if (lat < zone->min_lat) zone->min_lat = lat;
+            if (lat > zone->max_lat) zone->max_lat = lat;
+            if (lon < zone->min_lon) zone->min_lon = lon;
+            if (lon > zone->max_lon) zone->max_lon = lon;
+        }
+    }
+    else
+    {
+        return -RT_EINVAL;
+    }
+
+    /* 跨度不超过 180 度，坐标差保持在 int32 内 */
+    if ((rt_int64_t)zone->max_lat - zone->min_lat > 180 * GEOFENCE_DEG_E7 ||
+        (rt_int64_t)zone->max_lon - zone->min_lon > 180 * GEOFENCE_DEG_E7)
+    {
+        return -RT_EINVAL;
+    }
+    return RT_EOK;
+}
+
+/* 释放索引 */
+static void geofence_index_free(geofence_index_t *index)
+{
+    if (index != RT_NULL)
+    {
+        rt_free(index->cell_items);
+        rt_free(index->zones);
+        rt_free(index);
+    }
+}
+
+/* 解析区域表并建立网格索引 */
+static rt_err_t geofence_build(const rt_uint32_t *blob, rt_size_t size, geofence_index_t **out)
+{
+    rt_uint32_t zone_count, vertex_count;
+    const rt_uint32_t *records;
+    const rt_int32_t *vertices;
+    geofence_index_t *index;
+    rt_int32_t max_lat = 0, max_lon = 0;
+    rt_uint32_t total = 0;
+    rt_uint16_t fill[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM];
+
+    if (size < 16 || ((rt_ubase_t)blob & 3) || blob[0] != GEOFENCE_MAGIC)
+    {
+        return -RT_EINVAL;
+    }
+    zone_count = blob[1];
+    vertex_count = blob[2];
+    if (zone_count == 0 || zone_count > 0xFFFF || vertex_count > 0xFFFF ||
+        size < 16 + zone_count * 16 + vertex_count * 8)
+    {
+        return -RT_EINVAL;
+    }
+    records = &blob[4];
+    vertices = (const rt_int32_t *)&blob[4 + zone_count * 4];
+
+    index = rt_calloc(1, sizeof(*index));
+    if (index == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    index->zones = rt_calloc(zone_count, sizeof(geofence_zone_t));
+    if (index->zones == RT_NULL)
+    {
+        geofence_index_free(index);
+        return -RT_ENOMEM;
+    }
+    index->zone_count = zone_count;
+
+    for (rt_uint32_t i = 0; i < zone_count; i++)
+    {
+        geofence_zone_t *zone = &index->zones[i];
+
+        if (geofence_parse_zone(zone, &records[i * 4], vertices, vertex_count) != RT_EOK)
+        {
+            rt_kprintf("[GEOFENCE] zone #%d is malformed\n", i);
+            geofence_index_free(index);
+            return -RT_EINVAL;
+        }
+        if (i == 0 || zone->min_lat < index->min_lat) index->min_lat = zone->min_lat;
+        if (i == 0 || zone->min_lon < index->min_lon) index->min_lon = zone->min_lon;
+        if (i == 0 || zone->max_lat > max_lat) max_lat = zone->max_lat;
+        if (i == 0 || zone->max_lon > max_lon) max_lon = zone->max_lon;
+    }
+    index->span_lat = (rt_uint32_t)((rt_int64_t)max_lat - index->min_lat);
+    index->span_lon = (rt_uint32_t)((rt_int64_t)max_lon - index->min_lon);
+
+    /* 第一遍：统计每个格子内的区域数 */
+    rt_memset(fill, 0, sizeof(fill));
+    for (rt_uint32_t i = 0; i < zone_count; i++)
+    {
+        const geofence_zone_t *zone = &index->zones[i];
+        rt_uint32_t r0 = geofence_cell_axis(zone->min_lat, index->min_lat, index->span_lat);
+        rt_uint32_t r1 = geofence_cell_axis(zone->max_lat, index->min_lat, index->span_lat);
+        rt_uint32_t c0 = geofence_cell_axis(zone->min_lon, index->min_lon, index->span_lon);
+        rt_uint32_t c1 = geofence_cell_axis(zone->max_lon, index->min_lon, index->span_lon);
+
+        for (rt_uint32_t r = r0; r <= r1; r++)
+        {
+            for (rt_uint32_t c = c0; c <= c1; c++)
+            {
+                fill[r * GEOFENCE_GRID_DIM + c]++;
+            }
+        }
+        total += (r1 - r0 + 1) * (c1 - c0 + 1);
+    }
+    if (total > 0xFFFF)
+    {
+        geofence_index_free(index);
+        return -RT_EINVAL;
+    }
+    for (rt_uint32_t c = 0; c < GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM; c++)
+    {
+        index->cell_start[c + 1] = index->cell_start[c] + fill[c];
+        fill[c] = index->cell_start[c];
+    }
+
+    /* 第二遍：填入区域下标 */
+    index->cell_items = rt_malloc(total * sizeof(rt_uint16_t));
+    if (index->cell_items == RT_NULL)
+    {
+        geofence_index_free(index);
+        return -RT_ENOMEM;
+    }
+    for (rt_uint32_t i = 0; i < zone_count; i++)
+    {
+        const geofence_zone_t *zone = &index->zones[i];
+        rt_uint32_t r0 = geofence_cell_axis(zone->min_lat, index->min_lat, index->span_lat);
+        rt_uint32_t r1 = geofence_cell_axis(zone->max_lat, index->min_lat, index->span_lat);
+        rt_uint32_t c0 = geofence_cell_axis(zone->min_lon, index->min_lon, index->span_lon);
+        rt_uint32_t c1 = geofence_cell_axis(zone->max_lon, index->min_lon, index->span_lon);
+
+        for (rt_uint32_t r = r0; r <= r1; r++)
+        {
+            for (rt_uint32_t c = c0; c <= c1; c++)
+            {
+                index->cell_items[fill[r * GEOFENCE_GRID_DIM + c]++] = i;
+            }
+        }
+    }
+
+    *out = index;
+    return RT_EOK;
+}
+
+/**
+ * @brief   加载区域表并建立网格索引
+ */
+rt_err_t geofence_load(const void *blob, rt_size_t size)
+{
+    geofence_index_t *index = RT_NULL;
+    geofence_index_t *old;
+    rt_err_t ret;
+
+    if (!geofence_lock_ready)
+    {
+        rt_mutex_init(&geofence_lock, "geofence", RT_IPC_FLAG_PRIO);
+        geofence_lock_ready = RT_TRUE;
+    }
+
+    ret = geofence_build(blob, size, &index);
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("[GEOFENCE] load failed: %d\n", ret);
+        return ret;
+    }
+
+    /* 换表后所有区域重新从"不在区域内"开始 */
+    rt_mutex_take(&geofence_lock, RT_WAITING_FOREVER);
+    old = geofence_index;
+    geofence_index = index;
+    geofence_active_count = 0;
+    rt_mutex_release(&geofence_lock);
+    geofence_index_free(old);
+
+    rt_kprintf("[GEOFENCE] %d zones loaded, %d index entries\n",
+               index->zone_count, index->cell_start[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM]);
+    return RT_EOK;
+}
+
+/**
+ * @brief   设置进出事件回调
+ */
+void geofence_set_handler(geofence_handler_t handler)
+{
+    geofence_handler = handler;
+}
+
+/* 产生进出事件 */
+static void geofence_emit(const geofence_zone_t *zone, rt_bool_t entered,
+                          rt_int32_t lat, rt_int32_t lon, rt_uint32_t time)
+{
+    geofence_event_t event;
+
+    geofence_stats.events++;
+    if (geofence_handler == RT_NULL)
+    {
+        return;
+    }
+
+    event.zone_id = zone->id;
+    event.kind = zone->kind;
+    event.entered = entered;
+    event.latitude = lat;
+    event.longitude = lon;
+    event.time = time;
+    geofence_handler(&event);
+}
+
+/* 下标是否在列表中 */
+static rt_bool_t geofence_listed(const rt_uint16_t *list, rt_uint8_t count, rt_uint16_t item)
+{
+    for (rt_uint8_t i = 0; i < count; i++)
+    {
+        if (list[i] == item)
+        {
+            return RT_TRUE;
+        }
+    }
+    return RT_FALSE;
+}
+
+/**
+ * @brief   用一次新定位更新各区域状态
+ */
+void geofence_update(rt_int32_t latitude, rt_int32_t longitude, rt_uint32_t time)
+{
+    const geofence_index_t *index;
+    rt_uint16_t inside[GEOFENCE_MAX_ACTIVE];
+    rt_uint8_t inside_count = 0;
+    rt_uint32_t start = dwt_get_cycles();
+    rt_uint32_t cycles;
+    int cell;
+
+    if (!geofence_lock_ready)
+    {
+        return;
+    }
+    rt_mutex_take(&geofence_lock, RT_WAITING_FOREVER);
+    index = geofence_index;
+    if (index == RT_NULL)
+    {
+        rt_mutex_release(&geofence_lock);
+        return;
+    }
+    geofence_stats.updates++;
+
+    /* 只精确判断所在格子里的区域，其余区域的外接矩形不覆盖该点 */
+    cell = geofence_cell_of(index, latitude, longitude);
+    if (cell >= 0)
+    {
+        for (rt_uint16_t k = index->cell_start[cell]; k < index->cell_start[cell + 1]; k++)
+        {
+            rt_uint16_t item = index->cell_items[k];
+
+            geofence_stats.zone_tests++;
+            if (geofence_zone_contains(&index->zones[item], latitude, longitude))
+            {
+                if (inside_count < GEOFENCE_MAX_ACTIVE)
+                {
+                    inside[inside_count++] = item;
+                }
+                else
+                {
+                    geofence_stats.overflows++;
+                }
+            }
+        }
+    }
+
+    for (rt_uint8_t i = 0; i < geofence_active_count; i++)
+    {
+        if (!geofence_listed(inside, inside_count, geofence_active[i]))
+        {
+            geofence_emit(&index->zones[geofence_active[i]], RT_FALSE, latitude, longitude, time);
+        }
+    }
+    for (rt_uint8_t i = 0; i < inside_count; i++)
+    {
+        if (!geofence_listed(geofence_active, geofence_active_count, inside[i]))
+        {
+            geofence_emit(&index->zones[inside[i]], RT_TRUE, latitude, longitude, time);
+        }
+    }
+    rt_memcpy(geofence_active, inside, inside_count * sizeof(inside[0]));
+    geofence_active_count = inside_count;
+
+    cycles = dwt_get_cycles() - start;
+    if (cycles > geofence_stats.max_cycles)
+    {
+        geofence_stats.max_cycles = cycles;
+    }
+    rt_mutex_release(&geofence_lock);
+}
+
+/**
+ * @brief   查询某点是否在指定区域内
+ */
+int geofence_contains(rt_uint16_t zone_id, rt_int32_t latitude, rt_int32_t longitude)
+{
+    int result = -1;
+
+    if (!geofence_lock_ready)
+    {
+        return -1;
+    }
+    rt_mutex_take(&geofence_lock, RT_WAITING_FOREVER);
+    if (geofence_index != RT_NULL)
+    {
+        for (rt_uint16_t i = 0; i < geofence_index->zone_count; i++)
+        {
+            if (geofence_index->zones[i].id == zone_id)
+            {
+                result = geofence_zone_contains(&geofence_index->zones[i], latitude, longitude);
+                break;
+            }
+        }
+    }
+    rt_mutex_release(&geofence_lock);
+
+    return result;
+}
+
+/**
+ * @brief   启动时加载内置区域表
+ */
+static int geofence_init(void)
+{
+    return geofence_load(geofence_default_blob, geofence_default_blob_size) == RT_EOK ? 0 : -1;
+}
+INIT_APP_EXPORT(geofence_init);
+
+/**
+ * @brief   打印电子围栏统计
+ */
+static int geofence_stat(int argc, char *argv[])
+{
+    const geofence_index_t *index;
+    rt_uint32_t busy = 0, max_cell = 0;
+
+    if (!geofence_lock_ready || geofence_index == RT_NULL)
+    {
+        rt_kprintf("[GEOFENCE] no zones loaded\n");
+        return -1;
+    }
+    rt_mutex_take(&geofence_lock, RT_WAITING_FOREVER);
+    index = geofence_index;
+    for (rt_uint32_t c = 0; c < GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM; c++)
+    {
+        rt_uint32_t n = index->cell_start[c + 1] - index->cell_start[c];
+
+        busy += (n > 0);
+        if (n > max_cell)
+        {
+            max_cell = n;
+        }
+    }
+
+    rt_kprintf("[GEOFENCE] zones: %d, cells used: %d/%d, max zones per cell: %d\n",
+               index->zone_count, busy, GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM, max_cell);
+    rt_kprintf("[GEOFENCE] updates: %d, zone tests: %d, events: %d, overflows: %d, inside now: %d\n",
+               geofence_stats.updates, geofence_stats.zone_tests, geofence_stats.events,
+               geofence_stats.overflows, geofence_active_count);
+    rt_kprintf("[GEOFENCE] worst update: %d us\n", dwt_cycles_to_us(geofence_stats.max_cycles));
+    rt_mutex_release(&geofence_lock);
+    return 0;
+}
+MSH_CMD_EXPORT(geofence_stat, show geofence index and update statistics);
+
+/**
+ * @brief   检查一个点所在的区域，网格索引结果与逐个判断对比：geofence_check <纬度e7> <经度e7>
+ */
+static int geofence_check(int argc, char *argv[])
+{
+    const geofence_index_t *index;
+    rt_int32_t lat, lon;
+    rt_uint32_t indexed = 0, brute = 0;
+    int cell;
+
+    if (argc < 3 || !geofence_lock_ready || geofence_index == RT_NULL)
+    {
+        rt_kprintf("Usage: geofence_check <lat_e7> <lon_e7>\n");
+        return -1;
+    }
+    lat = atol(argv[1]);
+    lon = atol(argv[2]);
+
+    rt_mutex_take(&geofence_lock, RT_WAITING_FOREVER);
+    index = geofence_index;
+
+    cell = geofence_cell_of(index, lat, lon);
+    if (cell >= 0)
+    {
+        for (rt_uint16_t k = index->cell_start[cell]; k < index->cell_start[cell + 1]; k++)
+        {
+            const geofence_zone_t *zone = &index->zones[index->cell_items[k]];
+
+            if (geofence_zone_contains(zone, lat, lon))
+            {
+                rt_kprintf("[GEOFENCE] inside zone %d (%s)\n", zone->id,
+                           zone->kind == GEOFENCE_KIND_HAZARD ? "hazard" : "allowed");
+                indexed++;
+            }
+        }
+    }
+    for (rt_uint16_t i = 0; i < index->zone_count; i++)
+    {
+        brute += geofence_zone_contains(&index->zones[i], lat, lon);
+    }
+    rt_mutex_release(&geofence_lock);
+
+    rt_kprintf("[GEOFENCE] cell %d: %d zones by index, %d by full scan%s\n",
+               cell, indexed, brute, indexed == brute ? "" : " (MISMATCH)");
+    return indexed == brute ? 0 : -1;
+}
+MSH_CMD_EXPORT(geofence_check, check which geofence zones contain a point);
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         电子围栏：二进制区域表、网格索引、进出事件
+ */
+
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include <rtthread.h>
+
+/*
+ * 区域表二进制格式（全部为 32 位小端字，4 字节对齐，可直接放在 Flash 中）：
+ *
+ *   头部    magic, zone_count, vertex_count, 保留
+ *   区域    每个 4 个字：(type << 24) | (kind << 16) | id, p0, p1, p2
+ *           圆形  p0 = 圆心纬度, p1 = 圆心经度, p2 = 半径（米）
+ *           多边形 p0 = 首顶点下标, p1 = 顶点数, p2 = 0
+ *   顶点    每个 2 个字：纬度, 经度
+ *
+ * 坐标单位与 gps_fix_t 相同：1e-7 度，南纬/西经为负。
+ * 单个区域的跨度必须小于 180 度，保证坐标差不超出 int32。
+ */
+#define GEOFENCE_MAGIC          0x314E4647  /* "GFN1" */
+
+#define GEOFENCE_TYPE_CIRCLE    1
+#define GEOFENCE_TYPE_POLYGON   2
+
+/* 区域性质：允许区离开时报警，危险区进入时报警 */
+#define GEOFENCE_KIND_ALLOWED   1
+#define GEOFENCE_KIND_HAZARD    2
+
+/* 在源码中书写区域表的辅助宏 */
+#define GEOFENCE_BLOB_HEADER(zones, vertices) \
+    GEOFENCE_MAGIC, (zones), (vertices), 0
+#define GEOFENCE_CIRCLE(id, kind, lat, lon, radius_m) \
+    (((rt_uint32_t)GEOFENCE_TYPE_CIRCLE << 24) | ((rt_uint32_t)(kind) << 16) | (id)), \
+    (rt_uint32_t)(lat), (rt_uint32_t)(lon), (radius_m)
+#define GEOFENCE_POLYGON(id, kind, first, count) \
+    (((rt_uint32_t)GEOFENCE_TYPE_POLYGON << 24) | ((rt_uint32_t)(kind) << 16) | (id)), \
+    (first), (count), 0
+#define GEOFENCE_VERTEX(lat, lon) \
+    (rt_uint32_t)(lat), (rt_uint32_t)(lon)
+
+/* 网格索引每个方向的格子数 */
+#define GEOFENCE_GRID_DIM       16
+/* 同时处于其中的区域数上限 */
+#define GEOFENCE_MAX_ACTIVE     8
+
+/* 进出事件 */
+typedef struct
+{
+    rt_uint16_t zone_id;        /* 区域编号 */
+    rt_uint8_t kind;            /* GEOFENCE_KIND_xxx */
+    rt_uint8_t entered;         /* 1 进入，0 离开 */
+    rt_int32_t latitude;        /* 触发时的位置，1e-7 度 */
+    rt_int32_t longitude;
+    rt_uint32_t time;           /* 触发时的 UTC 时间 hhmmss */
+} geofence_event_t;
+
+/* 事件回调，在 GPS 线程中调用，不能阻塞 */
+typedef void (*geofence_handler_t)(const geofence_event_t *event);
+
+/* 内置区域表（geofence_zones.c） */
+extern const rt_uint32_t geofence_default_blob[];
+extern const rt_size_t geofence_default_blob_size;
+
+/**
+ * @brief   加载区域表并建立网格索引，替换之前加载的区域表
+ * @param   blob 区域表，加载后仍直接引用其中的顶点，必须一直有效（Flash 常量）
+ * @param   size 区域表字节数
+ * @return  RT_EOK 成功，-RT_EINVAL 格式错误，-RT_ENOMEM 内存不足
+ */
+rt_err_t geofence_load(const void *blob, rt_size_t size);
+
+/**
+ * @brief   设置进出事件回调
+ */
+void geofence_set_handler(geofence_handler_t handler);
+
+/**
+ * @brief   用一次新定位更新各区域状态，发生进出时调用事件回调
+ * @param   latitude  纬度，1e-7 度
+ * @param   longitude 经度，1e-7 度
+ * @param   time      UTC 时间 hhmmss，填入事件
+ * @note    只检查所在网格内的区域，耗时与该格内的区域数成正比
+ */
+void geofence_update(rt_int32_t latitude, rt_int32_t longitude, rt_uint32_t time);
+
+/**
+ * @brief   查询某点是否在指定区域内（不改变状态）
+ * @return  1 在区域内，0 不在，-1 区域不存在
+ */
+int geofence_contains(rt_uint16_t zone_id, rt_int32_t latitude, rt_int32_t longitude);
+
+#endif /* GEOFENCE_H */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         内置电子围栏区域表
+ */
+
+#include "geofence.h"
+
+/*
+ * 内置区域表（示例工地），常量放在 Flash 中，加载时不复制顶点。
+ * 部署到具体工地时按 geofence.h 中的格式替换本表。
+ */
+const rt_uint32_t geofence_default_blob[] =
+{
+    GEOFENCE_BLOB_HEADER(4, 9),
+
+    /* 区域 */
+    GEOFENCE_POLYGON(1, GEOFENCE_KIND_ALLOWED, 0, 5),                       /* 施工区范围 */
+    GEOFENCE_POLYGON(2, GEOFENCE_KIND_HAZARD, 5, 4),                        /* 基坑 */
+    GEOFENCE_CIRCLE(3, GEOFENCE_KIND_HAZARD, 318465000, 1214697000, 30),    /* 塔吊回转半径 */
+    GEOFENCE_CIRCLE(4, GEOFENCE_KIND_HAZARD, 318458000, 1214686000, 15),    /* 配电房 */
+
+    /* 顶点：施工区 */
+    GEOFENCE_VERTEX(318470000, 1214680000),
+    GEOFENCE_VERTEX(318472000, 1214702000),
+    GEOFENCE_VERTEX(318460000, 1214708000),
+    GEOFENCE_VERTEX(318452000, 1214694000),
+    GEOFENCE_VERTEX(318455000, 1214679000),
+
+    /* 顶点：基坑 */
+    GEOFENCE_VERTEX(318463000, 1214688000),
+    GEOFENCE_VERTEX(318464000, 1214693000),
+    GEOFENCE_VERTEX(318460000, 1214694000),
+    GEOFENCE_VERTEX(318459000, 1214689000),
+};
+
+const rt_size_t geofence_default_blob_size = sizeof(geofence_default_blob);
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         ATGM336H 运行时配置：波特率、更新率、语句过滤
+ */
+
+#include "gps_config.h"
+#include "ATGM336H_app.h"
+#include <stdarg.h>
+
+/* 每个模式的更新周期、GSV 输出分频和定位周期完成所需的语句 */
+typedef struct
+{
+    rt_uint16_t interval_ms;    /* 定位更新周期 */
+    rt_uint8_t gsv_divider;     /* 每 n 个定位周期输出一组 GSV */
+    rt_uint8_t epoch_mask;      /* 每个周期都会输出的语句 */
+} gps_mode_cfg_t;
+
+/* 高更新率时 GSV 降到 1 Hz，不再作为周期完成的条件 */
+static const gps_mode_cfg_t gps_mode_table[GPS_MODE_MAX] =
+{
+    [GPS_MODE_ECO]    = { 1000, 1,  GPS_SENTENCE_ALL },
+    [GPS_MODE_NORMAL] = { 200,  5,  GPS_SENTENCE_ALL & ~GPS_SENTENCE_GSV },
+    [GPS_MODE_FAST]   = { 100,  10, GPS_SENTENCE_ALL & ~GPS_SENTENCE_GSV },
+};
+
+static const char *const gps_mode_names[GPS_MODE_MAX] = { "eco", "normal", "fast" };
+
+/* PCAS01 波特率编码，下标即命令参数 */
+static const rt_uint32_t gps_pcas01_bauds[] = { 4800, 9600, 19200, 38400, 57600, 115200 };
+
+/* 自动探测时依次尝试的波特率，出厂波特率优先 */
+static const rt_uint32_t gps_probe_bauds[] = { GPS_DEFAULT_BAUD, GPS_CONFIG_BAUD, 38400, 57600, 19200, 4800 };
+
+#define GPS_PROBE_MS            1200    /* 判断链路是否正常的接收窗口 */
+#define GPS_PROBE_MIN_SENTENCES 2       /* 窗口内至少收到的有效语句数 */
+#define GPS_SETTLE_MS           300     /* 等待命令生效、旧配置的语句排空 */
+#define GPS_DRAIN_MS            20      /* 改本端波特率前等待命令最后几个字节发完 */
+#define GPS_RATE_WINDOW_MS      2000    /* 测量更新率的窗口 */
+#define GPS_CONFIG_RETRY        2       /* 每项设置最多发送次数 */
+#define GPS_CMD_BUFSZ           80
+
+/* 每个定位周期输出的字节数估计（RMC+GGA+多条GSA+VTG），用于检查串口带宽 */
+#define GPS_EPOCH_BYTES         400
+
+static gps_mode_t gps_current_mode = GPS_MODE_ECO;  /* 模块出厂为 1 Hz */
+
+/**
+ * @brief   生成带校验和的 CASIC 命令
+ */
+rt_size_t gps_pcas_build(char *buf, rt_size_t size, const char *body)
+{
+    rt_uint8_t checksum = 0;
+    rt_size_t len = rt_strlen(body);
+
+    /* '$' + body + "*hh\r\n" + '\0' */
+    if (len + 7 > size)
+    {
+        return 0;
+    }
+    for (const char *p = body; *p; p++)
+    {
+        checksum ^= (rt_uint8_t)*p;
+    }
+
+    return rt_snprintf(buf, size, "$%s*%02X\r\n", body, checksum);
+}
+
+/* 格式化命令内容并补上校验和后发送 */
+static rt_err_t gps_pcas_send(const char *fmt, ...)
+{
+    char body[GPS_CMD_BUFSZ];
+    char cmd[GPS_CMD_BUFSZ + 8];
+    va_list args;
+    rt_size_t len;
+
+    va_start(args, fmt);
+    rt_vsnprintf(body, sizeof(body), fmt, args);
+    va_end(args);
+
+    len = gps_pcas_build(cmd, sizeof(cmd), body);
+    if (len == 0)
+    {
+        return -RT_EFULL;
+    }
+    return gps_uart_send(cmd, len);
+}
+
+/* 在当前波特率下接收一段时间，有效语句足够且错误不多于有效语句则认为链路正常 */
+static rt_bool_t gps_link_ok(rt_int32_t ms)
+{
+    gps_counters_t before, after;
+    rt_uint32_t good, bad;
+
+    gps_get_counters(&before);
+    gps_uart_pump(ms);
+    gps_get_counters(&after);
+
+    good = after.sentences - before.sentences;
+    bad = after.errors - before.errors;
+    return good >= GPS_PROBE_MIN_SENTENCES && bad <= good;
+}
+
+/* 依次尝试常用波特率，找到模块当前的输出波特率 */
+static rt_err_t gps_autodetect(void)
+{
+    for (rt_size_t i = 0; i < sizeof(gps_probe_bauds) / sizeof(gps_probe_bauds[0]); i++)
+    {
+        gps_uart_set_baud(gps_probe_bauds[i]);
+        if (gps_link_ok(GPS_PROBE_MS))
+        {
+            rt_kprintf("[GPS] module detected at %d baud\n", gps_probe_bauds[i]);
+            return RT_EOK;
+        }
+    }
+
+    rt_kprintf("[GPS] no NMEA output at any baud rate\n");
+    gps_uart_set_baud(GPS_DEFAULT_BAUD);
+    return -RT_ETIMEOUT;
+}
+
+/* 让模块和 uart2 同时切换到指定波特率，失败时自动探测模块实际所在的波特率 */
+static rt_err_t gps_config_baud(rt_uint32_t baud)
+{
+    rt_size_t code;
+
+    if (gps_uart_get_baud() == baud)
+    {
+        return RT_EOK;
+    }
+    for (code = 0; code < sizeof(gps_pcas01_bauds) / sizeof(gps_pcas01_bauds[0]); code++)
+    {
+        if (gps_pcas01_bauds[code] == baud)
+        {
+            break;
+        }
+    }
+    if (code == sizeof(gps_pcas01_bauds) / sizeof(gps_pcas01_bauds[0]))
+    {
+        return -RT_EINVAL;
+    }
+
+    for (rt_uint8_t retry = 0; retry < GPS_CONFIG_RETRY; retry++)
+    {
+        gps_pcas_send("PCAS01,%d", code);
+        rt_thread_mdelay(GPS_DRAIN_MS);
+        gps_uart_set_baud(baud);
+        gps_uart_pump(GPS_SETTLE_MS);
+        if (gps_link_ok(GPS_PROBE_MS))
+        {
+            return RT_EOK;
+        }
+
+        rt_kprintf("[GPS] module did not switch to %d baud, autodetecting\n", baud);
+        if (gps_autodetect() != RT_EOK)
+        {
+            return -RT_ETIMEOUT;
+        }
+    }
+
+    return -RT_ERROR;
+}
+
+/* 只输出解析器使用的语句：验证窗口内不再出现未解码的语句 */
+static rt_err_t gps_config_sentences(const gps_mode_cfg_t *cfg)
+{
+    gps_counters_t before, after;
+
+    for (rt_uint8_t retry = 0; retry < GPS_CONFIG_RETRY; retry++)
+    {
+        /* GGA,GLL,GSA,GSV,RMC,VTG,ZDA,ANT,DHV,LPS,,,UTC,GST,,,,TIM */
+        gps_pcas_send("PCAS03,1,0,1,%d,1,1,0,0,0,0,,,0,0,,,,0", cfg->gsv_divider);
+        gps_uart_pump(GPS_SETTLE_MS);
+
+        gps_get_counters(&before);
+        gps_uart_pump(GPS_PROBE_MS);
+        gps_get_counters(&after);
+        if (after.sentences != before.sentences && after.ignored == before.ignored)
+        {
+            return RT_EOK;
+        }
+    }
+
+    rt_kprintf("[GPS] sentence filter not accepted, %d unused sentences in %d ms\n",
+               after.ignored - before.ignored, GPS_PROBE_MS);
+    return -RT_ERROR;
+}
+
+/* 设置定位更新周期：验证窗口内发布的定位记录数与期望值相差不超过 1/4 */
+static rt_err_t gps_config_rate(const gps_mode_cfg_t *cfg)
+{
+    rt_uint32_t expected = GPS_RATE_WINDOW_MS / cfg->interval_ms;
+    gps_counters_t before, after;
+    rt_uint32_t fixes = 0;
+
+    for (rt_uint8_t retry = 0; retry < GPS_CONFIG_RETRY; retry++)
+    {
+        gps_pcas_send("PCAS02,%d", cfg->interval_ms);
+        gps_uart_pump(GPS_SETTLE_MS);
+
+        gps_get_counters(&before);
+        gps_uart_pump(GPS_RATE_WINDOW_MS);
+        gps_get_counters(&after);
+        fixes = after.fixes - before.fixes;
+        if (fixes * 4 >= expected * 3 && fixes * 4 <= expected * 5 + 4)
+        {
+            return RT_EOK;
+        }
+    }
+
+    rt_kprintf("[GPS] update rate not accepted, %d fixes in %d ms, expected %d\n",
+               fixes, GPS_RATE_WINDOW_MS, expected);
+    return -RT_ERROR;
+}
+
+/* 串口带宽是否足够该模式的输出量（留 1/4 余量） */
+static rt_bool_t gps_mode_fits(gps_mode_t mode, rt_uint32_t baud)
+{
+    rt_uint32_t load = GPS_EPOCH_BYTES * 1000 / gps_mode_table[mode].interval_ms;
+
+    return load * 4 <= (baud / 10) * 3;
+}
+
+/**
+ * @brief   按模式配置GPS模块
+ */
+rt_err_t gps_config_apply(gps_mode_t mode)
+{
+    const gps_mode_cfg_t *cfg;
+    rt_err_t result = RT_EOK;
+
+    if (mode >= GPS_MODE_MAX)
+    {
+        return -RT_EINVAL;
+    }
+
+    /* MCU 单独复位时模块可能还保持着上次的波特率，先确认当前链路 */
+    if (!gps_link_ok(GPS_PROBE_MS) && gps_autodetect() != RT_EOK)
+    {
+        return -RT_ETIMEOUT;
+    }
+
+    if (gps_config_baud(GPS_CONFIG_BAUD) != RT_EOK)
+    {
+        result = -RT_ERROR;
+    }
+
+    /* 回退到低波特率时带宽不够，逐级降低更新率 */
+    while (mode > GPS_MODE_ECO && !gps_mode_fits(mode, gps_uart_get_baud()))
+    {
+        mode = (gps_mode_t)(mode - 1);
+    }
+    cfg = &gps_mode_table[mode];
+
+    gps_set_epoch_mask(cfg->epoch_mask);
+    if (gps_config_sentences(cfg) != RT_EOK)
+    {
+        result = -RT_ERROR;
+    }
+    if (gps_config_rate(cfg) != RT_EOK)
+    {
+        result = -RT_ERROR;
+    }
+    gps_current_mode = mode;
+
+    rt_kprintf("[GPS] mode %s: %d baud, %d ms update interval%s\n",
+               gps_mode_names[mode], gps_uart_get_baud(), cfg->interval_ms,
+               result == RT_EOK ? "" : " (partially applied)");
+    return result;
+}
+
+/**
+ * @brief   当前生效的工作模式
+ */
+gps_mode_t gps_config_mode(void)
+{
+    return gps_current_mode;
+}
+
+/**
+ * @brief   查看或切换GPS工作模式：gps_mode [eco|normal|fast]
+ */
+static int gps_mode(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        rt_kprintf("[GPS] mode %s, %d baud\n", gps_mode_names[gps_current_mode], gps_uart_get_baud());
+        return 0;
+    }
+
+    for (int i = 0; i < GPS_MODE_MAX; i++)
+    {
+        if (rt_strcmp(argv[1], gps_mode_names[i]) == 0)
+        {
+            return gps_request_mode((gps_mode_t)i) == RT_EOK ? 0 : -1;
+        }
+    }
+
+    rt_kprintf("Usage: gps_mode [eco|normal|fast]\n");
+    return -1;
+}
+MSH_CMD_EXPORT(gps_mode, show or switch GPS update mode: eco 1Hz / normal 5Hz / fast 10Hz);
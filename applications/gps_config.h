@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         ATGM336H 运行时配置：波特率、更新率、语句过滤
+ */
+
+#ifndef GPS_CONFIG_H
+#define GPS_CONFIG_H
+
+#include <rtthread.h>
+
+/* 模块出厂波特率，配置失败时回退到该波特率重新探测 */
+#define GPS_DEFAULT_BAUD        9600
+/* 配置后的工作波特率 */
+#define GPS_CONFIG_BAUD         115200
+
+/* 工作模式：决定定位更新率和输出的语句 */
+typedef enum
+{
+    GPS_MODE_ECO = 0,           /* 1 Hz，静止或低功耗 */
+    GPS_MODE_NORMAL,            /* 5 Hz，步行 */
+    GPS_MODE_FAST,              /* 10 Hz，骑行 */
+    GPS_MODE_MAX
+} gps_mode_t;
+
+/* 上电默认模式 */
+#define GPS_MODE_DEFAULT        GPS_MODE_NORMAL
+
+/**
+ * @brief   按模式配置GPS模块：切换到工作波特率，设置更新率和语句输出，
+ *          每一步都用实际收到的语句验证，失败时回退到出厂波特率自动探测
+ * @param   mode 工作模式
+ * @return  RT_EOK 全部生效；-RT_ETIMEOUT 模块无输出；-RT_ERROR 部分设置未生效
+ * @note    会阻塞数秒且直接读取GPS串口，只能在GPS线程中调用
+ */
+rt_err_t gps_config_apply(gps_mode_t mode);
+
+/**
+ * @brief   当前生效的工作模式
+ */
+gps_mode_t gps_config_mode(void);
+
+/**
+ * @brief   生成带校验和的 CASIC 命令："$<body>*hh\r\n"
+ * @param   buf  输出缓冲区
+ * @param   size 缓冲区大小
+ * @param   body '$' 与 '*' 之间的内容，如 "PCAS02,200"
+ * @return  命令长度，缓冲区不足时返回 0
+ */
+rt_size_t gps_pcas_build(char *buf, rt_size_t size, const char *body);
+
+#endif /* GPS_CONFIG_H */
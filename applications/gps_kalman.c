@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 轨迹常速度卡尔曼滤波
+ */
+
+#include "gps_kalman.h"
+#include "snapshot.h"
+#include "drv_dwt.h"
+#include <math.h>
+
+/*
+ * 状态在以首个定位为原点的局部东北天（ENU）平面内表示，单位米。
+ * 东、北两个方向各自是独立的 [位置, 速度] 常速度模型，协方差只有
+ * 3 个独立元素，每次更新只有几十次单精度乘加，不需要三角函数；
+ * 只有设置原点时计算一次经度方向的米/度比例。
+ */
+
+/* 纬度 1e-7 度对应的米数 */
+#define GPS_KF_M_PER_E7         0.0111319f
+/* 用户等效测距误差（米），量测噪声 = (HDOP * UERE)^2 */
+#define GPS_KF_UERE_M           3.0f
+/* 加速度噪声谱密度 (m/s^2)^2/Hz，步行/骑行的机动量级 */
+#define GPS_KF_ACCEL_PSD        0.5f
+/* 初始速度方差 (m/s)^2 */
+#define GPS_KF_INIT_VEL_VAR     25.0f
+/* 两维新息马氏距离平方的门限，2 自由度 99.9% */
+#define GPS_KF_GATE             13.8f
+/* 连续拒绝多少次后认为是真实跳变，重新初始化 */
+#define GPS_KF_MAX_REJECTS      5
+/* 定位间隔超过该值（毫秒）时重新初始化 */
+#define GPS_KF_MAX_GAP_MS       10000
+/* 偏离原点超过该距离（米）时移动原点，保持单精度分辨率 */
+#define GPS_KF_RECENTER_M       5000.0f
+/* 95% 概率圆半径与单轴标准差之比（二维高斯） */
+#define GPS_KF_R95_SCALE        2.45f
+
+/* 单轴状态和协方差 [pp pv; pv vv] */
+typedef struct
+{
+    float p;
+    float v;
+    float pp;
+    float pv;
+    float vv;
+} gps_kf_axis_t;
+
+typedef struct
+{
+    rt_bool_t ready;
+    rt_int32_t origin_lat;      /* ENU 原点，1e-7 度 */
+    rt_int32_t origin_lon;
+    float m_per_e7_east;        /* 原点纬度处经度方向的米/1e-7度 */
+    rt_uint32_t last_ms;        /* 上次更新的当日毫秒数 */
+    rt_uint8_t rejects;         /* 连续被门限拒绝的次数 */
+    gps_kf_axis_t east;
+    gps_kf_axis_t north;
+} gps_kf_t;
+
+/* 统计 */
+typedef struct
+{
+    rt_uint32_t updates;
+    rt_uint32_t resets;
+    rt_uint32_t rejected;
+    rt_uint32_t over_budget;
+    rt_uint32_t max_cycles;
+    rt_uint32_t total_cycles;
+} gps_kf_stats_t;
+
+static gps_kf_t gps_kf;
+static gps_kf_stats_t gps_kf_stats;
+
+/* 滤波结果：与定位记录一样以双缓冲序列锁发布 */
+static snapshot_t gps_kf_snap;
+static gps_kf_state_t gps_kf_slots[2];
+
+/* hhmmss + 毫秒转换为当日毫秒数 */
+static rt_uint32_t gps_kf_day_ms(rt_uint32_t time, rt_uint16_t time_ms)
+{
+    return ((time / 10000) * 3600 + (time / 100 % 100) * 60 + time % 100) * 1000 + time_ms;
+}
+
+/* 以当前定位为原点重新初始化 */
+static void gps_kf_reset(gps_kf_t *kf, rt_int32_t lat, rt_int32_t lon, float r)
+{
+    kf->origin_lat = lat;
+    kf->origin_lon = lon;
+    kf->m_per_e7_east = GPS_KF_M_PER_E7 * cosf((float)lat * (3.14159265f / 180.0f / 1e7f));
+    kf->rejects = 0;
+
+    kf->east.p = kf->north.p = 0.0f;
+    kf->east.v = kf->north.v = 0.0f;
+    kf->east.pp = kf->north.pp = r;
+    kf->east.pv = kf->north.pv = 0.0f;
+    kf->east.vv = kf->north.vv = GPS_KF_INIT_VEL_VAR;
+    kf->ready = RT_TRUE;
+    gps_kf_stats.resets++;
+}
+
+/* 时间更新：x = F x，P = F P F' + Q（连续白噪声加速度模型） */
+static void gps_kf_predict(gps_kf_axis_t *a, float dt)
+{
+    float dt2 = dt * dt;
+    float q = GPS_KF_ACCEL_PSD;
+
+    a->p += a->v * dt;
+    a->pp += 2.0f * dt * a->pv + dt2 * a->vv + q * dt2 * dt * (1.0f / 3.0f);
+    a->pv += dt * a->vv + q * dt2 * 0.5f;
+    a->vv += q * dt;
+}
+
+/* 量测更新，z 为位置量测，r 为量测方差 */
+static void gps_kf_correct(gps_kf_axis_t *a, float z, float r)
+{
+    float s = a->pp + r;
+    float k0 = a->pp / s;
+    float k1 = a->pv / s;
+    float y = z - a->p;
+
+    a->p += k0 * y;
+    a->v += k1 * y;
+    /* P = (I - K H) P */
+    a->vv -= k1 * a->pv;
+    a->pv -= k0 * a->pv;
+    a->pp -= k0 * a->pp;
+}
+
+/* 把原点移到当前估计位置，避免远离原点后单精度分辨率下降 */
+static void gps_kf_recenter(gps_kf_t *kf)
+{
+    rt_int32_t dlat = (rt_int32_t)(kf->north.p / GPS_KF_M_PER_E7);
+    rt_int32_t dlon = (rt_int32_t)(kf->east.p / kf->m_per_e7_east);
+
+    kf->north.p -= dlat * GPS_KF_M_PER_E7;
+    kf->east.p -= dlon * kf->m_per_e7_east;
+    kf->origin_lat += dlat;
+    kf->origin_lon += dlon;
+    kf->m_per_e7_east = GPS_KF_M_PER_E7 * cosf((float)kf->origin_lat * (3.14159265f / 180.0f / 1e7f));
+}
+
+/* 发布滤波结果 */
+static void gps_kf_publish(const gps_kf_t *kf, const gps_fix_t *fix)
+{
+    gps_kf_state_t state;
+    float var = (kf->east.pp + kf->north.pp) * 0.5f;
+
+    state.time = fix->time;
+    state.time_ms = fix->time_ms;
+    state.latitude = kf->origin_lat + (rt_int32_t)lrintf(kf->north.p / GPS_KF_M_PER_E7);
+    state.longitude = kf->origin_lon + (rt_int32_t)lrintf(kf->east.p / kf->m_per_e7_east);
+    state.vel_east = (rt_int32_t)lrintf(kf->east.v * 100.0f);
+    state.vel_north = (rt_int32_t)lrintf(kf->north.v * 100.0f);
+    state.speed = (rt_uint32_t)lrintf(sqrtf(kf->east.v * kf->east.v + kf->north.v * kf->north.v) * 100.0f);
+    state.radius = (rt_uint32_t)lrintf(GPS_KF_R95_SCALE * sqrtf(var) * 100.0f);
+    state.seq = gps_kf_snap.seq + 1;
+
+    snapshot_publish(&gps_kf_snap, gps_kf_slots, &state, sizeof(state));
+}
+
+/**
+ * @brief   用一条新的定位记录更新滤波器
+ */
+void gps_kalman_update(const gps_fix_t *fix)
+{
+    gps_kf_t *kf = &gps_kf;
+    rt_uint32_t start = dwt_get_cycles();
+    rt_uint32_t now_ms, gap_ms, cycles;
+    float sigma, r, ze, zn, ye, yn, se, sn, dt;
+
+    if (!fix->valid)
+    {
+        return;
+    }
+
+    /* 量测噪声：HDOP 缺失时按 HDOP=5 处理 */
+    sigma = (fix->hdop ? fix->hdop * 0.01f : 5.0f) * GPS_KF_UERE_M;
+    r = sigma * sigma;
+
+    now_ms = gps_kf_day_ms(fix->time, fix->time_ms);
+    gap_ms = (now_ms + 86400000 - kf->last_ms) % 86400000;
+    kf->last_ms = now_ms;
+
+    if (!kf->ready || gap_ms == 0 || gap_ms > GPS_KF_MAX_GAP_MS)
+    {
+        gps_kf_reset(kf, fix->latitude, fix->longitude, r);
+        goto publish;
+    }
+
+    dt = gap_ms * 0.001f;
+    gps_kf_predict(&kf->east, dt);
+    gps_kf_predict(&kf->north, dt);
+
+    /* 量测转换到 ENU：坐标差为整数，只乘比例系数 */
+    zn = (float)(fix->latitude - kf->origin_lat) * GPS_KF_M_PER_E7;
+    ze = (float)(fix->longitude - kf->origin_lon) * kf->m_per_e7_east;
+
+    /* 新息门限：城市峡谷、钢结构附近的多径跳点直接拒绝 */
+    ye = ze - kf->east.p;
+    yn = zn - kf->north.p;
+    se = kf->east.pp + r;
+    sn = kf->north.pp + r;
+    if (ye * ye / se + yn * yn / sn > GPS_KF_GATE)
+    {
+        gps_kf_stats.rejected++;
+        if (++kf->rejects > GPS_KF_MAX_REJECTS)
+        {
+            /* 持续偏离说明位置真的变了（如刚出隧道），从新位置重新开始 */
+            gps_kf_reset(kf, fix->latitude, fix->longitude, r);
+        }
+        goto publish;
+    }
+    kf->rejects = 0;
+
+    gps_kf_correct(&kf->east, ze, r);
+    gps_kf_correct(&kf->north, zn, r);
+
+    if (fabsf(kf->east.p) > GPS_KF_RECENTER_M || fabsf(kf->north.p) > GPS_KF_RECENTER_M)
+    {
+        gps_kf_recenter(kf);
+    }
+
+publish:
+    gps_kf_publish(kf, fix);
+
+    cycles = dwt_get_cycles() - start;
+    gps_kf_stats.updates++;
+    gps_kf_stats.total_cycles += cycles;
+    if (cycles > gps_kf_stats.max_cycles)
+    {
+        gps_kf_stats.max_cycles = cycles;
+    }
+    if (cycles > GPS_KF_CYCLE_BUDGET)
+    {
+        gps_kf_stats.over_budget++;
+    }
+}
+
+/**
+ * @brief   获取最近一次滤波结果
+ */
+rt_err_t gps_kf_get(gps_kf_state_t *state)
+{
+    if (snapshot_read(&gps_kf_snap, gps_kf_slots, state, sizeof(*state)) == 0)
+    {
+        return -RT_EEMPTY;
+    }
+    return RT_EOK;
+}
+
+/**
+ * @brief   打印滤波器状态与耗时统计
+ */
+static int gps_kf_stat(int argc, char *argv[])
+{
+    gps_kf_state_t state;
+
+    rt_kprintf("[GPS_KF] updates: %d, resets: %d, rejected: %d\n",
+               gps_kf_stats.updates, gps_kf_stats.resets, gps_kf_stats.rejected);
+    rt_kprintf("[GPS_KF] cycles avg: %d, max: %d, budget: %d, over budget: %d\n",
+               gps_kf_stats.updates ? gps_kf_stats.total_cycles / gps_kf_stats.updates : 0,
+               gps_kf_stats.max_cycles, GPS_KF_CYCLE_BUDGET, gps_kf_stats.over_budget);
+
+    if (gps_kf_get(&state) == RT_EOK)
+    {
+        char lat[16], lon[16];
+
+        gps_coord_format(lat, sizeof(lat), state.latitude);
+        gps_coord_format(lon, sizeof(lon), state.longitude);
+        rt_kprintf("[GPS_KF] %s,%s  v(E,N) %d,%d cm/s  speed %d cm/s  r95 %d cm\n",
+                   lat, lon, state.vel_east, state.vel_north, state.speed, state.radius);
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(gps_kf_stat, show GPS Kalman filter state and cycle statistics);
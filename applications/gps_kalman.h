@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 轨迹常速度卡尔曼滤波
+ */
+
+#ifndef GPS_KALMAN_H
+#define GPS_KALMAN_H
+
+#include <rtthread.h>
+#include "ATGM336H_app.h"
+
+/* 单次更新的CPU周期预算，超出时计数 */
+#define GPS_KF_CYCLE_BUDGET     3000
+
+/* 滤波器状态：平滑后的位置、速度和不确定半径 */
+typedef struct
+{
+    rt_uint32_t time;           /* UTC 时间 hhmmss */
+    rt_uint16_t time_ms;        /* UTC 时间毫秒部分 */
+    rt_int32_t latitude;        /* 平滑后的纬度，1e-7 度 */
+    rt_int32_t longitude;       /* 平滑后的经度，1e-7 度 */
+    rt_int32_t vel_east;        /* 东向速度，cm/s */
+    rt_int32_t vel_north;       /* 北向速度，cm/s */
+    rt_uint32_t speed;          /* 水平速度，cm/s */
+    rt_uint32_t radius;         /* 95% 水平位置不确定半径，cm */
+    rt_uint32_t seq;            /* 发布序号 */
+} gps_kf_state_t;
+
+/**
+ * @brief   用一条新的定位记录更新滤波器（GPS线程中调用）
+ * @param   fix 定位记录，无效定位被忽略，间隔过长时滤波器重新初始化
+ */
+void gps_kalman_update(const gps_fix_t *fix);
+
+/**
+ * @brief   获取最近一次滤波结果（无锁，任意线程可调用）
+ * @return  RT_EOK 成功，-RT_EEMPTY 滤波器尚未初始化
+ */
+rt_err_t gps_kf_get(gps_kf_state_t *state);
+
+#endif /* GPS_KALMAN_H */
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 授时：UTC + 1PPS 驯服系统时间基准
+ */
+
+#include "gps_time.h"
+#include "drv_dwt.h"
+#include <rtdevice.h>
+
+/*
+ * 时间基准由三部分组成：
+ *   1. DWT 周期计数器扩展成 64 位，作为不回绕的单调时钟；
+ *   2. PPS 上升沿在中断中记录单调时钟，RMC 给出这个边沿对应的 UTC 整秒，
+ *      二者配对得到一个锚点 (周期数, UTC)；
+ *   3. 相邻锚点之间实测的周期数与标称值之差就是晶振频偏，平滑后用于
+ *      在锚点之间以及 GPS 中断期间外推 UTC。
+ */
+
+/* PPS 边沿缓存个数，定位记录最多晚到约 1 个周期，4 个足够配对 */
+#define GPS_PPS_RING            4
+/* 计算频偏允许的最长锚点间隔（秒），更长时只更新锚点 */
+#define GPS_TIME_DRIFT_MAX_S    64
+/* 单次频偏样本与估计值相差超过该值（ppb）视为异常边沿 */
+#define GPS_TIME_DRIFT_OUTLIER  50000
+/* 频偏平滑系数 1/2^n */
+#define GPS_TIME_DRIFT_SHIFT    3
+/* 回绕保护定时器周期：96MHz 下 32 位周期计数约 44 秒回绕一次 */
+#define GPS_TIME_GUARD_MS       10000
+
+/* 64 位单调周期计数 */
+static rt_uint64_t gps_mono_cycles;
+static rt_uint32_t gps_mono_last;
+
+/* PPS 边沿时刻（中断写入） */
+static rt_uint64_t gps_pps_edges[GPS_PPS_RING];
+static volatile rt_uint32_t gps_pps_count;
+
+/* 锚点与频偏 */
+static rt_uint64_t gps_anchor_cycles;
+static rt_uint64_t gps_anchor_utc_us;
+static rt_bool_t gps_anchor_pps;
+static rt_bool_t gps_drift_valid;
+static rt_uint64_t gps_utc_last_us;
+
+static gps_time_stats_t gps_time_stats;
+static rt_timer_t gps_time_guard;
+
+/**
+ * @brief   当前周期计数的 64 位扩展值
+ */
+rt_uint64_t gps_time_mono_cycles(void)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t now = dwt_get_cycles();
+    rt_uint64_t cycles;
+
+    gps_mono_cycles += (rt_uint32_t)(now - gps_mono_last);
+    gps_mono_last = now;
+    cycles = gps_mono_cycles;
+    rt_hw_interrupt_enable(level);
+
+    return cycles;
+}
+
+/**
+ * @brief   单调递增的 64 位微秒时钟
+ */
+rt_uint64_t gps_time_mono_us(void)
+{
+    return gps_time_mono_cycles() / dwt_cycles_per_us();
+}
+
+/* 按当前频偏修正后的每秒周期数，单位千分之一周期 */
+static rt_uint64_t gps_time_cps_milli(void)
+{
+    rt_uint64_t nominal = SystemCoreClock;
+
+    return nominal * 1000 + (rt_int64_t)nominal * gps_time_stats.drift_ppb / 1000000;
+}
+
+/* 周期数换算为微秒，先取整秒再算余数，长时间守时也不会溢出 */
+static rt_uint64_t gps_time_cycles_to_us(rt_uint64_t cycles, rt_uint64_t cps_milli)
+{
+    rt_uint64_t m = cycles * 1000;
+    rt_uint64_t sec = m / cps_milli;
+    rt_uint64_t rem = m - sec * cps_milli;
+
+    return sec * 1000000 + rem * 1000000 / cps_milli;
+}
+
+/* 由锚点外推某一时刻的 UTC，需在关中断状态下调用 */
+static rt_uint64_t gps_time_utc_at(rt_uint64_t cycles)
+{
+    return gps_anchor_utc_us + gps_time_cycles_to_us(cycles - gps_anchor_cycles, gps_time_cps_milli());
+}
+
+/* 公历日期转换为 1970-01-01 起的天数 */
+static rt_uint32_t gps_time_days(rt_uint32_t y, rt_uint32_t m, rt_uint32_t d)
+{
+    rt_uint32_t era, yoe, doy, doe;
+
+    y -= (m <= 2);
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+/* 1970-01-01 起的天数转换为公历日期 */
+static void gps_time_civil(rt_uint32_t days, rt_uint32_t *y, rt_uint32_t *m, rt_uint32_t *d)
+{
+    rt_uint32_t z = days + 719468;
+    rt_uint32_t era = z / 146097;
+    rt_uint32_t doe = z - era * 146097;
+    rt_uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    rt_uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    rt_uint32_t mp = (5 * doy + 2) / 153;
+
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+/**
+ * @brief   UTC 微秒数格式化为 yyyyMMddTHHmmssZ
+ */
+int gps_time_format_utc(char *buf, rt_size_t size, rt_uint64_t utc_us)
+{
+    rt_uint32_t secs = (rt_uint32_t)(utc_us / 1000000);
+    rt_uint32_t sod = secs % 86400;
+    rt_uint32_t y, m, d;
+
+    gps_time_civil(secs / 86400, &y, &m, &d);
+    return rt_snprintf(buf, size, "%04d%02d%02dT%02d%02d%02dZ",
+                       y, m, d, sod / 3600, sod / 60 % 60, sod % 60);
+}
+
+/* PPS 上升沿中断：只记录时刻，配对在 GPS 线程中完成 */
+static void gps_pps_isr(void *args)
+{
+    gps_pps_edges[gps_pps_count % GPS_PPS_RING] = gps_time_mono_cycles();
+    gps_pps_count++;
+}
+
+/* 查找该定位周期对应的 PPS 边沿：语句在整秒边沿之后 time_ms 到 time_ms+1s 之间到达 */
+static rt_bool_t gps_time_find_edge(rt_uint64_t rx_cycles, rt_uint16_t time_ms, rt_uint64_t *edge)
+{
+    rt_uint64_t edges[GPS_PPS_RING];
+    rt_uint64_t nominal = SystemCoreClock;
+    rt_uint64_t lo = nominal * time_ms / 1000;
+    rt_uint64_t hi = nominal * (time_ms + 1000) / 1000;
+    rt_uint32_t count, n;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    count = gps_pps_count;
+    rt_memcpy(edges, gps_pps_edges, sizeof(edges));
+    rt_hw_interrupt_enable(level);
+
+    n = count < GPS_PPS_RING ? count : GPS_PPS_RING;
+    for (rt_uint32_t i = 1; i <= n; i++)
+    {
+        rt_uint64_t e = edges[(count - i) % GPS_PPS_RING];
+
+        if (e <= rx_cycles && rx_cycles - e >= lo && rx_cycles - e < hi)
+        {
+            *edge = e;
+            return RT_TRUE;
+        }
+    }
+    return RT_FALSE;
+}
+
+/* 用一个新的 PPS 锚点更新频偏估计，需在关中断状态下调用 */
+static void gps_time_learn_drift(rt_uint64_t edge, rt_uint64_t utc_us)
+{
+    rt_uint64_t nominal = SystemCoreClock;
+    rt_uint64_t interval = (utc_us - gps_anchor_utc_us) / 1000000;
+    rt_int64_t diff;
+    rt_int32_t sample;
+
+    gps_time_stats.phase_err_us = (rt_int32_t)((rt_int64_t)(gps_time_utc_at(edge) - utc_us));
+
+    if (interval == 0 || interval > GPS_TIME_DRIFT_MAX_S)
+    {
+        return;
+    }
+
+    diff = (rt_int64_t)(edge - gps_anchor_cycles) - (rt_int64_t)(nominal * interval);
+    sample = (rt_int32_t)(diff * 1000000000 / (rt_int64_t)(nominal * interval));
+
+    if (!gps_drift_valid)
+    {
+        gps_time_stats.drift_ppb = sample;
+        gps_drift_valid = RT_TRUE;
+    }
+    else if (sample - gps_time_stats.drift_ppb < GPS_TIME_DRIFT_OUTLIER &&
+             gps_time_stats.drift_ppb - sample < GPS_TIME_DRIFT_OUTLIER)
+    {
+        gps_time_stats.drift_ppb += (sample - gps_time_stats.drift_ppb) / (1 << GPS_TIME_DRIFT_SHIFT);
+    }
+}
+
+/**
+ * @brief   用一条有效定位记录对齐 UTC
+ */
+void gps_time_update(const gps_fix_t *fix, rt_uint64_t rx_cycles)
+{
+    rt_uint32_t d = fix->date / 10000, mo = fix->date / 100 % 100, y = 2000 + fix->date % 100;
+    rt_uint32_t sec_of_day = (fix->time / 10000) * 3600 + (fix->time / 100 % 100) * 60 + fix->time % 100;
+    rt_uint64_t utc_us, edge;
+    rt_base_t level;
+
+    if (!fix->valid || fix->date == 0 || mo < 1 || mo > 12 || d < 1)
+    {
+        return;
+    }
+    utc_us = ((rt_uint64_t)gps_time_days(y, mo, d) * 86400 + sec_of_day) * 1000000;
+
+    if (gps_time_find_edge(rx_cycles, fix->time_ms, &edge))
+    {
+        level = rt_hw_interrupt_disable();
+        /* 多赫兹输出时同一秒内的定位对应同一个边沿，只对齐一次 */
+        if (!gps_anchor_pps || edge != gps_anchor_cycles)
+        {
+            if (gps_anchor_pps)
+            {
+                gps_time_learn_drift(edge, utc_us);
+            }
+            gps_anchor_cycles = edge;
+            gps_anchor_utc_us = utc_us;
+            gps_anchor_pps = RT_TRUE;
+            gps_time_stats.state = GPS_TIME_LOCKED;
+            gps_time_stats.syncs++;
+        }
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    gps_time_stats.unmatched++;
+
+    /* 没有 PPS（未接线或尚未输出）时退而以语句到达时刻粗对齐；
+     * 曾经锁定过则继续按频偏守时，比 NMEA 延迟更准 */
+    if (!gps_anchor_pps)
+    {
+        level = rt_hw_interrupt_disable();
+        gps_anchor_cycles = rx_cycles;
+        gps_anchor_utc_us = utc_us + fix->time_ms * 1000;
+        gps_time_stats.state = GPS_TIME_COARSE;
+        gps_time_stats.syncs++;
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+/* 锁定状态下 PPS 超时则进入守时 */
+static void gps_time_check_holdover(rt_uint64_t now)
+{
+    rt_uint64_t timeout = (rt_uint64_t)SystemCoreClock * GPS_TIME_HOLDOVER_MS / 1000;
+
+    if (gps_time_stats.state == GPS_TIME_LOCKED && now - gps_anchor_cycles > timeout)
+    {
+        gps_time_stats.state = GPS_TIME_HOLDOVER;
+    }
+}
+
+/**
+ * @brief   当前 UTC 时间，Unix 纪元起的微秒数
+ */
+rt_uint64_t now_utc_us(void)
+{
+    rt_uint64_t utc;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (gps_time_stats.state == GPS_TIME_NONE)
+    {
+        rt_hw_interrupt_enable(level);
+        return 0;
+    }
+    utc = gps_time_utc_at(gps_time_mono_cycles());
+    /* 重新对齐可能让外推值后退几微秒到几十毫秒（粗对齐转锁定），此时停住等它追上 */
+    if (utc < gps_utc_last_us)
+    {
+        utc = gps_utc_last_us;
+    }
+    gps_utc_last_us = utc;
+    rt_hw_interrupt_enable(level);
+
+    return utc;
+}
+
+/**
+ * @brief   读取授时统计
+ */
+void gps_time_get_stats(gps_time_stats_t *stats)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    gps_time_check_holdover(gps_time_mono_cycles());
+    gps_time_stats.pps_count = gps_pps_count;
+    *stats = gps_time_stats;
+    rt_hw_interrupt_enable(level);
+}
+
+/* 周期性读取单调时钟，保证两次读取之间周期计数器不会回绕超过一圈 */
+static void gps_time_guard_entry(void *parameter)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    gps_time_check_holdover(gps_time_mono_cycles());
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * @brief   授时模块初始化：PPS 引脚中断与回绕保护定时器
+ */
+static int gps_time_init(void)
+{
+    rt_err_t ret;
+
+    gps_mono_last = dwt_get_cycles();
+
+    gps_time_guard = rt_timer_create("gps_tm", gps_time_guard_entry, RT_NULL,
+                                     rt_tick_from_millisecond(GPS_TIME_GUARD_MS),
+                                     RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+    if (gps_time_guard == RT_NULL)
+    {
+        rt_kprintf("[GPS_TIME] guard timer create failed!\n");
+        return -1;
+    }
+    rt_timer_start(gps_time_guard);
+
+    rt_pin_mode(GPS_PPS_PIN, PIN_MODE_INPUT_PULLDOWN);
+    ret = rt_pin_attach_irq(GPS_PPS_PIN, PIN_IRQ_MODE_RISING, gps_pps_isr, RT_NULL);
+    if (ret == RT_EOK)
+    {
+        ret = rt_pin_irq_enable(GPS_PPS_PIN, PIN_IRQ_ENABLE);
+    }
+    if (ret != RT_EOK)
+    {
+        /* 没有 PPS 仍可用 NMEA 粗对齐 */
+        rt_kprintf("[GPS_TIME] PPS irq setup failed: %d, NMEA time only\n", ret);
+    }
+
+    return 0;
+}
+INIT_APP_EXPORT(gps_time_init);
+
+/**
+ * @brief   打印授时状态
+ */
+static int gps_time(int argc, char *argv[])
+{
+    static const char *const state_names[] = { "none", "coarse", "locked", "holdover" };
+    gps_time_stats_t stats;
+    rt_uint64_t utc = now_utc_us();
+    rt_uint64_t mono = gps_time_mono_us();
+
+    gps_time_get_stats(&stats);
+    rt_kprintf("[GPS_TIME] state: %s, utc: %u.%06u, mono: %u.%06u s\n",
+               state_names[stats.state],
+               (rt_uint32_t)(utc / 1000000), (rt_uint32_t)(utc % 1000000),
+               (rt_uint32_t)(mono / 1000000), (rt_uint32_t)(mono % 1000000));
+    rt_kprintf("[GPS_TIME] drift: %d ppb, phase error: %d us, pps: %d, syncs: %d, unmatched: %d\n",
+               stats.drift_ppb, stats.phase_err_us, stats.pps_count, stats.syncs, stats.unmatched);
+    return 0;
+}
+MSH_CMD_EXPORT(gps_time, show GPS disciplined time base state);
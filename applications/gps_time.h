@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 授时：UTC + 1PPS 驯服系统时间基准
+ */
+
+#ifndef GPS_TIME_H
+#define GPS_TIME_H
+
+#include <rtthread.h>
+#include "ATGM336H_app.h"
+
+/* ATGM336H 1PPS 输出接入的引脚 P3_8，上升沿对齐 UTC 整秒 */
+#define GPS_PPS_PIN             ((3*32)+8)
+
+/* 超过该时间（毫秒）没有 PPS 认为失锁，按学习到的频偏守时 */
+#define GPS_TIME_HOLDOVER_MS    2500
+
+/* 时间基准状态 */
+typedef enum
+{
+    GPS_TIME_NONE = 0,          /* 从未授时，now_utc_us() 返回 0 */
+    GPS_TIME_COARSE,            /* 只有 NMEA 时间，误差为语句传输延迟（数十毫秒） */
+    GPS_TIME_LOCKED,            /* PPS 对齐整秒，误差为中断延迟（微秒级） */
+    GPS_TIME_HOLDOVER,          /* PPS 或定位丢失，按学习到的频偏外推 */
+} gps_time_state_t;
+
+/* 授时统计 */
+typedef struct
+{
+    gps_time_state_t state;
+    rt_int32_t drift_ppb;       /* 本地晶振相对 UTC 的频偏，十亿分之一 */
+    rt_int32_t phase_err_us;    /* 最近一次对齐时外推值与 PPS 的偏差 */
+    rt_uint32_t pps_count;      /* 收到的 PPS 边沿数 */
+    rt_uint32_t syncs;          /* 成功对齐的次数 */
+    rt_uint32_t unmatched;      /* 找不到对应 PPS 边沿的定位次数 */
+} gps_time_stats_t;
+
+/**
+ * @brief   单调递增的 64 位微秒时钟（上电起，DWT 扩展，不受授时影响）
+ */
+rt_uint64_t gps_time_mono_us(void);
+
+/**
+ * @brief   当前周期计数的 64 位扩展值，用于记录事件发生时刻
+ */
+rt_uint64_t gps_time_mono_cycles(void);
+
+/**
+ * @brief   当前 UTC 时间，Unix 纪元起的微秒数，保证不回退
+ * @return  尚未授时返回 0
+ */
+rt_uint64_t now_utc_us(void);
+
+/**
+ * @brief   UTC 微秒数格式化为 ISO 8601 基本格式 yyyyMMddTHHmmssZ（IoTDA event_time）
+ * @return  写入的字符数
+ */
+int gps_time_format_utc(char *buf, rt_size_t size, rt_uint64_t utc_us);
+
+/**
+ * @brief   用一条有效定位记录对齐 UTC（GPS线程中调用）
+ * @param   fix         定位记录，需要 RMC 的日期和时间
+ * @param   rx_cycles   该定位周期第一条语句到达时的 gps_time_mono_cycles()
+ */
+void gps_time_update(const gps_fix_t *fix, rt_uint64_t rx_cycles);
+
+/**
+ * @brief   读取授时统计
+ */
+void gps_time_get_stats(gps_time_stats_t *stats);
+
+#endif /* GPS_TIME_H */
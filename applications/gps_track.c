@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 轨迹在线压缩与差分编码分段
+ */
+
+#include "gps_track.h"
+#include <math.h>
+#include <stdlib.h>
+
+/*
+ * 开窗式在线 Douglas-Peucker：以上一个关键点为锚点，窗口内缓存之后的候选点。
+ * 新点到来时检查锚点到新点的线段能否代表窗口内所有点——按时间比例插值得到
+ * 每个候选点"应在"的位置（同步欧氏距离，停留和变速也算偏差），有任何一点
+ * 超出容差就把上一个点定为关键点；窗口满时同样强制输出，内存和单点耗时都有上限。
+ */
+
+/* 纬度 1e-7 度对应的米数 */
+#define GPS_TRACK_M_PER_E7          0.0111319f
+#define GPS_TRACK_DAY_MS            86400000U
+/* 一个点编码后最多占用的字节数：3 个 32 位 varint */
+#define GPS_TRACK_POINT_MAX_BYTES   15
+
+/* 压缩器状态 */
+typedef struct
+{
+    gps_track_point_t anchor;                       /* 上一个关键点 */
+    gps_track_point_t window[GPS_TRACK_WINDOW];     /* 锚点之后的候选点 */
+    rt_uint8_t count;                               /* 候选点数 */
+    rt_bool_t started;
+    float m_per_e7_east;                            /* 锚点纬度处经度方向的米/1e-7度 */
+    float tolerance_sq;                             /* 容差平方（平方米） */
+
+    /* 正在编码的分段 */
+    rt_uint8_t seg[GPS_TRACK_SEGMENT_MAX];
+    rt_uint8_t seg_len;
+    rt_uint16_t seg_points;
+    gps_track_point_t seg_last;                     /* 分段内上一个点，差分基准 */
+    rt_uint32_t seg_start_ms;                       /* 分段起点时间 */
+
+    gps_track_sink_t sink;
+
+    /* 统计 */
+    rt_uint32_t points_in;
+    rt_uint32_t points_kept;
+    rt_uint32_t segments;
+    rt_uint32_t bytes_out;
+    rt_uint32_t window_full;
+} gps_track_ctx_t;
+
+static gps_track_ctx_t gps_track =
+{
+    .tolerance_sq = (GPS_TRACK_TOLERANCE_CM / 100.0f) * (GPS_TRACK_TOLERANCE_CM / 100.0f),
+};
+
+/* 写入无符号 varint，返回字节数 */
+static rt_uint8_t gps_track_put_varint(rt_uint8_t *out, rt_uint32_t value)
+{
+    rt_uint8_t n = 0;
+
+    while (value >= 0x80)
+    {
+        out[n++] = (rt_uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (rt_uint8_t)value;
+    return n;
+}
+
+/* 有符号数 zigzag 映射：0,-1,1,-2 -> 0,1,2,3，小幅度的负数也只占一个字节 */
+static rt_uint32_t gps_track_zigzag(rt_int32_t value)
+{
+    return ((rt_uint32_t)value << 1) ^ (rt_uint32_t)(value >> 31);
+}
+
+/* 读取无符号 varint，返回消耗的字节数，数据不完整返回 0 */
+static rt_size_t gps_track_get_varint(const rt_uint8_t *in, rt_size_t len, rt_uint32_t *value)
+{
+    rt_uint32_t result = 0;
+
+    for (rt_size_t i = 0; i < len && i < 5; i++)
+    {
+        result |= (rt_uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80))
+        {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/* 结束当前分段并交给回调 */
+static void gps_track_emit_segment(gps_track_ctx_t *ctx)
+{
+    if (ctx->seg_points == 0)
+    {
+        return;
+    }
+    ctx->segments++;
+    ctx->bytes_out += ctx->seg_len;
+    if (ctx->sink != RT_NULL)
+    {
+        ctx->sink(ctx->seg, ctx->seg_len, ctx->seg_points);
+    }
+    ctx->seg_len = 0;
+    ctx->seg_points = 0;
+}
+
+/* 把一个关键点编码进分段，分段满或到期时先输出 */
+static void gps_track_encode(gps_track_ctx_t *ctx, const gps_track_point_t *p)
+{
+    rt_uint8_t *out;
+
+    if (ctx->seg_points > 0 &&
+        (ctx->seg_len + GPS_TRACK_POINT_MAX_BYTES > GPS_TRACK_SEGMENT_MAX ||
+         (p->day_ms + GPS_TRACK_DAY_MS - ctx->seg_start_ms) % GPS_TRACK_DAY_MS >= GPS_TRACK_SEGMENT_MS))
+    {
+        gps_track_emit_segment(ctx);
+    }
+
+    out = &ctx->seg[ctx->seg_len];
+    if (ctx->seg_points == 0)
+    {
+        *out++ = GPS_TRACK_FORMAT_VERSION;
+        ctx->seg_start_ms = p->day_ms;
+        out += gps_track_put_varint(out, p->day_ms);
+        out += gps_track_put_varint(out, gps_track_zigzag(p->latitude));
+        out += gps_track_put_varint(out, gps_track_zigzag(p->longitude));
+    }
+    else
+    {
+        rt_uint32_t dt = (p->day_ms + GPS_TRACK_DAY_MS - ctx->seg_last.day_ms) % GPS_TRACK_DAY_MS;
+
+        out += gps_track_put_varint(out, (dt + 50) / 100);
+        out += gps_track_put_varint(out, gps_track_zigzag(p->latitude - ctx->seg_last.latitude));
+        out += gps_track_put_varint(out, gps_track_zigzag(p->longitude - ctx->seg_last.longitude));
+    }
+    ctx->seg_len = out - ctx->seg;
+    ctx->seg_points++;
+    ctx->seg_last = *p;
+    ctx->points_kept++;
+}
+
+/* 设为新的锚点，经度比例按锚点纬度计算，之后的距离计算都不用三角函数 */
+static void gps_track_set_anchor(gps_track_ctx_t *ctx, const gps_track_point_t *p)
+{
+    ctx->anchor = *p;
+    ctx->count = 0;
+    ctx->m_per_e7_east = GPS_TRACK_M_PER_E7 * cosf((float)p->latitude * (3.14159265f / 180.0f / 1e7f));
+}
+
+/* 锚点到 p 的线段能否以容差代表窗口内全部候选点 */
+static rt_bool_t gps_track_segment_ok(const gps_track_ctx_t *ctx, const gps_track_point_t *p)
+{
+    const gps_track_point_t *a = &ctx->anchor;
+    rt_uint32_t span = (p->day_ms + GPS_TRACK_DAY_MS - a->day_ms) % GPS_TRACK_DAY_MS;
+    float dlat = (float)(p->latitude - a->latitude);
+    float dlon = (float)(p->longitude - a->longitude);
+
+    for (rt_uint8_t i = 0; i < ctx->count; i++)
+    {
+        const gps_track_point_t *w = &ctx->window[i];
+        rt_uint32_t t = (w->day_ms + GPS_TRACK_DAY_MS - a->day_ms) % GPS_TRACK_DAY_MS;
+        float frac = span ? (float)t / (float)span : 0.0f;
+        float north = ((float)(w->latitude - a->latitude) - frac * dlat) * GPS_TRACK_M_PER_E7;
+        float east = ((float)(w->longitude - a->longitude) - frac * dlon) * ctx->m_per_e7_east;
+
+        if (north * north + east * east > ctx->tolerance_sq)
+        {
+            return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+/* 输入一个点 */
+static void gps_track_ctx_add(gps_track_ctx_t *ctx, const gps_track_point_t *p)
+{
+    ctx->points_in++;
+
+    if (!ctx->started)
+    {
+        ctx->started = RT_TRUE;
+        gps_track_encode(ctx, p);
+        gps_track_set_anchor(ctx, p);
+        return;
+    }
+
+    if (ctx->count > 0 && (ctx->count == GPS_TRACK_WINDOW || !gps_track_segment_ok(ctx, p)))
+    {
+        /* 新点无法由当前线段代表，上一个候选点成为关键点 */
+        gps_track_point_t key = ctx->window[ctx->count - 1];
+
+        if (ctx->count == GPS_TRACK_WINDOW)
+        {
+            ctx->window_full++;
+        }
+        gps_track_encode(ctx, &key);
+        gps_track_set_anchor(ctx, &key);
+    }
+    ctx->window[ctx->count++] = *p;
+}
+
+/* 输出最新的点并结束分段，下一个点重新作为分段起点 */
+static void gps_track_ctx_flush(gps_track_ctx_t *ctx)
+{
+    if (ctx->count > 0)
+    {
+        gps_track_point_t last = ctx->window[ctx->count - 1];
+
+        gps_track_encode(ctx, &last);
+        gps_track_set_anchor(ctx, &last);
+    }
+    gps_track_emit_segment(ctx);
+}
+
+/**
+ * @brief   输入一个轨迹点
+ */
+void gps_track_add(rt_int32_t latitude, rt_int32_t longitude, rt_uint32_t day_ms)
+{
+    gps_track_point_t p = { latitude, longitude, day_ms };
+
+    gps_track_ctx_add(&gps_track, &p);
+}
+
+/**
+ * @brief   输出最新的点并结束当前分段
+ */
+void gps_track_flush(void)
+{
+    gps_track_ctx_flush(&gps_track);
+}
+
+/**
+ * @brief   设置分段输出回调
+ */
+void gps_track_set_sink(gps_track_sink_t sink)
+{
+    gps_track.sink = sink;
+}
+
+/**
+ * @brief   设置允许的轨迹偏差
+ */
+void gps_track_set_tolerance(rt_uint32_t tolerance_cm)
+{
+    float m = tolerance_cm / 100.0f;
+
+    gps_track.tolerance_sq = m * m;
+}
+
+/**
+ * @brief   解码一个分段
+ */
+int gps_track_decode(const rt_uint8_t *data, rt_size_t len, gps_track_point_t *points, int max_points)
+{
+    rt_size_t pos = 1;
+    rt_uint32_t v[3];
+    int n = 0;
+
+    if (len < 1 || data[0] != GPS_TRACK_FORMAT_VERSION)
+    {
+        return -1;
+    }
+
+    while (pos < len && n < max_points)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            rt_size_t used = gps_track_get_varint(&data[pos], len - pos, &v[i]);
+
+            if (used == 0)
+            {
+                return -1;
+            }
+            pos += used;
+        }
+        /* zigzag 还原 */
+        v[1] = (v[1] >> 1) ^ (0U - (v[1] & 1));
+        v[2] = (v[2] >> 1) ^ (0U - (v[2] & 1));
+
+        if (n == 0)
+        {
+            points[0].day_ms = v[0];
+            points[0].latitude = (rt_int32_t)v[1];
+            points[0].longitude = (rt_int32_t)v[2];
+        }
+        else
+        {
+            points[n].day_ms = (points[n - 1].day_ms + v[0] * 100) % GPS_TRACK_DAY_MS;
+            points[n].latitude = points[n - 1].latitude + (rt_int32_t)v[1];
+            points[n].longitude = points[n - 1].longitude + (rt_int32_t)v[2];
+        }
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * @brief   打印轨迹压缩统计
+ */
+static int gps_track_stat(int argc, char *argv[])
+{
+    rt_kprintf("[GPS_TRACK] points in: %d, kept: %d, segments: %d, bytes: %d, window full: %d\n",
+               gps_track.points_in, gps_track.points_kept, gps_track.segments,
+               gps_track.bytes_out, gps_track.window_full);
+    if (gps_track.bytes_out > 0)
+    {
+        /* 与每点 12 字节（纬度、经度、时间）的原始二进制相比 */
+        rt_kprintf("[GPS_TRACK] compression: %d.%02dx\n",
+                   gps_track.points_in * 12 / gps_track.bytes_out,
+                   gps_track.points_in * 1200 / gps_track.bytes_out % 100);
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(gps_track_stat, show GPS track compression statistics);
+
+#ifdef RT_USING_FINSH
+/*
+ * 压缩效果测试：按固定种子生成步行和车载两类轨迹（含转弯、停留和定位噪声），
+ * 压缩后解码还原，统计压缩比和每个原始点到还原轨迹的最大同步欧氏距离。
+ */
+#define GPS_TRACK_BENCH_POINTS      600
+#define GPS_TRACK_BENCH_MAX_KEYS    GPS_TRACK_BENCH_POINTS
+
+static gps_track_point_t *bench_keys;
+static int bench_key_count;
+static rt_uint32_t bench_bytes;
+
+static void gps_track_bench_sink(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points)
+{
+    int n = gps_track_decode(data, len, &bench_keys[bench_key_count],
+                             GPS_TRACK_BENCH_MAX_KEYS - bench_key_count);
+
+    if (n > 0)
+    {
+        bench_key_count += n;
+    }
+    bench_bytes += len;
+}
+
+/* 简单线性同余随机数，保证每次生成的轨迹相同 */
+static float gps_track_bench_rand(rt_uint32_t *seed)
+{
+    *seed = *seed * 1664525U + 1013904223U;
+    return (float)(*seed >> 8) / 16777216.0f - 0.5f;
+}
+
+/* 生成轨迹：speed 米/秒，turn 为每秒航向随机变化幅度，noise 为定位噪声（米） */
+static void gps_track_bench_gen(gps_track_point_t *pts, float speed, float turn, float noise, rt_uint32_t seed)
+{
+    float east = 0.0f, north = 0.0f, heading = 0.3f;
+    float m_east = GPS_TRACK_M_PER_E7 * cosf(31.85f * 3.14159265f / 180.0f);
+
+    for (int i = 0; i < GPS_TRACK_BENCH_POINTS; i++)
+    {
+        float v = speed;
+
+        /* 每 150 秒停留 20 秒，每 100 秒转一个直角弯 */
+        if (i % 150 >= 130)
+        {
+            v = 0.0f;
+        }
+        if (i % 100 == 99)
+        {
+            heading += 1.5708f;
+        }
+        heading += turn * gps_track_bench_rand(&seed);
+        east += v * sinf(heading);
+        north += v * cosf(heading);
+
+        pts[i].day_ms = 30000000U + i * 1000U;
+        pts[i].latitude = 318463533 + (rt_int32_t)((north + noise * gps_track_bench_rand(&seed)) / GPS_TRACK_M_PER_E7);
+        pts[i].longitude = 1214693000 + (rt_int32_t)((east + noise * gps_track_bench_rand(&seed)) / m_east);
+    }
+}
+
+/* 原始点到还原折线（按时间插值）的最大偏差，单位厘米 */
+static rt_uint32_t gps_track_bench_deviation(const gps_track_point_t *pts)
+{
+    float m_east = GPS_TRACK_M_PER_E7 * cosf(31.85f * 3.14159265f / 180.0f);
+    float worst = 0.0f;
+    int k = 0;
+
+    for (int i = 0; i < GPS_TRACK_BENCH_POINTS; i++)
+    {
+        const gps_track_point_t *a, *b;
+        float frac, north, east, d;
+
+        while (k + 2 < bench_key_count && bench_keys[k + 1].day_ms <= pts[i].day_ms)
+        {
+            k++;
+        }
+        a = &bench_keys[k];
+        b = &bench_keys[k + 1 < bench_key_count ? k + 1 : k];
+        frac = (b->day_ms > a->day_ms) ? (float)(pts[i].day_ms - a->day_ms) / (float)(b->day_ms - a->day_ms) : 0.0f;
+        north = ((float)(pts[i].latitude - a->latitude) - frac * (float)(b->latitude - a->latitude)) * GPS_TRACK_M_PER_E7;
+        east = ((float)(pts[i].longitude - a->longitude) - frac * (float)(b->longitude - a->longitude)) * m_east;
+        d = sqrtf(north * north + east * east);
+        if (d > worst)
+        {
+            worst = d;
+        }
+    }
+    return (rt_uint32_t)(worst * 100.0f);
+}
+
+/**
+ * @brief   轨迹压缩效果测试：gps_track_bench [容差厘米]
+ */
+static int gps_track_bench(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *name;
+        float speed;
+        float turn;
+        float noise;
+    } profiles[] =
+    {
+        { "walking", 1.4f, 0.4f, 1.0f },
+        { "driving", 12.0f, 0.1f, 1.5f },
+    };
+    rt_uint32_t tolerance_cm = (argc > 1) ? atoi(argv[1]) : GPS_TRACK_TOLERANCE_CM;
+    gps_track_point_t *pts;
+    gps_track_ctx_t *ctx;
+
+    pts = rt_malloc(GPS_TRACK_BENCH_POINTS * sizeof(gps_track_point_t));
+    bench_keys = rt_malloc(GPS_TRACK_BENCH_MAX_KEYS * sizeof(gps_track_point_t));
+    ctx = rt_malloc(sizeof(gps_track_ctx_t));
+    if (pts == RT_NULL || bench_keys == RT_NULL || ctx == RT_NULL)
+    {
+        rt_kprintf("[GPS_TRACK] no memory for benchmark\n");
+        rt_free(pts);
+        rt_free(bench_keys);
+        rt_free(ctx);
+        return -1;
+    }
+
+    for (rt_size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        float m = tolerance_cm / 100.0f;
+
+        gps_track_bench_gen(pts, profiles[i].speed, profiles[i].turn, profiles[i].noise, 12345 + i);
+
+        rt_memset(ctx, 0, sizeof(*ctx));
+        ctx->tolerance_sq = m * m;
+        ctx->sink = gps_track_bench_sink;
+        bench_key_count = 0;
+        bench_bytes = 0;
+        for (int k = 0; k < GPS_TRACK_BENCH_POINTS; k++)
+        {
+            gps_track_ctx_add(ctx, &pts[k]);
+        }
+        gps_track_ctx_flush(ctx);
+
+        rt_kprintf("[GPS_TRACK] %s: %d points -> %d kept, %d bytes in %d segments, "
+                   "ratio %dx vs 12B/point, max deviation %d cm (tolerance %d cm)\n",
+                   profiles[i].name, GPS_TRACK_BENCH_POINTS, bench_key_count, bench_bytes,
+                   ctx->segments, GPS_TRACK_BENCH_POINTS * 12 / (bench_bytes ? bench_bytes : 1),
+                   gps_track_bench_deviation(pts), tolerance_cm);
+    }
+
+    rt_free(pts);
+    rt_free(bench_keys);
+    rt_free(ctx);
+    return 0;
+}
+MSH_CMD_EXPORT(gps_track_bench, measure GPS track compression on synthetic walking and driving tracks);
+#endif /* RT_USING_FINSH */
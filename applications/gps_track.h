@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         GPS 轨迹在线压缩与差分编码分段
+ */
+
+#ifndef GPS_TRACK_H
+#define GPS_TRACK_H
+
+#include <rtthread.h>
+
+/* 默认允许的轨迹偏差（厘米） */
+#define GPS_TRACK_TOLERANCE_CM      300
+/* 候选点窗口长度，决定内存上限和单点最坏耗时 */
+#define GPS_TRACK_WINDOW            32
+/* 单个分段的最大字节数 */
+#define GPS_TRACK_SEGMENT_MAX       96
+/* 分段最长时间跨度（毫秒），到期即上传 */
+#define GPS_TRACK_SEGMENT_MS        30000
+
+/*
+ * 分段编码（varint 为 7 位一组小端，zigzag 把有符号数映射为无符号数）：
+ *
+ *   版本      1 字节，当前为 1
+ *   基准点    varint 当日毫秒数，zigzag varint 纬度，zigzag varint 经度（1e-7 度）
+ *   后续点    varint 时间差（100ms），zigzag varint 纬度差，zigzag varint 经度差
+ *
+ * 点数由数据长度决定，解码端把各分段的点依次连成折线即可还原轨迹。
+ */
+#define GPS_TRACK_FORMAT_VERSION    1
+
+/* 轨迹点 */
+typedef struct
+{
+    rt_int32_t latitude;        /* 1e-7 度 */
+    rt_int32_t longitude;       /* 1e-7 度 */
+    rt_uint32_t day_ms;         /* UTC 当日毫秒数 */
+} gps_track_point_t;
+
+/* 分段输出回调，在 GPS 线程中调用，不能阻塞 */
+typedef void (*gps_track_sink_t)(const rt_uint8_t *data, rt_size_t len, rt_uint16_t points);
+
+/**
+ * @brief   输入一个轨迹点，只保留还原轨迹所需的关键点
+ * @note    与前一个关键点之间被丢弃的点，到还原折线的同步欧氏距离不超过容差
+ */
+void gps_track_add(rt_int32_t latitude, rt_int32_t longitude, rt_uint32_t day_ms);
+
+/**
+ * @brief   输出最新的点并结束当前分段
+ */
+void gps_track_flush(void);
+
+/**
+ * @brief   设置分段输出回调
+ */
+void gps_track_set_sink(gps_track_sink_t sink);
+
+/**
+ * @brief   设置允许的轨迹偏差（厘米），0 表示只丢弃严格共线的点
+ */
+void gps_track_set_tolerance(rt_uint32_t tolerance_cm);
+
+/**
+ * @brief   解码一个分段
+ * @return  解出的点数，格式错误返回 -1
+ */
+int gps_track_decode(const rt_uint8_t *data, rt_size_t len, gps_track_point_t *points, int max_points);
+
+#endif /* GPS_TRACK_H */
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         流式 JSON 写入器：分块输出，可选 AT 参数转义
+ */
+
+#include "json_writer.h"
+#include <string.h>
+
+/*
+ * 报文边生成边交给输出函数，只占一个 JSON_WRITER_CHUNK 的缓冲区，
+ * 报文长度不受栈上缓冲区限制。
+ *
+ * 转义分两层：JSON 字符串内容先按 JSON 规则转义，整个 JSON 文本再按
+ * AT 字符串参数规则在 " , \ 前加 \，调用者只写普通 JSON。
+ *
+ * 数字不经过 rt_snprintf：整数逐位除 10，浮点数拆成整数和小数部分，小数部分
+ * 用尾数的整数乘法放大到指定位数，不需要双精度运算。
+ */
+
+static const rt_uint32_t json_pow10[JSON_WRITER_DECIMALS + 1] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000,
+};
+
+/* 写一个字节到缓冲区，满了交给输出函数 */
+static void json_put(json_writer_t *w, char c)
+{
+    if (w->len == JSON_WRITER_CHUNK)
+    {
+        w->emit(w->chunk, w->len, w->ctx);
+        w->total += w->len;
+        w->len = 0;
+    }
+    w->chunk[w->len++] = c;
+}
+
+/* 写一个 JSON 文本字节，需要时加 AT 转义 */
+static void json_putc(json_writer_t *w, char c)
+{
+    if (w->at_escape && (c == '"' || c == ',' || c == '\\'))
+    {
+        json_put(w, '\\');
+    }
+    json_put(w, c);
+}
+
+/* 写 JSON 字符串内容（不含两端引号） */
+static void json_put_escaped(json_writer_t *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (; *s != '\0'; s++)
+    {
+        char c = *s;
+
+        if (c == '"' || c == '\\')
+        {
+            json_putc(w, '\\');
+            json_putc(w, c);
+        }
+        else if ((rt_uint8_t)c < 0x20)
+        {
+            json_putc(w, '\\');
+            json_putc(w, 'u');
+            json_putc(w, '0');
+            json_putc(w, '0');
+            json_putc(w, hex[(c >> 4) & 0x0F]);
+            json_putc(w, hex[c & 0x0F]);
+        }
+        else
+        {
+            json_putc(w, c);
+        }
+    }
+}
+
+/* 写无符号整数，至少 min_digits 位（不足补 0） */
+static void json_put_uint(json_writer_t *w, rt_uint32_t value, rt_uint8_t min_digits)
+{
+    char digits[10];
+    rt_uint8_t n = 0;
+
+    do
+    {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (n < min_digits)
+    {
+        json_put(w, '0');
+        min_digits--;
+    }
+    while (n > 0)
+    {
+        json_put(w, digits[--n]);
+    }
+}
+
+/* 成员前缀：分隔逗号和成员名 */
+static void json_member(json_writer_t *w, const char *key)
+{
+    rt_uint16_t bit = 1U << w->depth;
+
+    if (w->has_member & bit)
+    {
+        json_putc(w, ',');
+    }
+    w->has_member |= bit;
+
+    if (key != RT_NULL)
+    {
+        json_putc(w, '"');
+        json_put_escaped(w, key);
+        json_putc(w, '"');
+        json_putc(w, ':');
+    }
+}
+
+static void json_open(json_writer_t *w, const char *key, char c)
+{
+    json_member(w, key);
+    json_putc(w, c);
+    if (w->depth < JSON_WRITER_DEPTH - 1)
+    {
+        w->depth++;
+    }
+    w->has_member &= ~(1U << w->depth);
+}
+
+static void json_close(json_writer_t *w, char c)
+{
+    if (w->depth > 0)
+    {
+        w->depth--;
+    }
+    json_putc(w, c);
+}
+
+/**
+ * @brief   初始化写入器
+ */
+void json_writer_init(json_writer_t *w, json_emit_t emit, void *ctx, rt_bool_t at_escape)
+{
+    w->emit = emit;
+    w->ctx = ctx;
+    w->has_member = 0;
+    w->depth = 0;
+    w->at_escape = at_escape;
+    w->len = 0;
+    w->total = 0;
+}
+
+/**
+ * @brief   原样输出文本
+ */
+void json_raw(json_writer_t *w, const char *text)
+{
+    while (*text != '\0')
+    {
+        json_put(w, *text++);
+    }
+}
+
+void json_object_begin(json_writer_t *w, const char *key)
+{
+    json_open(w, key, '{');
+}
+
+void json_object_end(json_writer_t *w)
+{
+    json_close(w, '}');
+}
+
+void json_array_begin(json_writer_t *w, const char *key)
+{
+    json_open(w, key, '[');
+}
+
+void json_array_end(json_writer_t *w)
+{
+    json_close(w, ']');
+}
+
+void json_string(json_writer_t *w, const char *key, const char *value)
+{
+    json_member(w, key);
+    json_putc(w, '"');
+    json_put_escaped(w, value);
+    json_putc(w, '"');
+}
+
+void json_int(json_writer_t *w, const char *key, rt_int32_t value)
+{
+    json_member(w, key);
+    if (value < 0)
+    {
+        json_put(w, '-');
+        json_put_uint(w, 0U - (rt_uint32_t)value, 1);
+    }
+    else
+    {
+        json_put_uint(w, (rt_uint32_t)value, 1);
+    }
+}
+
+/**
+ * @brief   定点格式输出浮点数
+ */
+void json_fixed(json_writer_t *w, const char *key, float value, rt_uint8_t decimals)
+{
+    rt_uint32_t int_part, frac_part, bits, exponent;
+    float frac;
+    rt_bool_t negative = value < 0.0f;
+
+    json_member(w, key);
+
+    if (negative)
+    {
+        value = -value;
+    }
+    // 整数部分超出 32 位（含 NaN/Inf）输出 null
+    if (!(value < 4294967040.0f))
+    {
+        json_raw(w, "null");
+        return;
+    }
+    if (decimals > JSON_WRITER_DECIMALS)
+    {
+        decimals = JSON_WRITER_DECIMALS;
+    }
+
+    // 小数部分按尾数做整数乘法放大，结果精确，不会在浮点乘法中二次舍入
+    int_part = (rt_uint32_t)value;
+    frac = value - (float)int_part;
+    frac_part = 0;
+    memcpy(&bits, &frac, sizeof(bits));
+    exponent = (bits >> 23) & 0xFF;
+    if (exponent != 0)
+    {
+        // frac = mantissa * 2^(exponent - 150)，frac < 1 时 shift >= 24
+        rt_uint32_t shift = 150 - exponent;
+        rt_uint64_t product = (rt_uint64_t)((bits & 0x7FFFFF) | 0x800000) * json_pow10[decimals];
+
+        if (shift < 64)
+        {
+            frac_part = (rt_uint32_t)(product >> shift);
+            if ((product >> (shift - 1)) & 1)
+            {
+                frac_part++;
+            }
+        }
+    }
+    if (frac_part >= json_pow10[decimals])
+    {
+        frac_part -= json_pow10[decimals];
+        int_part++;
+    }
+
+    if (negative && (int_part != 0 || frac_part != 0))
+    {
+        json_put(w, '-');
+    }
+    json_put_uint(w, int_part, 1);
+    if (decimals > 0)
+    {
+        json_put(w, '.');
+        json_put_uint(w, frac_part, decimals);
+    }
+}
+
+/**
+ * @brief   二进制数据按 base64 编码成字符串输出
+ */
+void json_base64(json_writer_t *w, const char *key, const rt_uint8_t *data, rt_size_t len)
+{
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    json_member(w, key);
+    json_putc(w, '"');
+    for (rt_size_t i = 0; i < len; i += 3)
+    {
+        rt_uint32_t v = (rt_uint32_t)data[i] << 16;
+
+        if (i + 1 < len) v |= (rt_uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        json_put(w, b64[(v >> 18) & 0x3F]);
+        json_put(w, b64[(v >> 12) & 0x3F]);
+        json_put(w, (i + 1 < len) ? b64[(v >> 6) & 0x3F] : '=');
+        json_put(w, (i + 2 < len) ? b64[v & 0x3F] : '=');
+    }
+    json_putc(w, '"');
+}
+
+/**
+ * @brief   交出缓冲区中剩余的文本
+ */
+rt_size_t json_writer_flush(json_writer_t *w)
+{
+    if (w->len > 0)
+    {
+        w->emit(w->chunk, w->len, w->ctx);
+        w->total += w->len;
+        w->len = 0;
+    }
+    return w->total;
+}
+
+#ifdef RT_USING_FINSH
+#include "drv_dwt.h"
+
+/*
+ * 对比测试：同一条 BasedData 上报分别用 rt_snprintf（%.2f）和写入器生成，
+ * 比较输出是否一致以及平均耗时。写入器输出到计数函数，模拟直接送串口。
+ */
+#define JSON_BENCH_ROUNDS       100
+
+typedef struct
+{
+    char *buf;
+    rt_size_t size;
+    rt_size_t len;
+} json_bench_sink_t;
+
+static void json_bench_emit(const char *data, rt_size_t len, void *ctx)
+{
+    json_bench_sink_t *sink = ctx;
+
+    if (sink->buf != RT_NULL && sink->len + len < sink->size)
+    {
+        memcpy(&sink->buf[sink->len], data, len);
+        sink->buf[sink->len + len] = '\0';
+    }
+    sink->len += len;
+}
+
+static void json_bench_write(json_writer_t *w, float density, int hr, int temp, int humi)
+{
+    json_object_begin(w, RT_NULL);
+    json_array_begin(w, "services");
+    json_object_begin(w, RT_NULL);
+    json_string(w, "service_id", "BasedData");
+    json_object_begin(w, "properties");
+    json_fixed(w, "density", density, 2);
+    json_int(w, "heart_rate", hr);
+    json_int(w, "temperature", temp);
+    json_int(w, "humidity", humi);
+    json_object_end(w);
+    json_object_end(w);
+    json_array_end(w);
+    json_object_end(w);
+    json_writer_flush(w);
+}
+
+static int json_bench(int argc, char *argv[])
+{
+    static const float values[] = { 0.0f, 0.004f, 0.005f, 1.5f, 99.995f, 100.5f, 1234.567f, -3.25f };
+    char expect[160], actual[160];
+    json_bench_sink_t sink;
+    json_writer_t w;
+    rt_uint32_t start, printf_cycles = 0, writer_cycles = 0;
+    int mismatches = 0;
+
+    for (rt_uint8_t v = 0; v < sizeof(values) / sizeof(values[0]); v++)
+    {
+        rt_snprintf(expect, sizeof(expect),
+            "{\"services\":[{\"service_id\":\"BasedData\",\"properties\":{\"density\":%.2f,"
+            "\"heart_rate\":%d,\"temperature\":%d,\"humidity\":%d}}]}", values[v], 75, -5, 60);
+        sink.buf = actual;
+        sink.size = sizeof(actual);
+        sink.len = 0;
+        json_writer_init(&w, json_bench_emit, &sink, RT_FALSE);
+        json_bench_write(&w, values[v], 75, -5, 60);
+        if (strcmp(expect, actual) != 0)
+        {
+            rt_kprintf("[JSON] mismatch:\n  %s\n  %s\n", expect, actual);
+            mismatches++;
+        }
+    }
+
+    for (int i = 0; i < JSON_BENCH_ROUNDS; i++)
+    {
+        float density = i * 1.37f;
+
+        start = dwt_get_cycles();
+        rt_snprintf(expect, sizeof(expect),
+            "{\\\"services\\\":[{\\\"service_id\\\":\\\"BasedData\\\",\\\"properties\\\":{\\\"density\\\":%.2f,"
+            "\\\"heart_rate\\\":%d,\\\"temperature\\\":%d,\\\"humidity\\\":%d}}]}", density, 75, 26, 60);
+        printf_cycles += dwt_get_cycles() - start;
+
+        sink.buf = RT_NULL;
+        sink.len = 0;
+        start = dwt_get_cycles();
+        json_writer_init(&w, json_bench_emit, &sink, RT_TRUE);
+        json_bench_write(&w, density, 75, 26, 60);
+        writer_cycles += dwt_get_cycles() - start;
+    }
+
+    rt_kprintf("[JSON] format check: %d mismatches\n", mismatches);
+    rt_kprintf("[JSON] rt_snprintf: %d cycles/report, writer: %d cycles/report (%d bytes AT-escaped)\n",
+               printf_cycles / JSON_BENCH_ROUNDS, writer_cycles / JSON_BENCH_ROUNDS, sink.len);
+    rt_kprintf("[JSON] writer state: %d bytes on stack\n", sizeof(json_writer_t));
+    return mismatches == 0 ? 0 : -1;
+}
+MSH_CMD_EXPORT(json_bench, compare json writer with rt_snprintf);
+#endif /* RT_USING_FINSH */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         流式 JSON 写入器：分块输出，可选 AT 参数转义
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <rtthread.h>
+
+/* 写入器内部缓冲区大小，攒满一块交给输出函数 */
+#define JSON_WRITER_CHUNK       64
+/* 最大嵌套层数 */
+#define JSON_WRITER_DEPTH       16
+/* json_fixed() 支持的最多小数位 */
+#define JSON_WRITER_DECIMALS    6
+
+/* 输出函数，每次交出一块已编码的文本 */
+typedef void (*json_emit_t)(const char *data, rt_size_t len, void *ctx);
+
+/* 写入器状态，放在调用者栈上 */
+typedef struct
+{
+    json_emit_t emit;
+    void *ctx;
+    rt_uint16_t has_member;     /* 每层一位：该层已有成员，下一个成员前加逗号 */
+    rt_uint8_t depth;
+    rt_bool_t at_escape;        /* 输出作为 AT 命令的字符串参数，" , \ 前加 \ */
+    rt_uint16_t len;
+    rt_size_t total;            /* 已输出的总字节数 */
+    char chunk[JSON_WRITER_CHUNK];
+} json_writer_t;
+
+/**
+ * @brief   初始化写入器
+ * @param   emit        输出函数
+ * @param   ctx         输出函数参数
+ * @param   at_escape   是否按 AT 字符串参数转义
+ */
+void json_writer_init(json_writer_t *w, json_emit_t emit, void *ctx, rt_bool_t at_escape);
+
+/**
+ * @brief   原样输出文本，不做任何转义（用于 AT 命令头尾）
+ */
+void json_raw(json_writer_t *w, const char *text);
+
+/*
+ * 以下函数的 key 为成员名，在数组中或写根值时传 RT_NULL
+ */
+void json_object_begin(json_writer_t *w, const char *key);
+void json_object_end(json_writer_t *w);
+void json_array_begin(json_writer_t *w, const char *key);
+void json_array_end(json_writer_t *w);
+void json_string(json_writer_t *w, const char *key, const char *value);
+void json_int(json_writer_t *w, const char *key, rt_int32_t value);
+
+/**
+ * @brief   定点格式输出浮点数，四舍五入到 decimals 位小数，NaN/Inf 输出 null
+ */
+void json_fixed(json_writer_t *w, const char *key, float value, rt_uint8_t decimals);
+
+/**
+ * @brief   二进制数据按 base64 编码成字符串输出
+ */
+void json_base64(json_writer_t *w, const char *key, const rt_uint8_t *data, rt_size_t len);
+
+/**
+ * @brief   交出缓冲区中剩余的文本
+ * @return  累计输出的字节数
+ */
+rt_size_t json_writer_flush(json_writer_t *w);
+
+#endif /* JSON_WRITER_H */
@@ -10,6 +10,8 @@
 
 #include "mydefine.h"           // 包含通用定义头文件
 #include "drv_max30102.h"       // 包含MAX30102驱动头文件
+#include "max30102_app.h"       // 心率查询接口
+#include "app_config.h"         // 运行时配置（轮询周期）
 
 /* MAX30102 I2C 总线名称定义（根据实际硬件修改） */
 #define MAX30102_I2C_BUS_NAME    "i2c0"
@@ -23,6 +25,33 @@
 /* MAX30102 设备对象（全局静态变量，使用指针类型） */
 static max30102_device_t *max30102_dev = RT_NULL;
 
+/*
+ * 心率估算：红外信号平滑后减去直流分量（指数平均），交流分量跌破 -h 再回升越过 +h 记一次心跳，
+ * h 取上一拍峰峰值的 1/4（不小于 MAX30102_BEAT_HYST），噪声和基线漂移不会多计心跳。
+ * 最近几次心跳间隔的平均值换算成每分钟次数；红外值过低（未佩戴）或长时间没有心跳时心率为 0。
+ * 滤波系数按中断模式的 100Hz 采样选取，轮询模式下估算不可靠。
+ */
+#define MAX30102_FINGER_IR       50000   /* 红外值低于此值视为未佩戴 */
+#define MAX30102_LP_SHIFT        2       /* 平滑系数 1/4 */
+#define MAX30102_DC_SHIFT        6       /* 直流分量平均系数 1/64（100Hz 采样时约 0.64 秒） */
+#define MAX30102_BEAT_HYST       20      /* 心跳判定门限的下限 */
+#define MAX30102_BPM_MIN         40
+#define MAX30102_BPM_MAX         200
+#define MAX30102_BEAT_AVG        4       /* 参与平均的心跳间隔数 */
+#define MAX30102_BEAT_TIMEOUT_MS 3000    /* 超过该时间没有心跳视为无效 */
+
+static rt_int32_t max30102_lp = 0;                          // 平滑后的信号，放大 16 倍
+static rt_int32_t max30102_dc = 0;                          // 直流分量，放大 16 倍
+static rt_int32_t max30102_hyst = MAX30102_BEAT_HYST;       // 当前判定门限 h
+static rt_int32_t max30102_ac_min = 0;                      // 本拍交流分量的最小、最大值
+static rt_int32_t max30102_ac_max = 0;
+static rt_bool_t max30102_armed = RT_FALSE;                 // 已跌破 -h，等待回升
+static rt_tick_t max30102_last_beat = 0;
+static rt_uint32_t max30102_intervals[MAX30102_BEAT_AVG];   // 最近的心跳间隔（毫秒）
+static rt_uint8_t max30102_interval_count = 0;
+static rt_uint8_t max30102_interval_next = 0;
+static volatile rt_uint32_t max30102_heart_rate = 0;
+
 #if USE_INTERRUPT_MODE
 /* 信号量，用于中断与线程之间的同步 */
 static rt_sem_t max30102_sem = RT_NULL;
@@ -38,6 +67,115 @@ static void max30102_int_callback(void *args)
 }
 #endif
 
+/* 丢弃心率估算状态（未佩戴或重新开始） */
+static void max30102_hr_reset(void)
+{
+    max30102_lp = 0;
+    max30102_dc = 0;
+    max30102_hyst = MAX30102_BEAT_HYST;
+    max30102_ac_min = 0;
+    max30102_ac_max = 0;
+    max30102_armed = RT_FALSE;
+    max30102_last_beat = 0;
+    max30102_interval_count = 0;
+    max30102_heart_rate = 0;
+}
+
+/**
+ * @brief 用一个红外采样更新心率估算（在读取线程中调用）
+ * @param ir 红外LED数据
+ */
+static void max30102_hr_update(rt_uint32_t ir)
+{
+    rt_tick_t now = rt_tick_get();
+    rt_int32_t ac;
+    rt_uint32_t interval, sum = 0;
+
+    if (ir < MAX30102_FINGER_IR)
+    {
+        if (max30102_lp != 0)
+        {
+            max30102_hr_reset();
+        }
+        return;
+    }
+    if (max30102_lp == 0)
+    {
+        max30102_lp = max30102_dc = (rt_int32_t)(ir << 4);
+    }
+    max30102_lp += ((rt_int32_t)(ir << 4) - max30102_lp) >> MAX30102_LP_SHIFT;
+    max30102_dc += (max30102_lp - max30102_dc) >> MAX30102_DC_SHIFT;
+    ac = (max30102_lp - max30102_dc) >> 4;
+
+    if (ac < max30102_ac_min)
+    {
+        max30102_ac_min = ac;
+    }
+    if (ac > max30102_ac_max)
+    {
+        max30102_ac_max = ac;
+    }
+    if (ac < -max30102_hyst)
+    {
+        max30102_armed = RT_TRUE;
+        return;
+    }
+    if (!max30102_armed || ac <= max30102_hyst)
+    {
+        return;
+    }
+
+    /* 从波谷回升越过 +h：一次心跳，门限按这一拍的峰峰值调整 */
+    max30102_armed = RT_FALSE;
+    max30102_hyst = (max30102_ac_max - max30102_ac_min) / 4;
+    if (max30102_hyst < MAX30102_BEAT_HYST)
+    {
+        max30102_hyst = MAX30102_BEAT_HYST;
+    }
+    max30102_ac_min = 0;
+    max30102_ac_max = 0;
+    interval = now - max30102_last_beat >= rt_tick_from_millisecond(60000) ? 60000 :
+               (now - max30102_last_beat) * 1000 / RT_TICK_PER_SECOND;
+    if (max30102_last_beat != 0 && interval < 60000 / MAX30102_BPM_MAX)
+    {
+        return;     // 间隔过短，当作噪声
+    }
+    if (max30102_last_beat == 0 || interval > 60000 / MAX30102_BPM_MIN)
+    {
+        max30102_interval_count = 0;     // 第一次心跳或中断过，重新累计
+    }
+    else
+    {
+        max30102_intervals[max30102_interval_next] = interval;
+        max30102_interval_next = (max30102_interval_next + 1) % MAX30102_BEAT_AVG;
+        if (max30102_interval_count < MAX30102_BEAT_AVG)
+        {
+            max30102_interval_count++;
+        }
+        for (rt_uint8_t i = 0; i < max30102_interval_count; i++)
+        {
+            sum += max30102_intervals[i];
+        }
+        max30102_heart_rate = 60000 * max30102_interval_count / sum;
+    }
+    max30102_last_beat = now;
+}
+
+/**
+ * @brief 获取当前心率
+ * @return 每分钟心跳次数，未佩戴或超过 MAX30102_BEAT_TIMEOUT_MS 没有心跳时为 0
+ */
+rt_uint32_t max30102_get_heart_rate(void)
+{
+    rt_uint32_t bpm = max30102_heart_rate;
+
+    if (bpm != 0 && rt_tick_get() - max30102_last_beat > rt_tick_from_millisecond(MAX30102_BEAT_TIMEOUT_MS))
+    {
+        return 0;
+    }
+    return bpm;
+}
+
 /**
  * @brief MAX30102 读取线程入口函数
  * @param parameter 线程参数（本例中未使用）
@@ -100,6 +238,7 @@ static void max30102_thread_entry(void *parameter)
         result = max30102_read_fifo(max30102_dev, &red_led, &ir_led);
         if (result == RT_EOK)  // 如果读取成功
         {
+            max30102_hr_update(ir_led);
             rt_kprintf("[MAX30102] RED: %u, IR: %u\n", red_led, ir_led);
         }
         else  // 如果读取失败
@@ -121,7 +260,8 @@ polling_mode:
         /* 根据读取结果进行处理 */
         if (result == RT_EOK)  // 如果读取成功
         {
-            /* 打印红光和红外光的原始数据值 */
+            /* 更新心率估算，打印红光和红外光的原始数据值 */
+            max30102_hr_update(ir_led);
             rt_kprintf("[MAX30102] RED: %u, IR: %u\n", red_led, ir_led);
         }
         else  // 如果读取失败
@@ -130,8 +270,8 @@ polling_mode:
             rt_kprintf("[MAX30102] Read FIFO error! (error code: %d)\n", result);
         }
 
-        /* 延时100毫秒后再次读取（根据实际采样率调整此值） */
-        rt_thread_mdelay(100);
+        /* 延时后再次读取，周期见 app_config（默认100毫秒） */
+        rt_thread_mdelay(app_cfg_get(APP_CFG_MAX30102_POLL_MS));
     }
 }
 
@@ -191,7 +331,7 @@ static int max30102_app_init(void)
 #if USE_INTERRUPT_MODE
         rt_kprintf("[MAX30102] INT pin: P1_13 (interrupt will be configured in thread)\n\n");
 #else
-        rt_kprintf("[MAX30102] Running in polling mode (100ms interval)\n\n");
+        rt_kprintf("[MAX30102] Running in polling mode (%dms interval)\n\n", app_cfg_get(APP_CFG_MAX30102_POLL_MS));
 #endif
     }
     else  // 如果线程创建失败
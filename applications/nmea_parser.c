@@ -0,0 +1,841 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         NMEA 0183 逐字节状态机解析器实现
+ * 2026-10-19     User         增加 GGA/GSA/GSV/VTG 语句解码
+ */
+
+#include "nmea_parser.h"
+
+/* 状态机状态 */
+#define NMEA_STATE_IDLE         0       /* 等待 '$' */
+#define NMEA_STATE_FIELD        1       /* 接收地址字段和数据字段 */
+#define NMEA_STATE_CS1          2       /* 接收校验值高位 */
+#define NMEA_STATE_CS2          3       /* 接收校验值低位 */
+
+/* 尾数累加上限，再乘 10 加 9 也不会溢出 32 位 */
+#define NMEA_MANTISSA_LIMIT     ((0xFFFFFFFFU - 9U) / 10U)
+
+/* 坐标分字段统一到 1e-5 分 */
+#define NMEA_MIN_SCALE          100000U
+
+/* 十六进制字符转数值，非法字符返回 -1 */
+static rt_int8_t nmea_hex_value(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+    {
+        return ch - '0';
+    }
+    if (ch >= 'A' && ch <= 'F')
+    {
+        return ch - 'A' + 10;
+    }
+    if (ch >= 'a' && ch <= 'f')
+    {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+/* 字段字符就地累加为数值 */
+static void nmea_token_put(nmea_token_t *tok, char ch)
+{
+    if (tok->len++ == 0)
+    {
+        tok->first = ch;
+        if (ch == '-')
+        {
+            tok->neg = 1;
+            return;
+        }
+    }
+
+    if (ch >= '0' && ch <= '9')
+    {
+        if (tok->dot && tok->frac >= NMEA_MAX_FRAC_DIGITS)
+        {
+            /* 多余的小数位直接丢弃 */
+            return;
+        }
+        if (tok->mantissa > NMEA_MANTISSA_LIMIT)
+        {
+            /* 小数部分溢出时丢弃低位，整数部分溢出则字段非法 */
+            if (!tok->dot)
+            {
+                tok->bad = 1;
+            }
+            return;
+        }
+        tok->mantissa = tok->mantissa * 10 + (ch - '0');
+        if (tok->dot)
+        {
+            tok->frac++;
+        }
+    }
+    else if (ch == '.' && !tok->dot)
+    {
+        tok->dot = 1;
+    }
+    else
+    {
+        tok->bad = 1;
+    }
+}
+
+/* 取字段的定点值，digits 为目标小数位数 */
+static rt_int32_t nmea_token_fixed(const nmea_token_t *tok, rt_uint8_t digits)
+{
+    rt_uint32_t value = tok->mantissa;
+    rt_uint8_t frac = tok->frac;
+
+    while (frac < digits)
+    {
+        value *= 10;
+        frac++;
+    }
+    while (frac > digits)
+    {
+        value /= 10;
+        frac--;
+    }
+
+    return tok->neg ? -(rt_int32_t)value : (rt_int32_t)value;
+}
+
+/*
+ * ddmm.mmmmm / dddmm.mmmmm 精确转换为 1e-7 度：
+ * 分数部分统一到 1e-5 分后乘 100/60，四舍五入，全程 32 位整数运算。
+ * 分 >= 60 或超过 max_deg 度时返回 RT_FALSE。
+ */
+static rt_bool_t nmea_token_coord(const nmea_token_t *tok, rt_uint32_t max_deg, rt_int32_t *coord)
+{
+    rt_uint32_t scale = 1;
+    rt_uint32_t deg, min_e5, value;
+
+    if (tok->neg)
+    {
+        return RT_FALSE;
+    }
+    for (rt_uint8_t i = 0; i < tok->frac; i++)
+    {
+        scale *= 10;
+    }
+    deg = tok->mantissa / (scale * 100);
+    min_e5 = tok->mantissa - deg * scale * 100;
+    for (rt_uint8_t i = tok->frac; i < NMEA_MAX_FRAC_DIGITS; i++)
+    {
+        min_e5 *= 10;
+    }
+    if (min_e5 >= 60 * NMEA_MIN_SCALE || deg > max_deg)
+    {
+        return RT_FALSE;
+    }
+
+    /* round(min_e5 * 5 / 3) = (min_e5 * 10 + 3) / 6，min_e5 < 6e6 不会溢出 */
+    value = deg * NMEA_COORD_SCALE + (min_e5 * 10 + 3) / 6;
+    if (value > max_deg * NMEA_COORD_SCALE)
+    {
+        return RT_FALSE;
+    }
+    *coord = (rt_int32_t)value;
+    return RT_TRUE;
+}
+
+/* 检查数值字段，非法时标记整条语句出错 */
+static rt_bool_t nmea_numeric(nmea_parser_t *parser)
+{
+    if (parser->token.bad)
+    {
+        parser->field_error = 1;
+        return RT_FALSE;
+    }
+    return parser->token.len > 0;
+}
+
+/* 根据地址字段识别语句类型，忽略两字符的 talker ID（GP/GN/BD 等） */
+static rt_uint8_t nmea_identify(const char *address)
+{
+    const char *type = &address[2];
+
+    if (type[0] == 'R' && type[1] == 'M' && type[2] == 'C')
+    {
+        return NMEA_SENTENCE_RMC;
+    }
+    if (type[0] == 'G' && type[1] == 'G' && type[2] == 'A')
+    {
+        return NMEA_SENTENCE_GGA;
+    }
+    if (type[0] == 'G' && type[1] == 'S' && type[2] == 'A')
+    {
+        return NMEA_SENTENCE_GSA;
+    }
+    if (type[0] == 'G' && type[1] == 'S' && type[2] == 'V')
+    {
+        return NMEA_SENTENCE_GSV;
+    }
+    if (type[0] == 'V' && type[1] == 'T' && type[2] == 'G')
+    {
+        return NMEA_SENTENCE_VTG;
+    }
+    return NMEA_SENTENCE_OTHER;
+}
+
+/* RMC 字段解码 */
+static void nmea_decode_rmc(nmea_parser_t *parser)
+{
+    const nmea_token_t *tok = &parser->token;
+    nmea_rmc_t *rmc = &parser->work.rmc;
+    rt_int32_t value;
+
+    switch (parser->field)
+    {
+    case 1: /* UTC 时间 hhmmss.sss */
+        if (nmea_numeric(parser))
+        {
+            value = nmea_token_fixed(tok, 3);
+            rmc->time = value / 1000;
+            rmc->time_ms = value % 1000;
+        }
+        break;
+    case 2: /* 定位状态 */
+        rmc->valid = (tok->first == 'A');
+        break;
+    case 3: /* 纬度 */
+        if (nmea_numeric(parser) && !nmea_token_coord(tok, 90, &rmc->latitude))
+        {
+            parser->field_error = 1;
+        }
+        break;
+    case 4: /* 纬度方向 */
+        rmc->ns = tok->len ? tok->first : 0;
+        if (rmc->ns == 'S')
+        {
+            rmc->latitude = -rmc->latitude;
+        }
+        break;
+    case 5: /* 经度 */
+        if (nmea_numeric(parser) && !nmea_token_coord(tok, 180, &rmc->longitude))
+        {
+            parser->field_error = 1;
+        }
+        break;
+    case 6: /* 经度方向 */
+        rmc->ew = tok->len ? tok->first : 0;
+        if (rmc->ew == 'W')
+        {
+            rmc->longitude = -rmc->longitude;
+        }
+        break;
+    case 7: /* 对地速度（节） */
+        if (nmea_numeric(parser))
+        {
+            rmc->speed_knots = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 8: /* 对地航向（度） */
+        if (nmea_numeric(parser))
+        {
+            rmc->course = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 9: /* UTC 日期 ddmmyy */
+        if (nmea_numeric(parser))
+        {
+            rmc->date = tok->mantissa;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* GGA 字段解码 */
+static void nmea_decode_gga(nmea_parser_t *parser)
+{
+    const nmea_token_t *tok = &parser->token;
+    nmea_gga_t *gga = &parser->work.gga;
+    rt_int32_t value;
+
+    switch (parser->field)
+    {
+    case 1: /* UTC 时间 hhmmss.sss */
+        if (nmea_numeric(parser))
+        {
+            value = nmea_token_fixed(tok, 3);
+            gga->time = value / 1000;
+            gga->time_ms = value % 1000;
+        }
+        break;
+    case 2: /* 纬度 */
+        if (nmea_numeric(parser) && !nmea_token_coord(tok, 90, &gga->latitude))
+        {
+            parser->field_error = 1;
+        }
+        break;
+    case 3: /* 纬度方向 */
+        gga->ns = tok->len ? tok->first : 0;
+        if (gga->ns == 'S')
+        {
+            gga->latitude = -gga->latitude;
+        }
+        break;
+    case 4: /* 经度 */
+        if (nmea_numeric(parser) && !nmea_token_coord(tok, 180, &gga->longitude))
+        {
+            parser->field_error = 1;
+        }
+        break;
+    case 5: /* 经度方向 */
+        gga->ew = tok->len ? tok->first : 0;
+        if (gga->ew == 'W')
+        {
+            gga->longitude = -gga->longitude;
+        }
+        break;
+    case 6: /* 定位质量 */
+        if (nmea_numeric(parser))
+        {
+            gga->quality = tok->mantissa;
+        }
+        break;
+    case 7: /* 参与定位的卫星数 */
+        if (nmea_numeric(parser))
+        {
+            gga->satellites = tok->mantissa;
+        }
+        break;
+    case 8: /* HDOP */
+        if (nmea_numeric(parser))
+        {
+            gga->hdop = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 9: /* 海拔高度（米） */
+        if (nmea_numeric(parser))
+        {
+            gga->altitude = nmea_token_fixed(tok, 1);
+        }
+        break;
+    case 11: /* 大地水准面差距（米） */
+        if (nmea_numeric(parser))
+        {
+            gga->geoid_sep = nmea_token_fixed(tok, 1);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* GSA 字段解码 */
+static void nmea_decode_gsa(nmea_parser_t *parser)
+{
+    const nmea_token_t *tok = &parser->token;
+    nmea_gsa_t *gsa = &parser->work.gsa;
+
+    switch (parser->field)
+    {
+    case 2: /* 定位类型 */
+        if (nmea_numeric(parser))
+        {
+            gsa->fix_type = tok->mantissa;
+        }
+        break;
+    case 15: /* PDOP */
+        if (nmea_numeric(parser))
+        {
+            gsa->pdop = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 16: /* HDOP */
+        if (nmea_numeric(parser))
+        {
+            gsa->hdop = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 17: /* VDOP */
+        if (nmea_numeric(parser))
+        {
+            gsa->vdop = nmea_token_fixed(tok, 2);
+        }
+        break;
+    default:
+        /* 字段 3~14 为参与解算的卫星号，只统计个数 */
+        if (parser->field >= 3 && parser->field <= 14 && tok->len > 0)
+        {
+            gsa->satellites++;
+        }
+        break;
+    }
+}
+
+/* GSV 字段解码 */
+static void nmea_decode_gsv(nmea_parser_t *parser)
+{
+    const nmea_token_t *tok = &parser->token;
+    nmea_gsv_t *gsv = &parser->work.gsv;
+
+    switch (parser->field)
+    {
+    case 1: /* 总条数 */
+        if (nmea_numeric(parser))
+        {
+            gsv->total = tok->mantissa;
+        }
+        break;
+    case 2: /* 本条序号 */
+        if (nmea_numeric(parser))
+        {
+            gsv->number = tok->mantissa;
+        }
+        break;
+    case 3: /* 可见卫星数 */
+        if (nmea_numeric(parser))
+        {
+            gsv->in_view = tok->mantissa;
+        }
+        break;
+    default:
+        /* 之后每 4 个字段描述一颗卫星：卫星号、仰角、方位角、载噪比 */
+        if (parser->field >= 4 && ((parser->field - 4) & 0x03) == 3 && nmea_numeric(parser))
+        {
+            if (tok->mantissa > 0)
+            {
+                gsv->tracked++;
+                gsv->snr_sum += tok->mantissa;
+            }
+        }
+        break;
+    }
+}
+
+/* VTG 字段解码 */
+static void nmea_decode_vtg(nmea_parser_t *parser)
+{
+    const nmea_token_t *tok = &parser->token;
+    nmea_vtg_t *vtg = &parser->work.vtg;
+
+    switch (parser->field)
+    {
+    case 1: /* 真北航向（度） */
+        if (nmea_numeric(parser))
+        {
+            vtg->course = nmea_token_fixed(tok, 2);
+        }
+        break;
+    case 7: /* 对地速度（km/h） */
+        if (nmea_numeric(parser))
+        {
+            vtg->speed_kmh = nmea_token_fixed(tok, 2);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* 一个字段结束 */
+static void nmea_field_end(nmea_parser_t *parser)
+{
+    if (parser->field == 0)
+    {
+        /* 地址字段必须是 2 字符 talker + 3 字符语句名 */
+        if (parser->token.len != 5)
+        {
+            parser->field_error = 1;
+        }
+        else
+        {
+            parser->sentence = nmea_identify(parser->address);
+            if (parser->sentence == NMEA_SENTENCE_GSV)
+            {
+                parser->work.gsv.talker[0] = parser->address[0];
+                parser->work.gsv.talker[1] = parser->address[1];
+            }
+        }
+    }
+    else
+    {
+        switch (parser->sentence)
+        {
+        case NMEA_SENTENCE_RMC:
+            nmea_decode_rmc(parser);
+            break;
+        case NMEA_SENTENCE_GGA:
+            nmea_decode_gga(parser);
+            break;
+        case NMEA_SENTENCE_GSA:
+            nmea_decode_gsa(parser);
+            break;
+        case NMEA_SENTENCE_GSV:
+            nmea_decode_gsv(parser);
+            break;
+        case NMEA_SENTENCE_VTG:
+            nmea_decode_vtg(parser);
+            break;
+        default:
+            break;
+        }
+    }
+
+    parser->field++;
+    rt_memset(&parser->token, 0, sizeof(parser->token));
+}
+
+/* 开始一条新语句 */
+static void nmea_sentence_begin(nmea_parser_t *parser)
+{
+    parser->state = NMEA_STATE_FIELD;
+    parser->length = 0;
+    parser->checksum = 0;
+    parser->sentence = NMEA_SENTENCE_NONE;
+    parser->field = 0;
+    parser->field_error = 0;
+    rt_memset(&parser->token, 0, sizeof(parser->token));
+    rt_memset(&parser->work, 0, sizeof(parser->work));
+}
+
+/* 校验通过，提交解码结果 */
+static nmea_sentence_t nmea_sentence_commit(nmea_parser_t *parser)
+{
+    parser->stats.sentences++;
+
+    switch (parser->sentence)
+    {
+    case NMEA_SENTENCE_RMC:
+        parser->rmc = parser->work.rmc;
+        break;
+    case NMEA_SENTENCE_GGA:
+        parser->gga = parser->work.gga;
+        break;
+    case NMEA_SENTENCE_GSA:
+        parser->gsa = parser->work.gsa;
+        break;
+    case NMEA_SENTENCE_GSV:
+        parser->gsv = parser->work.gsv;
+        break;
+    case NMEA_SENTENCE_VTG:
+        parser->vtg = parser->work.vtg;
+        break;
+    default:
+        parser->stats.ignored++;
+        break;
+    }
+
+    return (nmea_sentence_t)parser->sentence;
+}
+
+/* 初始化解析器 */
+void nmea_parser_init(nmea_parser_t *parser)
+{
+    rt_memset(parser, 0, sizeof(*parser));
+    parser->state = NMEA_STATE_IDLE;
+}
+
+/* 输入一个字节 */
+nmea_sentence_t nmea_parse_byte(nmea_parser_t *parser, char ch)
+{
+    rt_int8_t hex;
+
+    parser->stats.bytes++;
+
+    /* 任何状态下收到 '$' 都重新开始，上一条未结束的语句计为格式错误 */
+    if (ch == '$')
+    {
+        if (parser->state != NMEA_STATE_IDLE)
+        {
+            parser->stats.format_errors++;
+        }
+        nmea_sentence_begin(parser);
+        return NMEA_SENTENCE_NONE;
+    }
+
+    switch (parser->state)
+    {
+    case NMEA_STATE_IDLE:
+        /* 语句之间的 CR/LF 和噪声直接丢弃 */
+        break;
+
+    case NMEA_STATE_FIELD:
+        if (++parser->length > NMEA_MAX_SENTENCE_LEN)
+        {
+            parser->stats.overflows++;
+            parser->state = NMEA_STATE_IDLE;
+            break;
+        }
+        if (ch == '*')
+        {
+            nmea_field_end(parser);
+            parser->state = NMEA_STATE_CS1;
+        }
+        else if (ch == ',')
+        {
+            parser->checksum ^= ch;
+            nmea_field_end(parser);
+        }
+        else if (ch < 0x20 || ch > 0x7E)
+        {
+            /* 未带校验就结束或出现不可打印字符 */
+            parser->stats.format_errors++;
+            parser->state = NMEA_STATE_IDLE;
+        }
+        else
+        {
+            parser->checksum ^= ch;
+            if (parser->field == 0 && parser->token.len < sizeof(parser->address))
+            {
+                parser->address[parser->token.len] = ch;
+            }
+            nmea_token_put(&parser->token, ch);
+        }
+        break;
+
+    case NMEA_STATE_CS1:
+    case NMEA_STATE_CS2:
+        hex = nmea_hex_value(ch);
+        if (hex < 0)
+        {
+            parser->stats.format_errors++;
+            parser->state = NMEA_STATE_IDLE;
+            break;
+        }
+        if (parser->state == NMEA_STATE_CS1)
+        {
+            parser->recv_checksum = hex << 4;
+            parser->state = NMEA_STATE_CS2;
+            break;
+        }
+
+        parser->recv_checksum |= hex;
+        parser->state = NMEA_STATE_IDLE;
+        if (parser->recv_checksum != parser->checksum)
+        {
+            parser->stats.checksum_errors++;
+        }
+        else if (parser->field_error)
+        {
+            parser->stats.format_errors++;
+        }
+        else
+        {
+            return nmea_sentence_commit(parser);
+        }
+        break;
+
+    default:
+        parser->state = NMEA_STATE_IDLE;
+        break;
+    }
+
+    return NMEA_SENTENCE_NONE;
+}
+
+#ifdef RT_USING_FINSH
+#include <stdlib.h>
+#include "drv_dwt.h"
+
+/* 录制的 ATGM336H 一个定位周期的输出（GPS+北斗双模，1Hz 默认语句） */
+static const char nmea_bench_log[] =
+    "$GNGGA,083559.000,3150.78120,N,12128.15800,E,1,09,1.12,15.3,M,9.8,M,,*72\r\n"
+    "$GNGLL,3150.78120,N,12128.15800,E,083559.000,A,A*4A\r\n"
+    "$GNGSA,A,3,10,12,15,24,25,32,,,,,,,1.89,1.12,1.52,1*03\r\n"
+    "$GNGSA,A,3,06,09,16,,,,,,,,,,1.89,1.12,1.52,4*08\r\n"
+    "$GPGSV,3,1,10,10,62,011,38,12,47,316,41,15,21,198,33,18,06,125,,0*67\r\n"
+    "$GPGSV,3,2,10,23,18,044,29,24,55,143,44,25,36,285,40,29,04,330,,0*60\r\n"
+    "$GPGSV,3,3,10,32,30,071,35,193,54,155,31,0*5F\r\n"
+    "$BDGSV,1,1,03,06,60,321,42,09,45,210,37,16,66,032,39,0*42\r\n"
+    "$GNRMC,083559.000,A,3150.78120,N,12128.15800,E,0.29,103.41,191026,,,A,V*06\r\n"
+    "$GNVTG,103.41,T,,M,0.29,N,0.54,K,A*2E\r\n"
+    "$GNZDA,083559.000,19,10,2026,00,00*45\r\n"
+    "$GPTXT,01,01,01,ANTENNA OPEN*25\r\n";
+
+/**
+ * @brief 解析吞吐量测试：用录制的 NMEA 日志反复喂解析器，按 DWT 周期计时
+ *        用法：nmea_bench [循环次数]
+ */
+static int nmea_bench(int argc, char *argv[])
+{
+    static nmea_parser_t parser;
+    rt_uint32_t loops = 100, start, cycles;
+    rt_uint64_t bytes;
+
+    if (argc > 1)
+    {
+        loops = atoi(argv[1]);
+    }
+
+    nmea_parser_init(&parser);
+
+    start = dwt_get_cycles();
+    for (rt_uint32_t n = 0; n < loops; n++)
+    {
+        for (const char *p = nmea_bench_log; *p != '\0'; p++)
+        {
+            nmea_parse_byte(&parser, *p);
+        }
+    }
+    cycles = dwt_get_cycles() - start;
+
+    bytes = parser.stats.bytes;
+    rt_kprintf("[NMEA] %d bytes, %d sentences, %d errors in %d cycles\n",
+               parser.stats.bytes, parser.stats.sentences,
+               parser.stats.checksum_errors + parser.stats.format_errors + parser.stats.overflows,
+               cycles);
+    if (cycles > 0 && bytes > 0)
+    {
+        rt_kprintf("[NMEA] %d cycles/byte, %d bytes/s at %d Hz\n",
+                   (rt_uint32_t)(cycles / bytes),
+                   (rt_uint32_t)(bytes * SystemCoreClock / cycles),
+                   SystemCoreClock);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(nmea_bench, NMEA parser throughput benchmark on a recorded log);
+
+/* 坐标转换自检的固定用例：边界、进位和舍入点，以及超出范围应拒绝的值 */
+static const struct
+{
+    const char *text;
+    rt_uint8_t max_deg;
+} gps_coord_cases[] =
+{
+    { "0000.00000", 90 },   { "0000.00001", 90 },   { "0000.00002", 90 },   { "0000.00003", 90 },
+    { "0000.00009", 90 },   { "0059.99999", 90 },   { "3150.78120", 90 },   { "8959.99999", 90 },
+    { "9000.00000", 90 },   { "9000.00001", 90 },   { "4960.00000", 90 },   { "1234.5", 90 },
+    { "1234", 90 },         { "1234.567891", 90 },  { "0100.000009", 90 },  { "12128.15800", 180 },
+    { "17959.99999", 180 }, { "18000.00000", 180 }, { "18000.1", 180 },     { "00000.00001", 180 },
+    { "11959.99995", 180 }, { "00030.00000", 180 },
+};
+
+/* 参考实现：逐位读出整数，按有理数 (度 + 分/60) 精确求 1e-7 度并四舍五入，不复用解析器的算法 */
+static rt_bool_t gps_coord_reference(const char *text, rt_uint32_t max_deg, rt_int32_t *coord)
+{
+    rt_uint64_t digits = 0, scale = 1, deg, min_scaled, value;
+    rt_bool_t dot = RT_FALSE;
+    rt_uint8_t frac = 0;
+
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '.')
+        {
+            dot = RT_TRUE;
+        }
+        else if (!dot || frac++ < NMEA_MAX_FRAC_DIGITS)
+        {
+            digits = digits * 10 + (rt_uint64_t)(*text - '0');
+            scale *= dot ? 10 : 1;
+        }
+    }
+
+    /* digits / scale = 度 * 100 + 分 */
+    deg = digits / (scale * 100);
+    min_scaled = digits % (scale * 100);
+    if (min_scaled >= 60 * scale)
+    {
+        return RT_FALSE;
+    }
+    value = deg * NMEA_COORD_SCALE + (min_scaled * NMEA_COORD_SCALE * 2 + 60 * scale) / (120 * scale);
+    if (value > (rt_uint64_t)max_deg * NMEA_COORD_SCALE)
+    {
+        return RT_FALSE;
+    }
+    *coord = (rt_int32_t)value;
+    return RT_TRUE;
+}
+
+/* 定宽写出无符号数 */
+static char *gps_coord_put(char *p, rt_uint32_t value, rt_uint8_t width)
+{
+    for (rt_uint8_t i = width; i > 0; i--)
+    {
+        p[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+    return p + width;
+}
+
+/* 用解析器的字段累加和转换路径处理一个坐标字段，与参考实现比较，一致时返回 RT_TRUE */
+static rt_bool_t gps_coord_check(const char *text, rt_uint32_t max_deg)
+{
+    nmea_token_t tok;
+    rt_int32_t got = 0, want = 0;
+    rt_bool_t got_ok, want_ok;
+
+    rt_memset(&tok, 0, sizeof(tok));
+    for (const char *p = text; *p != '\0'; p++)
+    {
+        nmea_token_put(&tok, *p);
+    }
+    got_ok = !tok.bad && nmea_token_coord(&tok, max_deg, &got);
+    want_ok = gps_coord_reference(text, max_deg, &want);
+
+    if (got_ok != want_ok || (got_ok && got != want))
+    {
+        rt_kprintf("[NMEA] %s (max %d): got %s%d, want %s%d\n", text, max_deg,
+                   got_ok ? "" : "reject ", got, want_ok ? "" : "reject ", want);
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+/**
+ * @brief ddmm.mmmmm 到 1e-7 度转换的自检：固定用例加随机坐标（0-5 位小数，纬度和经度），
+ *        与精确有理数参考逐位比较。用法：gps_coord_selftest [随机用例数]
+ */
+static int gps_coord_selftest(int argc, char *argv[])
+{
+    rt_uint32_t count = 20000, seed = 0x9E3779B9, cases = 0, mismatches = 0;
+
+    if (argc > 1)
+    {
+        count = atoi(argv[1]);
+    }
+
+    for (rt_uint32_t i = 0; i < sizeof(gps_coord_cases) / sizeof(gps_coord_cases[0]); i++)
+    {
+        cases++;
+        mismatches += !gps_coord_check(gps_coord_cases[i].text, gps_coord_cases[i].max_deg);
+    }
+
+    for (rt_uint32_t i = 0; i < count; i++)
+    {
+        rt_bool_t lon = i & 1;
+        rt_uint32_t max_deg = lon ? 180 : 90;
+        rt_uint8_t frac;
+        char text[16], *p;
+
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        frac = seed % (NMEA_MAX_FRAC_DIGITS + 1);
+
+        p = gps_coord_put(text, (seed >> 3) % (max_deg + 1), lon ? 3 : 2);
+        p = gps_coord_put(p, (seed >> 12) % 60, 2);
+        if (frac > 0)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            *p++ = '.';
+            p = gps_coord_put(p, seed % 100000, frac);
+        }
+        *p = '\0';
+
+        cases++;
+        if (!gps_coord_check(text, max_deg) && ++mismatches >= 10)
+        {
+            break;
+        }
+    }
+
+    rt_kprintf("[NMEA] coord selftest: %d cases, %d mismatches -> %s\n",
+               cases, mismatches, mismatches == 0 ? "PASS" : "FAIL");
+    return mismatches == 0 ? 0 : -1;
+}
+MSH_CMD_EXPORT(gps_coord_selftest, check ddmm.mmmmm to 1e-7 degree conversion against an exact reference);
+#endif /* RT_USING_FINSH */
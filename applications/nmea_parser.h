@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         NMEA 0183 逐字节状态机解析器头文件
+ * 2026-10-19     User         增加 GGA/GSA/GSV/VTG 语句解码
+ */
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <rtthread.h>
+
+/* NMEA 语句最大长度（不含 '$' 和 CRLF，标准规定为 80） */
+#define NMEA_MAX_SENTENCE_LEN   82
+
+/* 数值字段保留的最多小数位数，超出部分丢弃，避免 32 位尾数溢出 */
+#define NMEA_MAX_FRAC_DIGITS    5
+
+/* 经纬度定点单位：1e-7 度，int32 可表示 ±214.7 度，赤道处分辨率约 1.1 cm */
+#define NMEA_COORD_SCALE        10000000
+
+/* 语句类型 */
+typedef enum
+{
+    NMEA_SENTENCE_NONE = 0,     /* 尚未收到完整语句 */
+    NMEA_SENTENCE_RMC,          /* 推荐最小定位信息 */
+    NMEA_SENTENCE_GGA,          /* 定位信息：质量、卫星数、HDOP、海拔 */
+    NMEA_SENTENCE_GSA,          /* 定位模式与 DOP */
+    NMEA_SENTENCE_GSV,          /* 可见卫星 */
+    NMEA_SENTENCE_VTG,          /* 对地速度与航向 */
+    NMEA_SENTENCE_OTHER         /* 校验通过但不解码的语句 */
+} nmea_sentence_t;
+
+/* 字段词法单元：字符到达时就地累加，不保存字段字符串 */
+typedef struct
+{
+    rt_uint32_t mantissa;       /* 去掉小数点后的全部数字 */
+    rt_uint8_t frac;            /* 小数位数 */
+    rt_uint8_t len;             /* 字段字符数，0 表示空字段 */
+    rt_uint8_t dot;             /* 已出现小数点 */
+    rt_uint8_t neg;             /* 以负号开头 */
+    rt_uint8_t bad;             /* 数值字段中出现非数字字符或溢出 */
+    char first;                 /* 第一个字符，用于 A/V、N/S、E/W 等单字符字段 */
+} nmea_token_t;
+
+/* RMC 语句解码结果 */
+typedef struct
+{
+    rt_uint32_t time;           /* UTC 时间 hhmmss */
+    rt_uint16_t time_ms;        /* UTC 时间毫秒部分 */
+    rt_uint32_t date;           /* UTC 日期 ddmmyy */
+    rt_bool_t valid;            /* 定位状态：A 有效，V 无效 */
+    rt_int32_t latitude;        /* 纬度，单位 1e-7 度，南纬为负 */
+    rt_int32_t longitude;       /* 经度，单位 1e-7 度，西经为负 */
+    char ns;                    /* 纬度方向 N/S */
+    char ew;                    /* 经度方向 E/W */
+    rt_uint32_t speed_knots;    /* 对地速度，单位 0.01 节 */
+    rt_uint32_t course;         /* 对地航向，单位 0.01 度 */
+} nmea_rmc_t;
+
+/* GGA 语句解码结果 */
+typedef struct
+{
+    rt_uint32_t time;           /* UTC 时间 hhmmss */
+    rt_uint16_t time_ms;        /* UTC 时间毫秒部分 */
+    rt_uint8_t quality;         /* 定位质量：0 无效，1 单点，2 差分，6 推算 */
+    rt_uint8_t satellites;      /* 参与定位的卫星数 */
+    rt_uint16_t hdop;           /* 水平精度因子，单位 0.01 */
+    rt_int32_t latitude;        /* 纬度，单位 1e-7 度，南纬为负 */
+    rt_int32_t longitude;       /* 经度，单位 1e-7 度，西经为负 */
+    char ns;                    /* 纬度方向 N/S */
+    char ew;                    /* 经度方向 E/W */
+    rt_int32_t altitude;        /* 海拔高度，单位 0.1 米 */
+    rt_int32_t geoid_sep;       /* 大地水准面差距，单位 0.1 米 */
+} nmea_gga_t;
+
+/* GSA 语句解码结果（多系统时每个系统一条） */
+typedef struct
+{
+    rt_uint8_t fix_type;        /* 1 未定位，2 二维，3 三维 */
+    rt_uint8_t satellites;      /* 本条语句列出的参与解算卫星数 */
+    rt_uint16_t pdop;           /* 位置精度因子，单位 0.01 */
+    rt_uint16_t hdop;           /* 水平精度因子，单位 0.01 */
+    rt_uint16_t vdop;           /* 垂直精度因子，单位 0.01 */
+} nmea_gsa_t;
+
+/* GSV 语句解码结果（每个系统分多条发送） */
+typedef struct
+{
+    char talker[2];             /* 卫星系统，例如 "GP"、"BD" */
+    rt_uint8_t total;           /* 本系统 GSV 总条数 */
+    rt_uint8_t number;          /* 本条序号，从 1 开始 */
+    rt_uint8_t in_view;         /* 本系统可见卫星数 */
+    rt_uint8_t tracked;         /* 本条中有载噪比的卫星数 */
+    rt_uint16_t snr_sum;        /* 本条中卫星载噪比之和（dB-Hz） */
+} nmea_gsv_t;
+
+/* VTG 语句解码结果 */
+typedef struct
+{
+    rt_uint32_t course;         /* 真北航向，单位 0.01 度 */
+    rt_uint32_t speed_kmh;      /* 对地速度，单位 0.01 km/h */
+} nmea_vtg_t;
+
+/* 解析统计，异常输入只计数，不会阻塞调用者 */
+typedef struct
+{
+    rt_uint32_t bytes;          /* 输入字节数 */
+    rt_uint32_t sentences;      /* 校验通过的语句数 */
+    rt_uint32_t ignored;        /* 校验通过但未解码的语句数 */
+    rt_uint32_t checksum_errors;/* 校验和错误 */
+    rt_uint32_t format_errors;  /* 格式错误：缺少校验、非法字符、字段非法 */
+    rt_uint32_t overflows;      /* 语句超长 */
+} nmea_stats_t;
+
+/* 解析器状态 */
+typedef struct
+{
+    rt_uint8_t state;           /* 状态机当前状态 */
+    rt_uint8_t length;          /* 当前语句已接收长度 */
+    rt_uint8_t checksum;        /* '$' 与 '*' 之间字符的异或值 */
+    rt_uint8_t recv_checksum;   /* 语句携带的校验值 */
+    rt_uint8_t sentence;        /* 当前语句类型 nmea_sentence_t */
+    rt_uint8_t field;           /* 当前字段序号，地址字段为 0 */
+    rt_uint8_t field_error;     /* 当前语句中存在非法字段 */
+    char address[5];            /* 地址字段，例如 "GNRMC" */
+    nmea_token_t token;         /* 当前字段 */
+
+    /* 正在解码的语句，校验通过后才提交到对应的结果中 */
+    union
+    {
+        nmea_rmc_t rmc;
+        nmea_gga_t gga;
+        nmea_gsa_t gsa;
+        nmea_gsv_t gsv;
+        nmea_vtg_t vtg;
+    } work;
+
+    nmea_rmc_t rmc;             /* 最近一条校验通过的 RMC */
+    nmea_gga_t gga;             /* 最近一条校验通过的 GGA */
+    nmea_gsa_t gsa;             /* 最近一条校验通过的 GSA */
+    nmea_gsv_t gsv;             /* 最近一条校验通过的 GSV */
+    nmea_vtg_t vtg;             /* 最近一条校验通过的 VTG */
+
+    nmea_stats_t stats;         /* 解析统计 */
+} nmea_parser_t;
+
+/**
+ * @brief 初始化解析器
+ * @param parser 解析器指针
+ */
+void nmea_parser_init(nmea_parser_t *parser);
+
+/**
+ * @brief 输入一个字节
+ * @param parser 解析器指针
+ * @param ch 接收到的字节
+ * @return 完成一条校验通过的语句时返回其类型，否则返回 NMEA_SENTENCE_NONE
+ */
+nmea_sentence_t nmea_parse_byte(nmea_parser_t *parser, char ch);
+
+#endif /* NMEA_PARSER_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         双缓冲序列锁快照
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <rtthread.h>
+#include <board.h>
+
+/*
+ * 双缓冲序列锁：单写者、任意多读者，双方都不阻塞也不关调度。
+ *
+ * 记录有两份，序号的最低位指向已发布的那一份。写者总是写另一份，
+ * 写完后递增序号完成发布；读者按序号复制对应的那份，复制前后序号
+ * 不变就是一份完整的记录，否则重读。
+ *
+ * 普通序列锁在单核上有个问题：高优先级读者抢占写到一半的写者后会
+ * 一直自旋，写者又得不到运行。这里读者抢占写者时读的是上一份已发布
+ * 的记录，不受正在进行的写入影响，只有复制期间写者连续发布时才重读。
+ */
+typedef struct
+{
+    volatile rt_uint32_t seq;   /* 发布次数，0 表示从未发布 */
+} snapshot_t;
+
+/**
+ * @brief 发布一条新记录（只能由唯一的写者调用）
+ * @param snap  序号
+ * @param slots 两份记录的存储区，大小为 2 * size
+ * @param src   新记录
+ * @param size  单条记录大小
+ */
+rt_inline void snapshot_publish(snapshot_t *snap, void *slots, const void *src, rt_size_t size)
+{
+    rt_uint32_t next = snap->seq + 1;
+
+    rt_memcpy((rt_uint8_t *)slots + (next & 1) * size, src, size);
+    /* 记录内容先于序号可见 */
+    __DMB();
+    snap->seq = next;
+}
+
+/**
+ * @brief 读取最近发布的记录，任意线程和中断中都可调用
+ * @param snap  序号
+ * @param slots 两份记录的存储区
+ * @param dst   输出记录
+ * @param size  单条记录大小
+ * @return 读到的记录的序号，0 表示从未发布（dst 内容无意义）
+ */
+rt_inline rt_uint32_t snapshot_read(const snapshot_t *snap, const void *slots, void *dst, rt_size_t size)
+{
+    rt_uint32_t seq;
+
+    do
+    {
+        seq = snap->seq;
+        __DMB();
+        rt_memcpy(dst, (const rt_uint8_t *)slots + (seq & 1) * size, size);
+        /* 复制完成后再确认序号 */
+        __DMB();
+    } while (seq != snap->seq);
+
+    return seq;
+}
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,748 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         传感器遥测定时上报调度
+ */
+
+#include "telemetry.h"
+#include "esp_app.h"
+#include "MQ2_app.h"
+#include "dht11_app.h"
+#include "max30102_app.h"
+#include "gps_time.h"
+#include "app_config.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 每个字段有自己的上报周期和下次到期时间。调度线程睡到最早的到期时间，
+ * 醒来后读取所有到期字段的最新值，合成一条只含这些字段的属性上报，
+ * 经 AT 异步队列发出，不在传感器线程里拼报文。
+ * 链路繁忙（队列积压或在途报文已满）时不丢数据，到期字段保留到下次，
+ * 届时取最新值合并上报；链路断开时本次上报丢弃并计数。
+ *
+ * 批量模式（默认，需要 GPS 授时）：每轮采样带 event_time 作为 services[]
+ * 中的一项暂存，攒到一定字节数、最早一项超过一定时间或出现报警时整批
+ * 发布，一次 AT 往返和一个 MQTT/JSON 包头承载多轮采样。
+ *
+ * 变化触发：字段按采样周期读取，但只有相对上次上报的值超出死区
+ * （绝对值或相对比例，取大者）且距上次上报已满最短间隔时才写进报文；
+ * 值不变时到最长间隔发一次心跳。报警期间甲烷浓度不受死区限制。
+ * 上报失败时所有字段下次采样必定上报，云端不会停在旧值上。
+ *
+ * 断网时批量模式照常采样攒批，批次带 event_time 存入 flash，
+ * 恢复连接后补发；未授时的单条上报仍直接丢弃。
+ */
+
+/* 读取字段最新值（定点整数），无有效值时返回 RT_FALSE */
+typedef rt_bool_t (*telem_sample_t)(rt_int32_t *value);
+
+typedef struct
+{
+    const char *name;
+    telem_sample_t sample;
+    rt_uint8_t decimals;        /* 定点小数位，value = 实际值 * 10^decimals */
+    rt_uint32_t interval_ms;    /* 采样周期 */
+    telem_deadband_t deadband;
+    rt_tick_t due;
+    rt_bool_t reported;         /* last_value 有效 */
+    rt_int32_t last_value;      /* 上次上报的值 */
+    rt_tick_t last_report;
+    rt_uint32_t sampled;        /* 采样次数 */
+    rt_uint32_t sent;           /* 写进报文的次数 */
+} telem_entry_t;
+
+/* 在途报文，回调中据此计算发布时延和样本数 */
+typedef struct
+{
+    rt_bool_t busy;
+    rt_tick_t submitted;
+    rt_uint16_t samples;
+} telem_inflight_t;
+
+static rt_bool_t telem_sample_density(rt_int32_t *value);
+static rt_bool_t telem_sample_heart_rate(rt_int32_t *value);
+static rt_bool_t telem_sample_temperature(rt_int32_t *value);
+static rt_bool_t telem_sample_humidity(rt_int32_t *value);
+
+/*
+ * 字段表：采样周期，死区（绝对值为定点单位、相对值为百分比），最短/最长上报间隔
+ * 甲烷 0.5ppm 或 5%；心率 3 次/分；温度 1℃；湿度 2%RH。心跳 5 分钟。
+ */
+static telem_entry_t telem_fields[TELEM_FIELD_COUNT] =
+{
+    [TELEM_FIELD_DENSITY]     = { "density",     telem_sample_density,     2, TELEM_DENSITY_INTERVAL_MS,
+                                  { 50, 5, 1000,  300000 } },
+    [TELEM_FIELD_HEART_RATE]  = { "heart_rate",  telem_sample_heart_rate,  0, TELEM_HEART_RATE_INTERVAL_MS,
+                                  { 3,  0, 5000,  300000 } },
+    [TELEM_FIELD_TEMPERATURE] = { "temperature", telem_sample_temperature, 0, TELEM_TEMPERATURE_INTERVAL_MS,
+                                  { 1,  0, 10000, 300000 } },
+    [TELEM_FIELD_HUMIDITY]    = { "humidity",    telem_sample_humidity,    0, TELEM_HUMIDITY_INTERVAL_MS,
+                                  { 2,  0, 10000, 300000 } },
+};
+
+static telem_inflight_t telem_inflight[TELEM_MAX_INFLIGHT];
+static telem_stats_t telem_stats;
+
+/* 批量上报缓冲：逗号分隔的 services[] 项 */
+static char telem_batch[TELEM_BATCH_BYTES];
+static rt_size_t telem_batch_len = 0;
+static rt_uint16_t telem_batch_samples = 0;
+static rt_tick_t telem_batch_start;
+static rt_bool_t telem_batch_enabled = RT_TRUE;
+static volatile rt_bool_t telem_alarm = RT_FALSE;
+
+/* 报警或修改周期时提前唤醒调度线程 */
+static struct rt_semaphore telem_wake;
+
+/* DHT11 读数超过读取周期（dht11_period_ms）加该余量（毫秒）未更新视为失效，不上报 */
+#define TELEM_DHT11_STALE_MARGIN_MS 8000
+
+static rt_bool_t telem_sample_density(rt_int32_t *value)
+{
+    float ppm = mq2_get_ch4ppm();
+
+    // 浓度超限时整批立即发出，不等攒满
+    if (ppm >= app_cfg_get(APP_CFG_DENSITY_ALARM_PPM))
+    {
+        telem_alarm = RT_TRUE;
+    }
+
+    *value = (rt_int32_t)(ppm * 100.0f + 0.5f);
+    return RT_TRUE;
+}
+
+static rt_bool_t telem_sample_heart_rate(rt_int32_t *value)
+{
+    *value = max30102_get_heart_rate();
+    return *value != 0;
+}
+
+/* 读取 DHT11 缓存，失效或过期时返回 RT_FALSE */
+static rt_bool_t telem_dht11_reading(dht11_reading_t *reading)
+{
+    rt_uint32_t stale_ms = (rt_uint32_t)app_cfg_get(APP_CFG_DHT11_PERIOD_MS) + TELEM_DHT11_STALE_MARGIN_MS;
+
+    return dht11_get_reading(reading) <= stale_ms && reading->valid;
+}
+
+static rt_bool_t telem_sample_temperature(rt_int32_t *value)
+{
+    dht11_reading_t reading;
+
+    if (!telem_dht11_reading(&reading))
+    {
+        return RT_FALSE;
+    }
+    *value = reading.temperature;
+    return RT_TRUE;
+}
+
+static rt_bool_t telem_sample_humidity(rt_int32_t *value)
+{
+    dht11_reading_t reading;
+
+    if (!telem_dht11_reading(&reading))
+    {
+        return RT_FALSE;
+    }
+    *value = reading.humidity;
+    return RT_TRUE;
+}
+
+/* 定点值写成属性 JSON 成员，返回长度 */
+static int telem_format(const telem_entry_t *f, rt_int32_t value, char *buf, rt_size_t size)
+{
+    static const rt_int32_t scale[] = { 1, 10, 100, 1000 };
+    rt_uint32_t mag = value < 0 ? 0U - (rt_uint32_t)value : (rt_uint32_t)value;
+
+    if (f->decimals == 0)
+    {
+        return rt_snprintf(buf, size, "\"%s\":%d", f->name, value);
+    }
+    return rt_snprintf(buf, size, "\"%s\":%s%d.%0*d", f->name, value < 0 ? "-" : "",
+                       mag / scale[f->decimals], f->decimals, mag % scale[f->decimals]);
+}
+
+/* 按死区和上报间隔判断本次采样是否写进报文 */
+static rt_bool_t telem_should_send(telem_entry_t *f, rt_int32_t value, rt_tick_t now, rt_bool_t force)
+{
+    const telem_deadband_t *db = &f->deadband;
+    rt_uint32_t since_ms, delta, band;
+
+    if (!f->reported || force)
+    {
+        return RT_TRUE;
+    }
+
+    since_ms = (now - f->last_report) * 1000 / RT_TICK_PER_SECOND;
+    if (db->max_interval_ms != 0 && since_ms >= db->max_interval_ms)
+    {
+        telem_stats.heartbeats++;
+        return RT_TRUE;
+    }
+
+    delta = value > f->last_value ? (rt_uint32_t)(value - f->last_value) : (rt_uint32_t)(f->last_value - value);
+    band = (rt_uint32_t)(f->last_value < 0 ? -f->last_value : f->last_value) * db->relative_pct / 100;
+    if (band < db->absolute)
+    {
+        band = db->absolute;
+    }
+    if (delta < band || delta == 0)
+    {
+        telem_stats.suppressed++;
+        return RT_FALSE;
+    }
+    if (since_ms < db->min_interval_ms)
+    {
+        // 变化太快：保持上次上报值作为比较基准，满最短间隔后的下一次采样再报
+        telem_stats.held++;
+        return RT_FALSE;
+    }
+    telem_stats.changes++;
+    return RT_TRUE;
+}
+
+/* 上报丢失后所有字段下次采样必定上报 */
+static void telem_invalidate(void)
+{
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        telem_fields[i].reported = RT_FALSE;
+    }
+}
+
+/* 发布完成回调（AT 工作线程中调用） */
+static void telem_publish_done(rt_err_t result, const char *resp, void *arg)
+{
+    telem_inflight_t *slot = (telem_inflight_t *)arg;
+    rt_uint32_t elapsed = (rt_tick_get() - slot->submitted) * 1000 / RT_TICK_PER_SECOND;
+
+    if (result == RT_EOK)
+    {
+        telem_stats.published++;
+        telem_stats.samples += slot->samples;
+        telem_stats.total_latency_ms += elapsed;
+        if (elapsed > telem_stats.max_latency_ms)
+        {
+            telem_stats.max_latency_ms = elapsed;
+        }
+    }
+    else
+    {
+        telem_stats.failed++;
+        telem_stats.samples_dropped += slot->samples;
+        telem_invalidate();
+    }
+    slot->busy = RT_FALSE;
+}
+
+/* 找一个空闲的在途槽位 */
+static telem_inflight_t *telem_get_slot(void)
+{
+    for (rt_uint8_t i = 0; i < TELEM_MAX_INFLIGHT; i++)
+    {
+        if (!telem_inflight[i].busy)
+        {
+            return &telem_inflight[i];
+        }
+    }
+    return RT_NULL;
+}
+
+/* 字段是否到期，节拍回绕时用有符号差值比较 */
+static rt_bool_t telem_is_due(const telem_entry_t *f, rt_tick_t now)
+{
+    return f->interval_ms != 0 && (rt_int32_t)(now - f->due) >= 0;
+}
+
+/* 链路是否能接受新报文，不能时返回 RT_NULL */
+static telem_inflight_t *telem_link_slot(void)
+{
+    esp_at_stats_t at;
+
+    esp_at_get_stats(&at);
+    if (at.queue_depth >= TELEM_QUEUE_HIGH)
+    {
+        return RT_NULL;
+    }
+    return telem_get_slot();
+}
+
+/* 采样到期字段，超出死区或到心跳时间的写成属性文本，返回写入的字段数 */
+static rt_uint16_t telem_collect(rt_uint8_t due_mask, char *props, rt_size_t size, rt_tick_t now)
+{
+    rt_size_t len = 0;
+    rt_uint16_t samples = 0;
+
+    props[0] = '\0';
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        telem_entry_t *f = &telem_fields[i];
+        rt_int32_t value;
+        char item[48];
+        int n;
+
+        // 无有效值的字段本轮不上报
+        if (!(due_mask & (1 << i)) || !f->sample(&value))
+        {
+            continue;
+        }
+        f->sampled++;
+        telem_stats.sampled++;
+
+        // 报警期间甲烷浓度每次采样都上报
+        if (!telem_should_send(f, value, now, i == TELEM_FIELD_DENSITY && telem_alarm))
+        {
+            continue;
+        }
+
+        n = telem_format(f, value, item, sizeof(item));
+        if (n <= 0 || len + n + 2 > size)
+        {
+            continue;
+        }
+        if (len > 0)
+        {
+            props[len++] = ',';
+        }
+        memcpy(&props[len], item, n);
+        len += n;
+        props[len] = '\0';
+        samples++;
+
+        f->reported = RT_TRUE;
+        f->last_value = value;
+        f->last_report = now;
+        f->sent++;
+    }
+    return samples;
+}
+
+/* 丢弃暂存的批次，其中的变化没有送达，下次采样全部重发 */
+static void telem_batch_drop(void)
+{
+    if (telem_batch_samples > 0)
+    {
+        telem_stats.dropped++;
+        telem_stats.samples_dropped += telem_batch_samples;
+        telem_invalidate();
+    }
+    telem_batch_len = 0;
+    telem_batch_samples = 0;
+}
+
+/* 发出暂存的批次，链路繁忙时返回 -RT_EBUSY 并保留批次 */
+static rt_err_t telem_batch_flush(rt_tick_t now)
+{
+    telem_inflight_t *slot;
+
+    if (telem_batch_len == 0)
+    {
+        return RT_EOK;
+    }
+    if (esp_get_link() != ESP_LINK_MQTT)
+    {
+        // 断网时整批存入 flash，恢复连接后由 ESP 线程补发
+        if (esp_store_services(telem_batch) == RT_EOK)
+        {
+            telem_stats.stored++;
+            telem_batch_len = 0;
+            telem_batch_samples = 0;
+        }
+        else
+        {
+            telem_batch_drop();
+        }
+        return RT_EOK;
+    }
+    slot = telem_link_slot();
+    if (slot == RT_NULL)
+    {
+        telem_stats.deferred++;
+        return -RT_EBUSY;
+    }
+
+    slot->busy = RT_TRUE;
+    slot->submitted = now;
+    slot->samples = telem_batch_samples;
+    if (esp_report_services(telem_batch, telem_publish_done, slot) != 0)
+    {
+        slot->busy = RT_FALSE;
+        telem_batch_drop();
+        return RT_EOK;
+    }
+    telem_stats.batches++;
+    telem_batch_len = 0;
+    telem_batch_samples = 0;
+    return RT_EOK;
+}
+
+/*
+ * 一轮采样加入批次，放不下时先发出；链路繁忙发不出时丢弃最旧的批次。
+ * 未授时（utc_us 为 0，只在断网时出现）的一项不带 event_time，平台按收到的时间记录
+ */
+static void telem_batch_add(const char *props, rt_uint16_t samples, rt_uint64_t utc_us, rt_tick_t now)
+{
+    char event_time[20];
+    char entry[256];
+    int n;
+
+    if (utc_us != 0)
+    {
+        gps_time_format_utc(event_time, sizeof(event_time), utc_us);
+        n = rt_snprintf(entry, sizeof(entry),
+            "{\"service_id\":\"BasedData\",\"properties\":{%s},\"event_time\":\"%s\"}",
+            props, event_time);
+    }
+    else
+    {
+        n = rt_snprintf(entry, sizeof(entry),
+            "{\"service_id\":\"BasedData\",\"properties\":{%s}}", props);
+    }
+    if (n <= 0 || n >= (int)sizeof(entry))
+    {
+        telem_invalidate();
+        return;
+    }
+
+    if (telem_batch_len + n + 1 >= sizeof(telem_batch) && telem_batch_flush(now) != RT_EOK)
+    {
+        telem_batch_drop();
+    }
+    if (telem_batch_len == 0)
+    {
+        telem_batch_start = now;
+    }
+    else
+    {
+        telem_batch[telem_batch_len++] = ',';
+    }
+    memcpy(&telem_batch[telem_batch_len], entry, n + 1);
+    telem_batch_len += n;
+    telem_batch_samples += samples;
+}
+
+/* 单条发布一轮采样（未授时或关闭批量时） */
+static void telem_send_single(const char *props, rt_uint16_t samples, rt_tick_t now, telem_inflight_t *slot)
+{
+    slot->busy = RT_TRUE;
+    slot->submitted = now;
+    slot->samples = samples;
+    if (esp_report_props("BasedData", props, telem_publish_done, slot) != 0)
+    {
+        slot->busy = RT_FALSE;
+        telem_stats.dropped++;
+        telem_stats.samples_dropped += samples;
+        telem_invalidate();
+    }
+}
+
+/* 处理到期字段和批次，返回距下一个到期时间的毫秒数 */
+static rt_uint32_t telem_run(rt_tick_t now)
+{
+    char props[192];
+    rt_uint8_t due_mask = 0;
+    rt_uint32_t sleep_ms = TELEM_MAX_SLEEP_MS;
+    rt_uint64_t utc_us = now_utc_us();
+    // 断网时总是攒批（未授时的不带时间戳），攒满或到时整批存入 flash
+    rt_bool_t batching = (telem_batch_enabled && utc_us != 0) || esp_get_link() != ESP_LINK_MQTT;
+    rt_uint16_t samples;
+    telem_inflight_t *slot = RT_NULL;
+    rt_uint8_t i;
+
+    for (i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        if (telem_is_due(&telem_fields[i], now))
+        {
+            due_mask |= 1 << i;
+        }
+    }
+
+    if (due_mask != 0)
+    {
+        if (!batching)
+        {
+            slot = telem_link_slot();
+        }
+
+        if (!batching && slot == RT_NULL)
+        {
+            // 背压：字段保持到期，稍后取最新值合并上报
+            telem_stats.deferred++;
+            return 100;
+        }
+        else if ((samples = telem_collect(due_mask, props, sizeof(props), now)) > 0)
+        {
+            if (batching)
+            {
+                telem_batch_add(props, samples, utc_us, now);
+            }
+            else
+            {
+                telem_send_single(props, samples, now, slot);
+            }
+        }
+
+        for (i = 0; i < TELEM_FIELD_COUNT; i++)
+        {
+            if (due_mask & (1 << i))
+            {
+                telem_fields[i].due = now + rt_tick_from_millisecond(telem_fields[i].interval_ms);
+            }
+        }
+    }
+
+    // 批次按大小、时长或报警发出
+    if (telem_batch_len > 0)
+    {
+        rt_uint32_t age_ms = (now - telem_batch_start) * 1000 / RT_TICK_PER_SECOND;
+        rt_uint32_t max_age_ms = esp_get_link() == ESP_LINK_MQTT ? TELEM_BATCH_MAX_AGE_MS : TELEM_STORE_MAX_AGE_MS;
+
+        if (telem_batch_len >= TELEM_BATCH_FLUSH_BYTES || age_ms >= max_age_ms ||
+            telem_alarm || !batching)
+        {
+            if (telem_batch_flush(now) != RT_EOK)
+            {
+                return 100;
+            }
+            telem_alarm = RT_FALSE;
+        }
+        else if (max_age_ms - age_ms < sleep_ms)
+        {
+            sleep_ms = max_age_ms - age_ms;
+        }
+    }
+    else
+    {
+        telem_alarm = RT_FALSE;
+    }
+
+    for (i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        if (telem_fields[i].interval_ms != 0)
+        {
+            rt_int32_t left = (rt_int32_t)(telem_fields[i].due - now);
+            rt_uint32_t ms = left > 0 ? (rt_uint32_t)left * 1000 / RT_TICK_PER_SECOND : 0;
+
+            if (ms < sleep_ms)
+            {
+                sleep_ms = ms;
+            }
+        }
+    }
+    return sleep_ms;
+}
+
+/**
+ * @brief   遥测调度线程入口
+ */
+static void telemetry_entry(void *parameter)
+{
+    rt_tick_t now = rt_tick_get();
+
+    telem_stats.started = now;
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        telem_fields[i].due = now;
+    }
+
+    while (1)
+    {
+        rt_uint32_t sleep_ms = telem_run(rt_tick_get());
+
+        rt_sem_take(&telem_wake, rt_tick_from_millisecond(sleep_ms > 0 ? sleep_ms : 1));
+    }
+}
+
+/**
+ * @brief   设置字段上报周期
+ */
+rt_err_t telemetry_set_interval(telem_field_t field, rt_uint32_t interval_ms)
+{
+    if (field >= TELEM_FIELD_COUNT)
+    {
+        return -RT_EINVAL;
+    }
+    telem_fields[field].interval_ms = interval_ms;
+    telem_fields[field].due = rt_tick_get();
+    rt_sem_release(&telem_wake);
+    return RT_EOK;
+}
+
+/**
+ * @brief   设置字段的死区和上报间隔
+ */
+rt_err_t telemetry_set_deadband(telem_field_t field, const telem_deadband_t *deadband)
+{
+    if (field >= TELEM_FIELD_COUNT || deadband == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+    rt_enter_critical();
+    telem_fields[field].deadband = *deadband;
+    telem_fields[field].reported = RT_FALSE;
+    rt_exit_critical();
+    return RT_EOK;
+}
+
+/**
+ * @brief   报警：立即发出暂存的批次
+ */
+void telemetry_alarm(void)
+{
+    telem_alarm = RT_TRUE;
+    rt_sem_release(&telem_wake);
+}
+
+/**
+ * @brief   开关批量上报
+ */
+void telemetry_set_batching(rt_bool_t enable)
+{
+    telem_batch_enabled = enable;
+    rt_sem_release(&telem_wake);
+}
+
+/**
+ * @brief   读取上报统计
+ */
+void telemetry_get_stats(telem_stats_t *stats)
+{
+    *stats = telem_stats;
+}
+
+/**
+ * @brief   遥测调度初始化
+ */
+static int telemetry_init(void)
+{
+    rt_thread_t thread;
+
+    rt_sem_init(&telem_wake, "telem", 0, RT_IPC_FLAG_FIFO);
+    thread = rt_thread_create("telem", telemetry_entry, RT_NULL, 1536, 21, 10);
+    if (thread == RT_NULL)
+    {
+        rt_kprintf("[TELEM] thread create failed!\n");
+        return -1;
+    }
+    rt_thread_startup(thread);
+
+    return 0;
+}
+INIT_APP_EXPORT(telemetry_init);
+
+/**
+ * @brief   打印上报统计
+ */
+static int telem_stat(int argc, char *argv[])
+{
+    rt_uint32_t secs = (rt_tick_get() - telem_stats.started) / RT_TICK_PER_SECOND;
+    rt_uint32_t per_min100 = secs ? telem_stats.published * 6000 / secs : 0;
+
+    rt_kprintf("[TELEM] published: %d (%d.%02d/min), failed: %d, dropped: %d, deferred: %d\n",
+               telem_stats.published, per_min100 / 100, per_min100 % 100,
+               telem_stats.failed, telem_stats.dropped, telem_stats.deferred);
+    rt_kprintf("[TELEM] samples: %d (%d.%02d/s, %d per message), dropped: %d\n",
+               telem_stats.samples, secs ? telem_stats.samples / secs : 0,
+               secs ? telem_stats.samples * 100 / secs % 100 : 0,
+               telem_stats.published ? telem_stats.samples / telem_stats.published : 0,
+               telem_stats.samples_dropped);
+    rt_kprintf("[TELEM] batching: %s, batches: %d, stored offline: %d, pending: %d bytes / %d samples\n",
+               telem_batch_enabled ? "on" : "off", telem_stats.batches, telem_stats.stored,
+               telem_batch_len, telem_batch_samples);
+    rt_kprintf("[TELEM] publish latency avg: %d ms, max: %d ms\n",
+               telem_stats.published ? telem_stats.total_latency_ms / telem_stats.published : 0,
+               telem_stats.max_latency_ms);
+    rt_kprintf("[TELEM] sampled: %d, sent on change: %d, heartbeat: %d, suppressed: %d, held: %d\n",
+               telem_stats.sampled, telem_stats.changes, telem_stats.heartbeats,
+               telem_stats.suppressed, telem_stats.held);
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        const telem_entry_t *f = &telem_fields[i];
+
+        rt_kprintf("[TELEM]   %-12s every %d ms, deadband %d/%d%%, interval %d..%d ms, "
+                   "sampled %d, sent %d (%d%%)\n",
+                   f->name, f->interval_ms, f->deadband.absolute, f->deadband.relative_pct,
+                   f->deadband.min_interval_ms, f->deadband.max_interval_ms,
+                   f->sampled, f->sent, f->sampled ? f->sent * 100 / f->sampled : 0);
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(telem_stat, show telemetry publish statistics);
+
+/**
+ * @brief   设置字段上报周期：telem_interval density 500
+ */
+static int telem_interval(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        rt_kprintf("Usage: telem_interval <field> <ms>\n");
+        return -1;
+    }
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        if (strcmp(argv[1], telem_fields[i].name) == 0)
+        {
+            /* 经配置表修改，保持与云端下发的配置一致 */
+            if (app_cfg_set((app_cfg_id_t)(APP_CFG_TELEM_DENSITY_MS + i), atoi(argv[2])) != RT_EOK)
+            {
+                rt_kprintf("[TELEM] interval out of range\n");
+                return -1;
+            }
+            return 0;
+        }
+    }
+    rt_kprintf("[TELEM] unknown field: %s\n", argv[1]);
+    return -1;
+}
+MSH_CMD_EXPORT(telem_interval, set telemetry field interval in ms);
+
+/**
+ * @brief   设置字段死区：telem_deadband temperature 1 0 10000 300000
+ */
+static int telem_deadband(int argc, char *argv[])
+{
+    telem_deadband_t db;
+
+    if (argc != 6)
+    {
+        rt_kprintf("Usage: telem_deadband <field> <abs> <rel%%> <min_ms> <max_ms>\n");
+        return -1;
+    }
+    db.absolute = atoi(argv[2]);
+    db.relative_pct = atoi(argv[3]);
+    db.min_interval_ms = atoi(argv[4]);
+    db.max_interval_ms = atoi(argv[5]);
+    for (rt_uint8_t i = 0; i < TELEM_FIELD_COUNT; i++)
+    {
+        if (strcmp(argv[1], telem_fields[i].name) == 0)
+        {
+            telemetry_set_deadband((telem_field_t)i, &db);
+            return 0;
+        }
+    }
+    rt_kprintf("[TELEM] unknown field: %s\n", argv[1]);
+    return -1;
+}
+MSH_CMD_EXPORT(telem_deadband, set telemetry field deadband and report intervals);
+
+/**
+ * @brief   开关批量上报：telem_batch on|off
+ */
+static int telem_batch_cmd(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        rt_kprintf("Usage: telem_batch on|off\n");
+        return -1;
+    }
+    app_cfg_set(APP_CFG_TELEM_BATCH, strcmp(argv[1], "on") == 0);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(telem_batch_cmd, telem_batch, enable or disable batched telemetry);
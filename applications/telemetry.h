@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     User         传感器遥测定时上报调度
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <rtthread.h>
+
+/* 同时在途（已提交、未完成）的上报数上限 */
+#define TELEM_MAX_INFLIGHT      2
+/* AT 异步队列中排队的命令达到该值时推迟上报，把链路留给其他业务 */
+#define TELEM_QUEUE_HIGH        4
+/* 调度线程最长睡眠时间（毫秒） */
+#define TELEM_MAX_SLEEP_MS      1000
+
+/* 批量上报缓冲区大小 */
+#define TELEM_BATCH_BYTES       1024
+/* 批次达到该字节数时发出 */
+#define TELEM_BATCH_FLUSH_BYTES 800
+/* 批次中最早一项超过该时间（毫秒）时发出 */
+#define TELEM_BATCH_MAX_AGE_MS  10000
+/* 断网时批次攒满或最早一项超过该时间（毫秒）才存入 flash，减少记录头和擦写 */
+#define TELEM_STORE_MAX_AGE_MS  300000
+/* 甲烷浓度达到该值（ppm）视为报警，批次立即发出（默认值，运行时见 app_config.h） */
+#define TELEM_DENSITY_ALARM_PPM 1000.0f
+
+/* 各字段默认采样周期（毫秒），运行时可经 app_config 修改 */
+#define TELEM_DENSITY_INTERVAL_MS       1000
+#define TELEM_HEART_RATE_INTERVAL_MS    5000
+#define TELEM_TEMPERATURE_INTERVAL_MS   10000
+#define TELEM_HUMIDITY_INTERVAL_MS      10000
+
+/* 上报字段 */
+typedef enum
+{
+    TELEM_FIELD_DENSITY = 0,    /* MQ2 甲烷浓度 */
+    TELEM_FIELD_HEART_RATE,     /* 心率 */
+    TELEM_FIELD_TEMPERATURE,    /* 温度 */
+    TELEM_FIELD_HUMIDITY,       /* 湿度 */
+    TELEM_FIELD_COUNT,
+} telem_field_t;
+
+/* 变化触发上报参数 */
+typedef struct
+{
+    rt_uint32_t absolute;       /* 绝对死区，字段定点单位（甲烷为 0.01ppm） */
+    rt_uint8_t relative_pct;    /* 相对死区，上次上报值的百分比，与绝对死区取大者 */
+    rt_uint32_t min_interval_ms;/* 两次上报的最短间隔，变化更快时合并 */
+    rt_uint32_t max_interval_ms;/* 值不变时的心跳间隔，0 表示不发心跳 */
+} telem_deadband_t;
+
+/* 上报统计 */
+typedef struct
+{
+    rt_uint32_t published;      /* 模块确认发布成功的报文数 */
+    rt_uint32_t failed;         /* 模块返回错误或超时的报文数 */
+    rt_uint32_t dropped;        /* 链路断开或入队失败而丢弃的报文数 */
+    rt_uint32_t deferred;       /* 因背压推迟的次数，字段留到下次合并上报 */
+    rt_uint32_t batches;        /* 发出的批次数 */
+    rt_uint32_t stored;         /* 链路断开时存入 flash 的批次数 */
+    rt_uint32_t samples;        /* 发布成功的字段值个数 */
+    rt_uint32_t samples_dropped;/* 丢弃的字段值个数 */
+    rt_uint32_t sampled;        /* 采样的字段值个数 */
+    rt_uint32_t changes;        /* 超出死区而上报的次数 */
+    rt_uint32_t heartbeats;     /* 值未变、到心跳间隔而上报的次数 */
+    rt_uint32_t suppressed;     /* 在死区内未上报的次数 */
+    rt_uint32_t held;           /* 超出死区但未满最短间隔、推迟上报的次数 */
+    rt_uint32_t max_latency_ms; /* 提交到发布确认的最长时间 */
+    rt_uint32_t total_latency_ms;
+    rt_tick_t started;          /* 调度开始的节拍，计算上报速率 */
+} telem_stats_t;
+
+/**
+ * @brief   设置字段上报周期
+ * @param   field       字段
+ * @param   interval_ms 周期（毫秒），0 表示不上报
+ * @return  RT_EOK 成功，-RT_EINVAL 字段无效
+ */
+rt_err_t telemetry_set_interval(telem_field_t field, rt_uint32_t interval_ms);
+
+/**
+ * @brief   设置字段的死区和上报间隔（采样周期仍由 telemetry_set_interval() 设置）
+ * @return  RT_EOK 成功，-RT_EINVAL 参数无效
+ */
+rt_err_t telemetry_set_deadband(telem_field_t field, const telem_deadband_t *deadband);
+
+/**
+ * @brief   报警：立即发出暂存的批次（任意线程可调用）
+ */
+void telemetry_alarm(void);
+
+/**
+ * @brief   开关批量上报，关闭或尚未授时时每轮采样单独发布
+ */
+void telemetry_set_batching(rt_bool_t enable);
+
+/**
+ * @brief   读取上报统计
+ */
+void telemetry_get_stats(telem_stats_t *stats);
+
+#endif /* TELEMETRY_H */
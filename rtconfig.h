@@ -450,6 +450,7 @@
 #define BSP_USING_ADC
 #define BSP_USING_ADC0
 #define BSP_USING_ADC0_CH0
+#define BSP_USING_FLASH
 /* end of On-chip Peripheral Drivers */
 
 /* Board extended module Drivers */